@@ -0,0 +1,106 @@
+#include "Benchmark.h"
+#include <engine/RangeAllocator.h>
+
+using namespace croissant;
+
+namespace
+{
+	constexpr uint64_t MEGABUFFER_BYTES = 256ull << 20;
+	constexpr uint32_t CHURN_OPERATIONS = 1 << 20;
+}
+
+// Geometry-sized allocations freed in random order, the pattern of meshes streaming in and out of the megabuffer
+CROISSANT_BENCHMARK(RangeAllocatorChurn)
+{
+	RangeAllocator::Stats stats;
+	double seconds = bench::MeasureBest(context.iterations, [&]()
+	{
+		RangeAllocator allocator(MEGABUFFER_BYTES);
+		std::vector<uint64_t> live;
+		bench::Random random;
+
+		for (uint32_t i = 0; i < CHURN_OPERATIONS; i++)
+		{
+			if (live.empty() || random.Next() % 3 != 0)
+			{
+				// Vertex-stride aligned ranges between 1 KB and 1 MB
+				uint64_t offset = allocator.Allocate(32 * (32 + random.Next() % 32768), 32);
+				if (offset != RangeAllocator::INVALID_OFFSET)
+					live.push_back(offset);
+				else if (!live.empty())
+				{
+					allocator.Free(live.back());
+					live.pop_back();
+				}
+			}
+			else
+			{
+				size_t victim = random.Next() % live.size();
+				allocator.Free(live[victim]);
+				live[victim] = live.back();
+				live.pop_back();
+			}
+		}
+		stats = allocator.GetStats();
+	});
+
+	bench::Report("RangeAllocatorChurn", seconds, CHURN_OPERATIONS, "op");
+	printf("    %u allocations, %.1f / %.1f MB used, %u free blocks, largest %.1f MB, fragmentation %.3f\n",
+		stats.allocations, stats.usedSize / 1048576.0, stats.totalSize / 1048576.0, stats.freeBlocks,
+		stats.largestFreeBlock / 1048576.0, stats.GetFragmentation());
+}
+
+// Correctness of the allocator on small hand-checked cases: filling to capacity, coalescing on free, alignment
+// padding and failure when no single free block fits
+CROISSANT_BENCHMARK(RangeAllocatorChecks)
+{
+	RangeAllocator allocator(1024);
+	uint64_t blocks[4];
+	for (uint64_t i = 0; i < 4; i++)
+		blocks[i] = allocator.Allocate(256);
+	bench::Check(blocks[0] == 0 && blocks[1] == 256 && blocks[2] == 512 && blocks[3] == 768, "four quarters fill the range in order");
+	bench::Check(allocator.GetStats().usedSize == 1024 && allocator.GetStats().freeBlocks == 0, "a full range has no free blocks");
+	bench::Check(allocator.Allocate(1) == RangeAllocator::INVALID_OFFSET, "allocating from a full range fails");
+
+	// Freeing the middle two merges them, the outer two then merge everything back into one block
+	allocator.Free(blocks[1]);
+	allocator.Free(blocks[2]);
+	bench::Check(allocator.GetStats().freeBlocks == 1 && allocator.GetStats().largestFreeBlock == 512, "neighbours freed in order merge");
+	allocator.Free(blocks[3]);
+	bench::Check(allocator.GetStats().freeBlocks == 1 && allocator.GetStats().largestFreeBlock == 768, "a block merges with the free one before it");
+	allocator.Free(blocks[0]);
+	const RangeAllocator::Stats empty = allocator.GetStats();
+	bench::Check(empty.freeBlocks == 1 && empty.largestFreeBlock == 1024 && empty.usedSize == 0 && empty.GetFragmentation() == 0.0f,
+		"freeing everything leaves one block");
+	bench::Check(allocator.Allocate(1024) == 0, "the merged block serves the whole range again");
+
+	// Padding before an aligned block stays reserved with it and returns on free
+	allocator.Reset(4096);
+	const uint64_t small = allocator.Allocate(3);
+	const uint64_t aligned = allocator.Allocate(64, 256);
+	const uint64_t odd = allocator.Allocate(10, 48);
+	bench::Check(small == 0 && aligned == 256 && odd % 48 == 0 && odd >= aligned + 64, "allocations start on their alignment");
+	bench::Check(allocator.GetStats().usedSize == odd + 10, "alignment padding counts as used");
+	allocator.Free(aligned);
+	allocator.Free(odd);
+	bench::Check(allocator.GetStats().freeBlocks == 1 && allocator.GetStats().largestFreeBlock == 4093, "freed padding merges with its neighbours");
+	allocator.Free(small);
+	bench::Check(allocator.GetStats().largestFreeBlock == 4096, "the range is whole after freeing aligned blocks");
+
+	// Half the range free in two separate quarters: a half does not fit, nor does a quarter aligned past both
+	allocator.Reset(1024);
+	for (uint64_t i = 0; i < 4; i++)
+		blocks[i] = allocator.Allocate(256);
+	allocator.Free(blocks[1]);
+	allocator.Free(blocks[3]);
+	bench::Check(allocator.Allocate(512) == RangeAllocator::INVALID_OFFSET, "no single free block fits");
+	bench::Check(allocator.Allocate(256, 512) == RangeAllocator::INVALID_OFFSET, "blocks that fit only unaligned are not used");
+	const uint64_t quarter = allocator.Allocate(256, 256);
+	bench::Check(quarter == 256 || quarter == 768, "a free quarter serves a quarter");
+	bench::Check(allocator.Allocate(0) == RangeAllocator::INVALID_OFFSET && allocator.Allocate(1, 0) == RangeAllocator::INVALID_OFFSET,
+		"empty sizes and alignments fail");
+
+	const RangeAllocator::Stats stats = allocator.GetStats();
+	printf("    %u allocations, %llu of %llu bytes used, %u free blocks\n", stats.allocations,
+		(unsigned long long)stats.usedSize, (unsigned long long)stats.totalSize, stats.freeBlocks);
+}
@@ -0,0 +1,152 @@
+#include "Benchmark.h"
+#include <engine/Animation.h>
+
+using namespace croissant;
+
+namespace
+{
+	constexpr uint32_t ANIMATED_TRACKS = 2000;
+	constexpr uint32_t SOURCE_KEYS = 300;	// 10 seconds sampled at 30 Hz, as exporters bake them
+	constexpr float CLIP_DURATION = 10.0f;
+	constexpr float MAX_SPEED = 2.0f;							// Of the sines driving the tracks, radians per second
+	constexpr float MAX_TRANSLATION_SPEED = 0.1f * MAX_SPEED;	// Scene units per second
+	constexpr float MAX_ANGULAR_SPEED = 0.8f * MAX_SPEED;		// Radians per second
+	constexpr float ROTATION_QUANTIZATION = 1e-4f;				// Radians, three 15-bit components off by half a step each
+
+	// Smooth motion with a few static channels, like a baked character clip. The source keys are kept when asked for
+	std::unique_ptr<AnimationClip> MakeClip(std::vector<AnimationClip::SourceTrack>* outTracks = nullptr)
+	{
+		std::vector<AnimationClip::SourceTrack> tracks(ANIMATED_TRACKS);
+		for (uint32_t t = 0; t < ANIMATED_TRACKS; t++)
+		{
+			AnimationClip::SourceTrack& track = tracks[t];
+			track.nodeName = "bone" + std::to_string(t);
+			const float speed = 0.5f + float(t % 7) * 0.25f;	// Up to MAX_SPEED
+
+			for (uint32_t k = 0; k < SOURCE_KEYS; k++)
+			{
+				const float time = CLIP_DURATION * float(k) / float(SOURCE_KEYS - 1);
+				const float angle = std::sin(time * speed) * 0.8f;
+
+				track.translationTimes.push_back(time);
+				track.translations.push_back(t % 4 == 0 ? glm::vec3(0.0f, std::sin(time * speed) * 0.1f, 0.0f) : glm::vec3(0.0f, 0.2f, 0.0f));
+				track.rotationTimes.push_back(time);
+				track.rotations.push_back(glm::vec4(std::sin(angle * 0.5f), 0.0f, 0.0f, std::cos(angle * 0.5f)));
+				track.scaleTimes.push_back(time);
+				track.scales.push_back(glm::vec3(1.0f));
+			}
+		}
+		auto clip = std::make_unique<AnimationClip>("synthetic", CLIP_DURATION, tracks);
+		if (outTracks)
+			outTracks->swap(tracks);
+		return clip;
+	}
+
+	// Linear interpolation of uncompressed keys, rotations normalised along the shorter arc as the sampler does
+	template <typename T>
+	T SampleSource(const std::vector<float>& times, const std::vector<T>& values, float time)
+	{
+		const size_t next = std::upper_bound(times.begin(), times.end(), time) - times.begin();
+		if (next == 0)
+			return values.front();
+		if (next == times.size())
+			return values.back();
+
+		const float alpha = (time - times[next - 1]) / (times[next] - times[next - 1]);
+		return values[next - 1] + (values[next] - values[next - 1]) * alpha;
+	}
+}
+
+CROISSANT_BENCHMARK(AnimationCompression)
+{
+	std::unique_ptr<AnimationClip> clip;
+	double seconds = bench::MeasureBest(1, [&]() { clip = MakeClip(); });
+
+	bench::Report("AnimationCompression", seconds, double(ANIMATED_TRACKS) * SOURCE_KEYS * 3, "key");
+	printf("    %zu -> %zu bytes (%.1fx), %u of %u keys kept\n", clip->GetSourceSize(), clip->GetCompressedSize(),
+		double(clip->GetSourceSize()) / double(clip->GetCompressedSize()), clip->GetKeyCount(), ANIMATED_TRACKS * SOURCE_KEYS * 3);
+}
+
+// Sampling the compressed clip against the uncompressed keys, on keys and halfway between them, played forward and
+// seeked at random. Dropped keys stay within the tolerances; quantised key times and smallest-three rotations add
+// at most the error of moving a key by half a 16-bit time step and that of a 15-bit component
+CROISSANT_BENCHMARK(AnimationCompressionError)
+{
+	std::vector<AnimationClip::SourceTrack> tracks;
+	std::unique_ptr<AnimationClip> clip = MakeClip(&tracks);
+	std::vector<glm::mat4> locals(clip->GetTrackCount());
+
+	std::vector<float> times;
+	for (uint32_t k = 0; k < SOURCE_KEYS; k++)
+	{
+		const float time = CLIP_DURATION * float(k) / float(SOURCE_KEYS - 1);
+		times.push_back(time);
+		if (k + 1 < SOURCE_KEYS)
+			times.push_back(time + 0.5f * CLIP_DURATION / float(SOURCE_KEYS - 1));
+	}
+	bench::Random random(11);
+	for (uint32_t i = 0; i < 64; i++)
+		times.push_back(CLIP_DURATION * random.NextFloat());
+
+	float translationError = 0.0f, rotationError = 0.0f;
+	AnimationSampler sampler(*clip);
+	for (float time : times)
+	{
+		sampler.Sample(time, locals.data());
+		for (uint32_t t = 0; t < clip->GetTrackCount(); t++)
+		{
+			const AnimationClip::SourceTrack& track = tracks[t];
+			const glm::vec3 translation = SampleSource(track.translationTimes, track.translations, time);
+			translationError = std::max(translationError, glm::length(glm::vec3(locals[t][3]) - translation));
+
+			// Rotations about x only, so the angle is read straight from the matrix
+			const glm::vec4 rotation = glm::normalize(SampleSource(track.rotationTimes, track.rotations, time));
+			const float angle = 2.0f * std::atan2(rotation.x, rotation.w);
+			rotationError = std::max(rotationError, std::abs(std::atan2(locals[t][1].z, locals[t][1].y) - angle));
+		}
+	}
+
+	const AnimationClip::Tolerances tolerances;
+	const float halfTimeStep = 0.5f * CLIP_DURATION / 65535.0f;
+	const float translationSlack = MAX_TRANSLATION_SPEED * halfTimeStep;
+	const float rotationSlack = MAX_ANGULAR_SPEED * halfTimeStep + ROTATION_QUANTIZATION;
+	printf("    max error over %zu samples: translation %.2e (tolerance %.0e), rotation %.2e rad (tolerance %.0e)\n", times.size(),
+		translationError, tolerances.translation, rotationError, tolerances.rotation);
+	bench::Check(translationError <= tolerances.translation + translationSlack, "compressed translations stay within tolerance");
+	bench::Check(rotationError <= tolerances.rotation + rotationSlack, "compressed rotations stay within tolerance");
+}
+
+// One second of 60 Hz forward playback, cursors advance incrementally
+CROISSANT_BENCHMARK(AnimationSampleForward)
+{
+	std::unique_ptr<AnimationClip> clip = MakeClip();
+	AnimationSampler sampler(*clip);
+	std::vector<glm::mat4> locals(clip->GetTrackCount());
+
+	constexpr int FRAMES = 60;
+	double seconds = bench::MeasureBest(context.iterations, [&]()
+	{
+		for (int frame = 0; frame < FRAMES; frame++)
+			sampler.Sample(float(frame) / 60.0f, locals.data());
+	});
+
+	bench::Report("AnimationSampleForward", seconds, double(clip->GetTrackCount()) * FRAMES, "track");
+}
+
+// Random seeks, every backwards jump restarts the cursors
+CROISSANT_BENCHMARK(AnimationSampleRandom)
+{
+	std::unique_ptr<AnimationClip> clip = MakeClip();
+	AnimationSampler sampler(*clip);
+	std::vector<glm::mat4> locals(clip->GetTrackCount());
+
+	constexpr int FRAMES = 60;
+	bench::Random random(7);
+	double seconds = bench::MeasureBest(context.iterations, [&]()
+	{
+		for (int frame = 0; frame < FRAMES; frame++)
+			sampler.Sample(CLIP_DURATION * random.NextFloat(), locals.data());
+	});
+
+	bench::Report("AnimationSampleRandom", seconds, double(clip->GetTrackCount()) * FRAMES, "track");
+}
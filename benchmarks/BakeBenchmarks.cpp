@@ -0,0 +1,193 @@
+#include "Benchmark.h"
+#include <engine/SDFBaker.h>
+#include <engine/AOBaker.h>
+#include <engine/ProceduralMesh.h>
+#include <glm/gtc/constants.hpp>
+
+using namespace croissant;
+
+namespace
+{
+	// ProceduralShape::Torus of unit size: the tube radius is 0.35, and TORUS_SIDES around the tube makes twice as
+	// many segments around the ring. A torus rather than a sphere: the centre of a sphere is equidistant to every
+	// triangle, the worst case of the search
+	constexpr float TORUS_RADIUS = 1.0f;
+	constexpr float TUBE_RADIUS = 0.35f;
+	constexpr uint32_t TORUS_SIDES = 90;
+	constexpr uint32_t TORUS_SEGMENTS = TORUS_SIDES * 2;
+
+	// ProceduralShape::Sphere, fine enough that its facets stay well within a voxel of the analytic sphere
+	constexpr float SPHERE_RADIUS = 1.0f;
+	constexpr uint32_t SPHERE_RINGS = 64;
+	constexpr uint32_t SPHERE_RESOLUTION = 48;
+
+	Mesh MakeTorus()
+	{
+		ProceduralMeshSettings settings;
+		settings.shape = ProceduralShape::Torus;
+		settings.size = TORUS_RADIUS;
+		settings.triangleCount = 2 * TORUS_SEGMENTS * TORUS_SIDES;
+		Mesh mesh;
+		ProceduralMesh::Generate(settings, mesh);
+		return mesh;
+	}
+
+	float TorusDistance(const glm::vec3& position)
+	{
+		return glm::length(glm::vec2(glm::length(glm::vec2(position.x, position.z)) - TORUS_RADIUS, position.y)) - TUBE_RADIUS;
+	}
+
+	float SphereDistance(const glm::vec3& position)
+	{
+		return glm::length(position) - SPHERE_RADIUS;
+	}
+
+	// Largest difference between the baked and the analytic distance, in voxels. Voxels clamped to the narrow band
+	// only have to agree in sign, and a sign is only trusted further than signTolerance from the analytic surface,
+	// beyond the facets of the mesh, and off the surface once quantized. A wrong sign is an infinite error
+	template<typename Distance>
+	float MaxDistanceError(const SDFVolume& volume, Distance distanceTo, float signTolerance)
+	{
+		float maxError = 0.0f;
+		for (uint32_t z = 0; z < volume.dimensions.z; z++)
+		{
+			for (uint32_t y = 0; y < volume.dimensions.y; y++)
+			{
+				for (uint32_t x = 0; x < volume.dimensions.x; x++)
+				{
+					const float expected = distanceTo(volume.origin + glm::vec3(x, y, z) * volume.voxelSize);
+					const float distance = volume.GetDistance(x, y, z);
+					if (std::abs(expected) > signTolerance && distance != 0.0f && (distance < 0.0f) != (expected < 0.0f))
+						return std::numeric_limits<float>::infinity();
+					if (std::abs(expected) < volume.maxDistance - volume.voxelSize)
+						maxError = std::max(maxError, std::abs(distance - expected));
+				}
+			}
+		}
+		return maxError / volume.voxelSize;
+	}
+}
+
+// Full and narrow-band bakes of a sphere against |p| - r: every voxel on the right side of the surface and within a
+// voxel of the analytic distance
+CROISSANT_BENCHMARK(SDFBakeSphere)
+{
+	ProceduralMeshSettings meshSettings;
+	meshSettings.shape = ProceduralShape::Sphere;
+	meshSettings.size = SPHERE_RADIUS;
+	meshSettings.triangleCount = 4 * SPHERE_RINGS * (SPHERE_RINGS - 1);
+	Mesh sphere;
+	ProceduralMesh::Generate(meshSettings, sphere);
+	TriangleBVH bvh;
+	bvh.Build(sphere);
+
+	// Facets of an angular step of pi / rings sink at most r * (1 - cos(step)) into the sphere
+	const float facetError = SPHERE_RADIUS * (1.0f - std::cos(glm::pi<float>() / float(SPHERE_RINGS)));
+	for (float narrowBand : { 0.0f, 0.1f })
+	{
+		SDFBakeSettings settings;
+		settings.resolution = SPHERE_RESOLUTION;
+		settings.narrowBand = narrowBand;
+
+		SDFBaker baker;
+		SDFVolume volume;
+		double seconds = bench::MeasureBest(context.iterations, [&]() { baker.Bake(bvh, settings, volume); });
+		bench::Report(narrowBand > 0.0f ? "SDFBakeSphere band" : "SDFBakeSphere full", seconds, double(volume.voxels.size()), "voxel");
+
+		const float maxError = MaxDistanceError(volume, SphereDistance, facetError);
+		printf("    %ux%ux%u, max error %.2f voxels\n", volume.dimensions.x, volume.dimensions.y, volume.dimensions.z, maxError);
+		bench::Check(volume.GetDistance(volume.dimensions.x / 2, volume.dimensions.y / 2, volume.dimensions.z / 2) < 0.0f, "the sphere centre is inside");
+		bench::Check(maxError <= 1.0f, "sphere distances match |p| - r in sign and within a voxel");
+	}
+}
+
+// Full and narrow-band bakes of a 32K-triangle torus, with the largest error against the analytic distance
+CROISSANT_BENCHMARK(SDFBake)
+{
+	Mesh torus = MakeTorus();
+	TriangleBVH bvh;
+	double buildSeconds = bench::MeasureBest(context.iterations, [&]() { bvh.Build(torus); });
+	bench::Report("SDFBake BVH build", buildSeconds, double(bvh.GetTriangleCount()), "tri");
+
+	// Facets sink by at most the sagitta of one angular step around the ring plus one around the tube
+	const float facetError = (TORUS_RADIUS + TUBE_RADIUS) * (1.0f - std::cos(2.0f * glm::pi<float>() / float(TORUS_SEGMENTS)))
+		+ TUBE_RADIUS * (1.0f - std::cos(2.0f * glm::pi<float>() / float(TORUS_SIDES)));
+
+	struct Case
+	{
+		const char* name;
+		uint32_t resolution;
+		float narrowBand;
+	};
+	const Case cases[] = {
+		{ "SDFBake 64 full", 64, 0.0f },
+		{ "SDFBake 128 full", 128, 0.0f },
+		{ "SDFBake 128 band", 128, 0.1f },
+	};
+
+	for (const Case& bakeCase : cases)
+	{
+		SDFBakeSettings settings;
+		settings.resolution = bakeCase.resolution;
+		settings.narrowBand = bakeCase.narrowBand;
+
+		SDFBaker baker;
+		SDFVolume volume;
+		double seconds = bench::MeasureBest(context.iterations, [&]() { baker.Bake(bvh, settings, volume); });
+		bench::Report(bakeCase.name, seconds, double(volume.voxels.size()), "voxel");
+
+		const float maxError = MaxDistanceError(volume, TorusDistance, facetError);
+		const SDFBaker::Stats& stats = baker.GetLastStats();
+		printf("    %ux%ux%u, %llu voxels evaluated, %u of %u tiles skipped, max error %.2f voxels\n",
+			volume.dimensions.x, volume.dimensions.y, volume.dimensions.z, (unsigned long long)stats.evaluatedVoxels,
+			stats.skippedTiles, stats.tiles, maxError);
+		bench::Check(maxError <= 1.0f, "torus distances match the analytic ones in sign and within a voxel");
+	}
+}
+
+// Per-vertex AO of the same torus at two ray counts, with the average over the inner and outer equators. An open
+// plane sees its whole hemisphere, the inside of the ring must come out clearly darker than the outside
+CROISSANT_BENCHMARK(AOBake)
+{
+	ProceduralMeshSettings planeSettings;
+	planeSettings.shape = ProceduralShape::Grid;
+	planeSettings.triangleCount = 2 * 64 * 64;
+	Mesh plane;
+	ProceduralMesh::Generate(planeSettings, plane);
+	AOBaker planeBaker;
+	planeBaker.Bake(&plane, AOBakeSettings());
+	bench::Check(plane.ambientOcclusion.size() == plane.vertices.size()
+		&& std::all_of(plane.ambientOcclusion.begin(), plane.ambientOcclusion.end(), [](uint8_t ao) { return ao == 255; }),
+		"an open plane bakes to full visibility");
+
+	Mesh torus = MakeTorus();
+	TriangleBVH bvh;
+	bvh.Build(torus);
+
+	for (uint32_t raysPerVertex : { 16u, 64u })
+	{
+		AOBakeSettings settings;
+		settings.raysPerVertex = raysPerVertex;
+		settings.maxDistance = 0.5f;
+
+		AOBaker baker;
+		double seconds = bench::MeasureBest(context.iterations, [&]() { baker.Bake(&torus, bvh, settings); });
+
+		char name[64];
+		snprintf(name, sizeof(name), "AOBake %u rays", raysPerVertex);
+		bench::Report(name, seconds, double(baker.GetLastStats().rays), "ray");
+
+		// Side 0 faces away from the hole, side TORUS_SIDES / 2 into it
+		double outer = 0.0, inner = 0.0;
+		for (uint32_t i = 0; i < TORUS_SEGMENTS; i++)
+		{
+			outer += torus.ambientOcclusion[i * TORUS_SIDES] / 255.0;
+			inner += torus.ambientOcclusion[i * TORUS_SIDES + TORUS_SIDES / 2] / 255.0;
+		}
+		outer /= TORUS_SEGMENTS;
+		inner /= TORUS_SEGMENTS;
+		printf("    %zu vertices, average AO %.2f on the outer equator, %.2f on the inner one\n", torus.vertices.size(), outer, inner);
+		bench::Check(outer > 0.95, "the outer equator of the torus is barely occluded");
+		bench::Check(inner < 0.85 && inner < outer - 0.1, "the inner equator of the torus is clearly occluded");
+	}
+}
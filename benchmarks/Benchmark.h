@@ -0,0 +1,68 @@
+#pragma once
+
+#include <core/stdafx.h>
+
+// Tiny self-registering benchmark harness for the CPU-side engine passes.
+
+namespace bench
+{
+	struct Context
+	{
+		std::string modelPath;	// Model given on the command line, empty if none
+		int iterations = 5;
+		uint64_t maxTriangles = 1 << 22;	// Largest procedural mesh of the scaling benchmarks
+	};
+
+	typedef void (*BenchmarkFunction)(const Context&);
+
+	struct Registration
+	{
+		Registration(const char* name, BenchmarkFunction function);
+	};
+
+	std::vector<std::pair<std::string, BenchmarkFunction>>& GetRegistry();
+
+	// Runs the function 'iterations' times and returns the fastest wall time in seconds
+	template <typename F>
+	double MeasureBest(int iterations, F&& function)
+	{
+		double best = std::numeric_limits<double>::max();
+		for (int i = 0; i < std::max(iterations, 1); i++)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			function();
+			best = std::min(best, std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count());
+		}
+		return best;
+	}
+
+	// Prints one result line: time and throughput in millions of 'unit' per second
+	void Report(const char* name, double seconds, double items, const char* unit);
+
+	// Deterministic generator for synthetic benchmark inputs, a 32-bit LCG returning its top 24 bits
+	class Random
+	{
+	public:
+		explicit Random(uint32_t seed = 1) : m_State(seed) {}
+
+		uint32_t Next()
+		{
+			m_State = m_State * 1664525u + 1013904223u;
+			return m_State >> 8;
+		}
+
+		// Uniform in [0, 1)
+		float NextFloat() { return float(Next()) / float(1 << 24); }
+
+	private:
+		uint32_t m_State;
+	};
+
+	// Correctness check next to the timings, kept in release builds. Failures are printed and make main return 1
+	void Check(bool condition, const char* what);
+}
+
+#define CROISSANT_BENCHMARK(name) \
+	static void name(const bench::Context& context); \
+	static bench::Registration s_Registration_##name(#name, name); \
+	static void name(const bench::Context& context)
@@ -0,0 +1,69 @@
+#include "Benchmark.h"
+#include <core/log.h>
+
+namespace bench
+{
+	static int s_FailedChecks = 0;
+
+	Registration::Registration(const char* name, BenchmarkFunction function)
+	{
+		GetRegistry().emplace_back(name, function);
+	}
+
+	std::vector<std::pair<std::string, BenchmarkFunction>>& GetRegistry()
+	{
+		static std::vector<std::pair<std::string, BenchmarkFunction>> registry;
+		return registry;
+	}
+
+	void Report(const char* name, double seconds, double items, const char* unit)
+	{
+		printf("%-44s %10.3f ms %12.2f M%s/s\n", name, seconds * 1000.0, items / seconds * 1e-6, unit);
+	}
+
+	void Check(bool condition, const char* what)
+	{
+		if (!condition)
+		{
+			printf("    CHECK FAILED: %s\n", what);
+			s_FailedChecks++;
+		}
+	}
+}
+
+// Usage: CroissantBenchmarks [model] [--filter <substring>] [--iterations <n>] [--max-triangles <n>]
+int main(int argc, char** argv)
+{
+	logger::ConsoleApplicationMode();
+	logger::SetMinSeverity(logger::Severity::Warning);
+
+	bench::Context context;
+	std::string filter;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--filter" && i + 1 < argc)
+			filter = argv[++i];
+		else if (arg == "--iterations" && i + 1 < argc)
+			context.iterations = std::max(1, atoi(argv[++i]));
+		else if (arg == "--max-triangles" && i + 1 < argc)
+			context.maxTriangles = std::max(1ull, strtoull(argv[++i], nullptr, 10));
+		else
+			context.modelPath = arg;
+	}
+
+	printf("%-44s %13s %20s\n", "benchmark", "best time", "throughput");
+	for (const auto& [name, function] : bench::GetRegistry())
+	{
+		if (filter.empty() || name.find(filter) != std::string::npos)
+			function(context);
+	}
+
+	if (bench::s_FailedChecks > 0)
+	{
+		printf("%d checks failed\n", bench::s_FailedChecks);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,102 @@
+#include "Benchmark.h"
+#include <engine/ClusterLOD.h>
+#include <engine/ProceduralMesh.h>
+
+using namespace croissant;
+
+// DAG build of a 2M-triangle terrain, then cut selection over a 5x5 grid of instances, 50M triangles at full
+// detail. The cut of the nearest instance is checked for cracks: its only open edges must be the terrain's border
+CROISSANT_BENCHMARK(ClusterLOD)
+{
+	constexpr uint32_t QUADS = 1024;
+	constexpr uint32_t INSTANCES_PER_SIDE = 5;
+
+	// Unit square of fractal noise, so simplification has real error to measure
+	ProceduralMeshSettings settings;
+	settings.shape = ProceduralShape::Terrain;
+	settings.triangleCount = 2ull * QUADS * QUADS;
+	Mesh terrain;
+	ProceduralMesh::Generate(settings, terrain);
+
+	ClusterDAG dag;
+	double buildSeconds = bench::MeasureBest(1, [&]() { ClusterDAG::Build(terrain, ClusterLODSettings(), dag); });
+	bench::Report("ClusterLOD DAG build", buildSeconds, double(terrain.indices.size() / 3), "tri");
+
+	std::vector<uint32_t> levelTriangles(dag.levelCount, 0);
+	uint32_t rootTriangles = 0;
+	for (const Cluster& cluster : dag.clusters)
+	{
+		levelTriangles[cluster.level] += cluster.triangleCount;
+		rootTriangles += cluster.group == INVALID ? cluster.triangleCount : 0;
+	}
+	printf("    %zu clusters in %u groups, %u root triangles, triangles per level:", dag.clusters.size(), dag.groupCount, rootTriangles);
+	for (uint32_t triangles : levelTriangles)
+		printf(" %u", triangles);
+	printf("\n");
+
+	std::vector<glm::mat4> instances;
+	for (uint32_t z = 0; z < INSTANCES_PER_SIDE; z++)
+	{
+		for (uint32_t x = 0; x < INSTANCES_PER_SIDE; x++)
+		{
+			glm::mat4 transform(1.0f);
+			transform[3] = glm::vec4(float(x) * 1.01f, 0.0f, float(z) * 1.01f, 1.0f);
+			instances.push_back(transform);
+		}
+	}
+
+	ClusterLODSelector selector;
+	selector.Init(dag);
+
+	// 1080p at a 60 degree vertical field of view, low over the first instance's corner
+	ClusterLODSelector::View view;
+	view.position = glm::vec3(-0.1f, 0.15f, -0.1f);
+	view.projectionScale = 1080.0f / (2.0f * std::tan(glm::radians(30.0f)));
+
+	struct Case
+	{
+		const char* name;
+		float pixelError;
+		uint32_t triangleBudget;
+	};
+	const Case cases[] = {
+		{ "ClusterLOD cut 1px", 1.0f, 1u << 30 },
+		{ "ClusterLOD cut 1px 1M", 1.0f, 1u << 20 },
+		{ "ClusterLOD cut 1px 256K", 1.0f, 1u << 18 },
+	};
+
+	std::vector<ClusterLODSelector::Selection> selection;
+	for (const Case& cutCase : cases)
+	{
+		view.pixelError = cutCase.pixelError;
+		view.triangleBudget = cutCase.triangleBudget;
+		double seconds = bench::MeasureBest(context.iterations, [&]() { selector.SelectCut(view, instances.data(), uint32_t(instances.size()), selection); });
+		bench::Report(cutCase.name, seconds, double(dag.clusters.size() * instances.size()), "cluster");
+
+		std::unordered_map<EdgeKey, uint32_t, EdgeKeyHash> edgeUses;
+		for (const ClusterLODSelector::Selection& selected : selection)
+		{
+			if (selected.instance != 0)
+				continue;
+			const Cluster& cluster = dag.clusters[selected.cluster];
+			for (uint32_t t = 0; t < cluster.triangleCount; t++)
+			{
+				const uint32_t* corners = &dag.indices[cluster.firstIndex + t * 3];
+				for (int k = 0; k < 3; k++)
+					edgeUses[EdgeKey(corners[k], corners[(k + 1) % 3])]++;
+			}
+		}
+		size_t openEdges = 0, overlappingEdges = 0;
+		for (const auto& [edge, uses] : edgeUses)
+		{
+			openEdges += uses == 1 ? 1 : 0;
+			overlappingEdges += uses > 2 ? 1 : 0;
+		}
+
+		const ClusterLODSelector::Stats& stats = selector.GetLastStats();
+		printf("    %u clusters, %u triangles at %.2f px, instance 0: %zu open edges (%u on the border), %zu shared by more than two triangles\n",
+			stats.clustersSelected, stats.trianglesSelected, stats.pixelError, openEdges, QUADS * 4, overlappingEdges);
+		bench::Check(openEdges == QUADS * 4 && overlappingEdges == 0, "the cut of instance 0 is watertight inside the terrain border");
+		bench::Check(!stats.overBudget && stats.trianglesSelected <= cutCase.triangleBudget, "the cut fits the triangle budget");
+	}
+}
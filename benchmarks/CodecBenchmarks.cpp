@@ -0,0 +1,99 @@
+#include "Benchmark.h"
+#include <engine/ModelLoader.h>
+#include <engine/MeshCodec.h>
+
+using namespace croissant;
+
+// Encode and decode throughput of the mesh codec on every subdivision level of a bumpy grid, in bytes of raw data,
+// with a copy of the raw bytes as the baseline decoding has to beat
+CROISSANT_BENCHMARK(MeshCompression)
+{
+	constexpr uint32_t BASE_GRID_SIZE = 64;
+	std::vector<std::unique_ptr<Mesh>> levels;
+	levels.push_back(std::make_unique<Mesh>());
+	for (uint32_t y = 0; y <= BASE_GRID_SIZE; y++)
+		for (uint32_t x = 0; x <= BASE_GRID_SIZE; x++)
+			levels[0]->vertices.push_back(Vertex{ glm::vec3(float(x), std::sin(float(x) * 0.3f) * std::cos(float(y) * 0.2f), float(y)), glm::vec2(float(x), float(y)) / float(BASE_GRID_SIZE), glm::vec3(0.0f, 1.0f, 0.0f) });
+	for (uint32_t y = 0; y < BASE_GRID_SIZE; y++)
+	{
+		for (uint32_t x = 0; x < BASE_GRID_SIZE; x++)
+		{
+			uint32_t i = y * (BASE_GRID_SIZE + 1) + x;
+			levels[0]->indices.insert(levels[0]->indices.end(), { i, i + BASE_GRID_SIZE + 1, i + 1, i + 1, i + BASE_GRID_SIZE + 1, i + BASE_GRID_SIZE + 2 });
+		}
+	}
+	MeshOperations::GenerateHalfEdgeData(levels[0].get());
+
+	for (int level = 0; level < MAX_SUBDIVISION_LEVELS; level++)
+	{
+		levels.push_back(std::make_unique<Mesh>());
+		MeshOperations::PlanarSubdivide(levels[level].get(), levels.back().get());
+	}
+
+	for (size_t level = 0; level < levels.size(); level++)
+	{
+		Mesh* mesh = levels[level].get();
+		MeshOperations::ComputeNormals(mesh);
+		const size_t vertexBytes = mesh->vertices.size() * sizeof(Vertex);
+		const size_t indexBytes = mesh->indices.size() * sizeof(uint32_t);
+		char name[64];
+
+		std::vector<uint8_t> raw(vertexBytes + indexBytes), copy(vertexBytes + indexBytes);
+		memcpy(raw.data(), mesh->vertices.data(), vertexBytes);
+		memcpy(raw.data() + vertexBytes, mesh->indices.data(), indexBytes);
+		double copySeconds = bench::MeasureBest(context.iterations, [&]() { memcpy(copy.data(), raw.data(), raw.size()); });
+		snprintf(name, sizeof(name), "MeshCompression L%zu raw copy", level);
+		bench::Report(name, copySeconds, double(raw.size()), "B");
+
+		std::vector<uint8_t> vertexData, indexData;
+		double encodeVertices = bench::MeasureBest(context.iterations, [&]()
+		{
+			vertexData.clear();
+			MeshCodec::EncodeVertices(mesh->vertices.data(), mesh->vertices.size(), sizeof(Vertex), vertexData);
+		});
+		snprintf(name, sizeof(name), "MeshCompression L%zu encode vertices", level);
+		bench::Report(name, encodeVertices, double(vertexBytes), "B");
+
+		std::vector<Vertex> vertices(mesh->vertices.size());
+		bool vertexOk = false;
+		double decodeVertices = bench::MeasureBest(context.iterations, [&]()
+		{
+			vertexOk = MeshCodec::DecodeVertices(vertexData.data(), vertexData.size(), vertices.data(), vertices.size(), sizeof(Vertex));
+		});
+		snprintf(name, sizeof(name), "MeshCompression L%zu decode vertices", level);
+		bench::Report(name, decodeVertices, double(vertexBytes), "B");
+
+		double encodeIndices = bench::MeasureBest(context.iterations, [&]()
+		{
+			indexData.clear();
+			MeshCodec::EncodeIndices(mesh->indices.data(), mesh->indices.size(), indexData);
+		});
+		snprintf(name, sizeof(name), "MeshCompression L%zu encode indices", level);
+		bench::Report(name, encodeIndices, double(indexBytes), "B");
+
+		std::vector<uint32_t> indices(mesh->indices.size());
+		bool indexOk = false;
+		double decodeIndices = bench::MeasureBest(context.iterations, [&]()
+		{
+			indexOk = MeshCodec::DecodeIndices(indexData.data(), indexData.size(), indices.data(), indices.size(), uint32_t(mesh->vertices.size()));
+		});
+		snprintf(name, sizeof(name), "MeshCompression L%zu decode indices", level);
+		bench::Report(name, decodeIndices, double(indexBytes), "B");
+
+		// Triangles may come back rotated
+		vertexOk = vertexOk && memcmp(vertices.data(), mesh->vertices.data(), vertexBytes) == 0;
+		for (size_t t = 0; indexOk && t < indices.size(); t += 3)
+		{
+			bool found = false;
+			for (size_t r = 0; r < 3; r++)
+				found |= indices[t + r] == mesh->indices[t] && indices[t + (r + 1) % 3] == mesh->indices[t + 1] && indices[t + (r + 2) % 3] == mesh->indices[t + 2];
+			indexOk = found;
+		}
+
+		printf("    %zu triangles, vertices %.1f%% of raw (%s), indices %.2f bytes per triangle (%s)\n", mesh->indices.size() / 3,
+			100.0 * double(vertexData.size()) / double(vertexBytes), vertexOk ? "exact" : "MISMATCH",
+			double(indexData.size()) / double(mesh->indices.size() / 3), indexOk ? "exact" : "MISMATCH");
+		bench::Check(vertexOk, "vertices round-trip exactly");
+		bench::Check(indexOk, "indices round-trip up to triangle rotation");
+	}
+}
@@ -0,0 +1,70 @@
+#include "Benchmark.h"
+#include <engine/ModelLoader.h>
+#include <engine/GLTFLoader.h>
+#include <engine/OBJLoader.h>
+#include <engine/PLYLoader.h>
+#include <utils/string_utils.h>
+
+using namespace croissant;
+
+// Import cost of the Assimp path with the flags ModelLoader uses
+CROISSANT_BENCHMARK(LoadModelAssimp)
+{
+	if (context.modelPath.empty())
+		return;
+
+	size_t triangles = 0;
+	double seconds = bench::MeasureBest(context.iterations, [&]()
+	{
+		Assimp::Importer importer;
+		const aiScene* scene = importer.ReadFile(context.modelPath.c_str(), ModelLoader::AssimpImportFlags);
+		triangles = 0;
+		for (unsigned int i = 0; scene && i < scene->mNumMeshes; i++)
+			triangles += scene->mMeshes[i]->mNumFaces;
+	});
+
+	bench::Report("LoadModelAssimp", seconds, double(triangles), "tri");
+}
+
+// Same file through the native glTF fast path
+CROISSANT_BENCHMARK(LoadModelGLB)
+{
+	std::string extension = std::filesystem::path(context.modelPath).extension().string();
+	string_utils::tolower(extension);
+	if (extension != ".glb")
+		return;
+
+	vfs::NativeFileSystem fs;
+	size_t triangles = 0;
+	double seconds = bench::MeasureBest(context.iterations, [&]()
+	{
+		std::vector<std::unique_ptr<Mesh>> meshes;
+		GLTFLoader::LoadGLB(fs, context.modelPath, meshes);
+		triangles = 0;
+		for (const auto& mesh : meshes)
+			triangles += mesh->indices.size() / 3;
+	});
+
+	bench::Report("LoadModelGLB", seconds, double(triangles), "tri");
+}
+
+// Native OBJ and PLY loaders, reported against file size to compare with disk bandwidth
+CROISSANT_BENCHMARK(LoadModelNative)
+{
+	std::string extension = std::filesystem::path(context.modelPath).extension().string();
+	string_utils::tolower(extension);
+	if (extension != ".obj" && extension != ".ply")
+		return;
+
+	vfs::NativeFileSystem fs;
+	double seconds = bench::MeasureBest(context.iterations, [&]()
+	{
+		std::vector<std::unique_ptr<Mesh>> meshes;
+		if (extension == ".obj")
+			OBJLoader::LoadOBJ(fs, context.modelPath, meshes);
+		else
+			PLYLoader::LoadPLY(fs, context.modelPath, meshes);
+	});
+
+	bench::Report(extension == ".obj" ? "LoadModelOBJ" : "LoadModelPLY", seconds, double(std::filesystem::file_size(context.modelPath)), "B");
+}
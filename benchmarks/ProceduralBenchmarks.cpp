@@ -0,0 +1,124 @@
+#include "Benchmark.h"
+#include <engine/ProceduralMesh.h>
+#include <core/log.h>
+
+using namespace croissant;
+
+namespace
+{
+	void FormatCount(uint64_t count, char* out, size_t size)
+	{
+		if (count >= (1ull << 20))
+			snprintf(out, size, "%lluM", (unsigned long long)(count >> 20));
+		else
+			snprintf(out, size, "%lluK", (unsigned long long)(count >> 10));
+	}
+}
+
+// Generation and the topology, normal and strip passes on every procedural shape, from 1K triangles up by 16x to
+// --max-triangles (4M by default), to see how each pass scales without model files
+CROISSANT_BENCHMARK(MeshPassScaling)
+{
+	const ProceduralShape shapes[] = { ProceduralShape::Sphere, ProceduralShape::Torus, ProceduralShape::Grid, ProceduralShape::Terrain, ProceduralShape::NonManifold };
+	for (ProceduralShape shape : shapes)
+	{
+		for (uint64_t triangles = 1 << 10; triangles <= context.maxTriangles; triangles *= 16)
+		{
+			ProceduralMeshSettings settings;
+			settings.shape = shape;
+			settings.triangleCount = triangles;
+			char size[16], name[64];
+			FormatCount(triangles, size, sizeof(size));
+			const char* shapeName = ProceduralMesh::GetShapeName(shape);
+
+			Mesh mesh;
+			double generate = bench::MeasureBest(context.iterations, [&]() { ProceduralMesh::Generate(settings, mesh); });
+			const double meshTriangles = double(mesh.indices.size() / 3);
+			snprintf(name, sizeof(name), "%s %s generate", shapeName, size);
+			bench::Report(name, generate, meshTriangles, "tri");
+
+			// Every inconsistently wound edge of the defects would log a warning and drown the timings
+			if (shape == ProceduralShape::NonManifold)
+				logger::SetMinSeverity(logger::Severity::Error);
+
+			double halfEdges = bench::MeasureBest(context.iterations, [&]() { MeshOperations::GenerateHalfEdgeData(&mesh); });
+			snprintf(name, sizeof(name), "%s %s GenerateHalfEdgeData", shapeName, size);
+			bench::Report(name, halfEdges, meshTriangles, "tri");
+
+			double neighbours = bench::MeasureBest(context.iterations, [&]() { MeshOperations::GenerateFaceNeighbours(&mesh, 60.0f); });
+			snprintf(name, sizeof(name), "%s %s GenerateFaceNeighbours", shapeName, size);
+			bench::Report(name, neighbours, meshTriangles, "tri");
+
+			double normals = bench::MeasureBest(context.iterations, [&]() { MeshOperations::ComputeNormals(&mesh); });
+			snprintf(name, sizeof(name), "%s %s ComputeNormals", shapeName, size);
+			bench::Report(name, normals, meshTriangles, "tri");
+
+			double tangents = bench::MeasureBest(context.iterations, [&]() { MeshOperations::ComputeTangentFrames(&mesh); });
+			snprintf(name, sizeof(name), "%s %s ComputeTangentFrames", shapeName, size);
+			bench::Report(name, tangents, meshTriangles, "tri");
+
+			double creases = bench::MeasureBest(context.iterations, [&]()
+			{
+				mesh.featureEdges.topologyVersion = INVALID;
+				MeshOperations::UpdateFeatureEdges(&mesh);
+			});
+			snprintf(name, sizeof(name), "%s %s UpdateFeatureEdges", shapeName, size);
+			bench::Report(name, creases, meshTriangles, "tri");
+
+			double strips = bench::MeasureBest(context.iterations, [&]() { MeshOperations::GenerateTriangleStrips(&mesh); });
+			snprintf(name, sizeof(name), "%s %s GenerateTriangleStrips", shapeName, size);
+			bench::Report(name, strips, meshTriangles, "tri");
+
+			logger::SetMinSeverity(logger::Severity::Warning);
+
+			size_t openEdges = 0;
+			for (const HalfEdge& halfEdge : mesh.halfEdges)
+				openEdges += halfEdge.twin == INVALID ? 1 : 0;
+			printf("    %zu vertices, %zu triangles, %zu half-edges without a twin, %zu creases\n", mesh.vertices.size(),
+				mesh.indices.size() / 3, openEdges, mesh.featureEdges.creases.size());
+		}
+	}
+}
+
+// ComputeNormals gathering one-rings against the serial scatter it falls back to, on the non-manifold shape whose
+// bowtie and inconsistently wound vertices have faces outside their ring. Both must give the same normals
+CROISSANT_BENCHMARK(NormalGatherVsScatter)
+{
+	for (uint64_t triangles = 1 << 12; triangles <= std::min<uint64_t>(context.maxTriangles, 1 << 20); triangles *= 16)
+	{
+		ProceduralMeshSettings settings;
+		settings.shape = ProceduralShape::NonManifold;
+		settings.triangleCount = triangles;
+		char size[16], name[64];
+		FormatCount(triangles, size, sizeof(size));
+
+		Mesh gathered;
+		ProceduralMesh::Generate(settings, gathered);
+		logger::SetMinSeverity(logger::Severity::Error);
+		MeshOperations::GenerateHalfEdgeData(&gathered);
+		logger::SetMinSeverity(logger::Severity::Warning);
+
+		// Without vertexHalfEdges the whole mesh takes the scatter path
+		Mesh scattered;
+		scattered.vertices = gathered.vertices;
+		scattered.indices = gathered.indices;
+
+		const double meshTriangles = double(gathered.indices.size() / 3);
+		double gather = bench::MeasureBest(context.iterations, [&]() { MeshOperations::ComputeNormals(&gathered); });
+		snprintf(name, sizeof(name), "NonManifold %s ComputeNormals gather", size);
+		bench::Report(name, gather, meshTriangles, "tri");
+
+		double scatter = bench::MeasureBest(context.iterations, [&]() { MeshOperations::ComputeNormals(&scattered); });
+		snprintf(name, sizeof(name), "NonManifold %s ComputeNormals scatter", size);
+		bench::Report(name, scatter, meshTriangles, "tri");
+
+		size_t mismatches = 0;
+		for (size_t v = 0; v < gathered.vertices.size(); v++)
+		{
+			const glm::vec3 difference = gathered.vertices[v].normal - scattered.vertices[v].normal;
+			mismatches += glm::dot(difference, difference) > 1e-8f ? 1 : 0;
+		}
+		printf("    %zu vertices, %zu normals differ\n", gathered.vertices.size(), mismatches);
+		bench::Check(mismatches == 0, "gathered and scattered normals match on the non-manifold shape");
+	}
+}
@@ -0,0 +1,147 @@
+#include "Benchmark.h"
+#include <engine/Skinning.h>
+#include <engine/ProceduralMesh.h>
+#include <core/Threading.h>
+
+using namespace croissant;
+
+namespace
+{
+	constexpr uint64_t SKINNED_TRIANGLES = 2 << 20;	// A sphere of about 1M vertices
+	constexpr uint32_t SKINNED_BONES = 64;
+	constexpr float SKINNING_EPSILON = 1e-4f;	// Positions are within 2 units of the origin, normals unit length
+
+	// Synthetic character-sized skin: rings of the sphere are generated top to bottom, so neighbouring vertices
+	// share bones like a real rig
+	Mesh MakeSkinnedMesh()
+	{
+		ProceduralMeshSettings settings;
+		settings.shape = ProceduralShape::Sphere;
+		settings.triangleCount = SKINNED_TRIANGLES;
+		Mesh mesh;
+		ProceduralMesh::Generate(settings, mesh);
+
+		const size_t vertexCount = mesh.vertices.size();
+		mesh.skin.resize(vertexCount);
+		mesh.bones.resize(SKINNED_BONES, Bone{ "", glm::mat4(1.0f) });
+
+		bench::Random random;
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			uint32_t bones[4];
+			float weights[4];
+			for (int k = 0; k < 4; k++)
+			{
+				bones[k] = uint32_t((i * SKINNED_BONES / vertexCount + k) % SKINNED_BONES);
+				weights[k] = random.NextFloat();
+			}
+			mesh.skin[i] = SkinningEngine::PackInfluences(bones, weights, 4, uint16_t(SKINNED_BONES));
+		}
+		return mesh;
+	}
+
+	std::vector<glm::mat4> MakePose(float time)
+	{
+		std::vector<glm::mat4> pose(SKINNED_BONES);
+		for (uint32_t b = 0; b < SKINNED_BONES; b++)
+		{
+			float angle = time + float(b) * 0.1f;
+			pose[b] = glm::mat4(
+				glm::vec4(std::cos(angle), std::sin(angle), 0.0f, 0.0f),
+				glm::vec4(-std::sin(angle), std::cos(angle), 0.0f, 0.0f),
+				glm::vec4(0.0f, 0.0f, 1.0f, 0.0f),
+				glm::vec4(0.0f, float(b) * 0.01f, 0.0f, 1.0f));
+		}
+		return pose;
+	}
+
+	// Largest difference of skinned positions and normals from a plain matrix-palette skin of the bind pose: the
+	// weighted sum of the bone matrices applied to the position, and to the normal before renormalising it
+	float MaxSkinningError(const Mesh& mesh, const std::vector<glm::mat4>& pose, const std::vector<Vertex>& skinned)
+	{
+		float maxError = 0.0f;
+		for (size_t i = 0; i < mesh.vertices.size(); i++)
+		{
+			glm::vec4 columns[4] = { glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f) };
+			for (int k = 0; k < 4; k++)
+			{
+				const float weight = float(mesh.skin[i].weights[k]) / 255.0f;
+				for (int c = 0; c < 4; c++)
+					columns[c] += pose[mesh.skin[i].bones[k]][c] * weight;
+			}
+
+			const Vertex& source = mesh.vertices[i];
+			const glm::vec3 position = glm::vec3(columns[0] * source.position.x + columns[1] * source.position.y + columns[2] * source.position.z + columns[3]);
+			const glm::vec3 normal = glm::normalize(glm::vec3(columns[0] * source.normal.x + columns[1] * source.normal.y + columns[2] * source.normal.z));
+			maxError = std::max(maxError, glm::length(skinned[i].position - position));
+			maxError = std::max(maxError, glm::length(skinned[i].normal - normal));
+		}
+		return maxError;
+	}
+}
+
+// Single-threaded kernel throughput, the per-core figure
+CROISSANT_BENCHMARK(SkinningPerCore)
+{
+	Mesh mesh = MakeSkinnedMesh();
+	SkinningEngine skinning(mesh);
+	std::vector<Vertex> output(mesh.vertices.size());
+
+	std::vector<glm::mat4> pose = MakePose(0.5f);
+	skinning.SetBoneMatrices(pose.data(), SKINNED_BONES);
+
+	double seconds = bench::MeasureBest(context.iterations, [&]()
+	{
+		skinning.SkinRange(0, uint32_t(mesh.vertices.size()), output.data());
+	});
+
+	bench::Report("SkinningPerCore", seconds, double(mesh.vertices.size()), "vtx");
+}
+
+// Full multi-threaded update with every bone animated
+CROISSANT_BENCHMARK(SkinningAllDirty)
+{
+	Mesh mesh = MakeSkinnedMesh();
+	SkinningEngine skinning(mesh);
+	std::vector<Vertex> output(mesh.vertices.size());
+	std::vector<SkinningEngine::VertexRange> ranges;
+
+	float time = 0.0f;
+	double seconds = bench::MeasureBest(context.iterations, [&]()
+	{
+		std::vector<glm::mat4> pose = MakePose(time += 0.1f);
+		skinning.SetBoneMatrices(pose.data(), SKINNED_BONES);
+		skinning.Skin(output.data(), ranges);
+	});
+
+	bench::Report("SkinningAllDirty", seconds, double(mesh.vertices.size()), "vtx");
+	printf("    %zu workers, %.2f Mvtx/s per core\n", threading::GetWorkerCount(), double(mesh.vertices.size()) / seconds * 1e-6 / double(threading::GetWorkerCount()));
+	bench::Check(MaxSkinningError(mesh, MakePose(time), output) <= SKINNING_EPSILON, "skinned vertices match the scalar reference");
+}
+
+// Only a few bones move, so only the blocks they influence are re-skinned
+CROISSANT_BENCHMARK(SkinningPartialDirty)
+{
+	Mesh mesh = MakeSkinnedMesh();
+	SkinningEngine skinning(mesh);
+	std::vector<Vertex> output(mesh.vertices.size());
+	std::vector<SkinningEngine::VertexRange> ranges;
+
+	std::vector<glm::mat4> pose = MakePose(0.0f);
+	skinning.SetBoneMatrices(pose.data(), SKINNED_BONES);
+	skinning.Skin(output.data(), ranges);
+
+	float time = 0.0f;
+	double seconds = bench::MeasureBest(context.iterations, [&]()
+	{
+		std::vector<glm::mat4> moved = MakePose(time += 0.1f);
+		std::copy(moved.begin(), moved.begin() + 4, pose.begin());
+		skinning.SetBoneMatrices(pose.data(), SKINNED_BONES);
+		skinning.Skin(output.data(), ranges);
+	});
+
+	bench::Report("SkinningPartialDirty", seconds, double(skinning.GetLastStats().verticesSkinned), "vtx");
+
+	// Blocks left clean since the first Skin must still hold the right result
+	bench::Check(MaxSkinningError(mesh, pose, output) <= SKINNING_EPSILON, "partially re-skinned vertices match the scalar reference");
+}
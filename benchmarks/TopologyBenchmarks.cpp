@@ -0,0 +1,152 @@
+#include "Benchmark.h"
+#include <engine/ModelLoader.h>
+#include <engine/ProceduralMesh.h>
+#include <core/Threading.h>
+
+using namespace croissant;
+
+namespace
+{
+	// 2 * 2237^2 is just over 10M triangles
+	constexpr uint64_t RING_GRID_TRIANGLES = 2ull * 2237 * 2237;
+
+	// Bumpy base of the per-level benchmarks, subdivided up to MAX_SUBDIVISION_LEVELS
+	constexpr uint64_t BASE_TRIANGLES = 2 * 64 * 64;
+
+	Mesh MakeMesh(ProceduralShape shape, uint64_t triangles)
+	{
+		ProceduralMeshSettings settings;
+		settings.shape = shape;
+		settings.triangleCount = triangles;
+		Mesh mesh;
+		ProceduralMesh::Generate(settings, mesh);
+		MeshOperations::GenerateHalfEdgeData(&mesh);
+		return mesh;
+	}
+
+	// Umbrella operator, the typical one-ring query of smoothing and normal passes
+	void RingAverage(const Mesh& mesh, size_t begin, size_t end, std::vector<glm::vec3>& out, size_t& visited)
+	{
+		size_t count = 0;
+		for (size_t v = begin; v < end; v++)
+		{
+			glm::vec3 sum(0.0f);
+			uint32_t valence = 0;
+			for (uint32_t neighbour : VertexRing(mesh, uint32_t(v)))
+			{
+				sum += mesh.vertices[neighbour].position;
+				valence++;
+			}
+			out[v] = valence ? sum / float(valence) : mesh.vertices[v].position;
+			count += valence;
+		}
+		visited = count;
+	}
+}
+
+// One-ring walks over every vertex of a 10M-triangle grid, single-threaded and on all workers
+CROISSANT_BENCHMARK(VertexRingTraversal)
+{
+	Mesh mesh = MakeMesh(ProceduralShape::Grid, RING_GRID_TRIANGLES);
+	std::vector<glm::vec3> averages(mesh.vertices.size());
+
+	size_t neighbours = 0;
+	double serial = bench::MeasureBest(context.iterations, [&]()
+	{
+		RingAverage(mesh, 0, mesh.vertices.size(), averages, neighbours);
+	});
+	bench::Report("VertexRingTraversal serial", serial, double(mesh.vertices.size()), "vtx");
+
+	std::atomic<size_t> parallelNeighbours = 0;
+	double parallel = bench::MeasureBest(context.iterations, [&]()
+	{
+		parallelNeighbours = 0;
+		threading::ParallelFor(mesh.vertices.size(), 1 << 14, [&](size_t begin, size_t end)
+		{
+			size_t visited = 0;
+			RingAverage(mesh, begin, end, averages, visited);
+			parallelNeighbours += visited;
+		});
+	});
+	bench::Report("VertexRingTraversal parallel", parallel, double(mesh.vertices.size()), "vtx");
+
+	printf("    %zu vertices, %zu triangles, %zu ring neighbours (%zu parallel)\n",
+		mesh.vertices.size(), mesh.indices.size() / 3, neighbours, size_t(parallelNeighbours));
+}
+
+// Normal, tangent frame and feature edge recomputation on every subdivision level of a terrain, as run after GenerateSubdividedMeshes
+CROISSANT_BENCHMARK(ComputeNormalsPerLevel)
+{
+	std::vector<std::unique_ptr<Mesh>> levels;
+	levels.push_back(std::make_unique<Mesh>(MakeMesh(ProceduralShape::Terrain, BASE_TRIANGLES)));
+
+	for (int level = 0; level < MAX_SUBDIVISION_LEVELS; level++)
+	{
+		levels.push_back(std::make_unique<Mesh>());
+		MeshOperations::PlanarSubdivide(levels[level].get(), levels.back().get());
+	}
+
+	for (size_t level = 0; level < levels.size(); level++)
+	{
+		Mesh* mesh = levels[level].get();
+		char name[64];
+		double area = bench::MeasureBest(context.iterations, [&]() { MeshOperations::ComputeNormals(mesh, NormalWeighting::Area); });
+		snprintf(name, sizeof(name), "ComputeNormals L%zu area", level);
+		bench::Report(name, area, double(mesh->indices.size() / 3), "tri");
+
+		double angle = bench::MeasureBest(context.iterations, [&]() { MeshOperations::ComputeNormals(mesh, NormalWeighting::Angle); });
+		snprintf(name, sizeof(name), "ComputeNormals L%zu angle", level);
+		bench::Report(name, angle, double(mesh->indices.size() / 3), "tri");
+
+		double tangents = bench::MeasureBest(context.iterations, [&]() { MeshOperations::ComputeTangentFrames(mesh); });
+		snprintf(name, sizeof(name), "ComputeTangentFrames L%zu", level);
+		bench::Report(name, tangents, double(mesh->indices.size() / 3), "tri");
+
+		double creases = bench::MeasureBest(context.iterations, [&]()
+		{
+			mesh->featureEdges.topologyVersion = INVALID;
+			MeshOperations::UpdateFeatureEdges(mesh);
+		});
+		snprintf(name, sizeof(name), "UpdateFeatureEdges L%zu", level);
+		bench::Report(name, creases, double(mesh->indices.size() / 3), "tri");
+		printf("    %zu creases, %zu boundary edges\n", mesh->featureEdges.creases.size(), mesh->featureEdges.boundaries.size());
+
+		double strips = bench::MeasureBest(context.iterations, [&]() { MeshOperations::GenerateTriangleStrips(mesh); });
+		snprintf(name, sizeof(name), "GenerateTriangleStrips L%zu", level);
+		bench::Report(name, strips, double(mesh->indices.size() / 3), "tri");
+		printf("    %zu strip indices for %zu list indices, compression %.2fx\n", mesh->stripIndices.size(), mesh->indices.size(),
+			double(mesh->indices.size()) / double(mesh->stripIndices.size()));
+	}
+}
+
+// Planar and PN triangle refinement of a terrain per level, planar from the level before as GenerateSubdividedMeshes
+// chains it, PN from the base. Open edges are counted to check the curved levels stay as watertight as the planar ones
+CROISSANT_BENCHMARK(SubdivisionSchemes)
+{
+	Mesh base = MakeMesh(ProceduralShape::Terrain, BASE_TRIANGLES);
+	MeshOperations::ComputeNormals(&base);
+
+	Mesh planarLevels[MAX_SUBDIVISION_LEVELS + 1];
+	planarLevels[0] = base;
+	for (uint32_t level = 1; level <= MAX_SUBDIVISION_LEVELS; level++)
+	{
+		char name[64];
+		Mesh& planar = planarLevels[level];
+		double planarSeconds = bench::MeasureBest(context.iterations, [&]() { MeshOperations::PlanarSubdivide(&planarLevels[level - 1], &planar); });
+		snprintf(name, sizeof(name), "PlanarSubdivide L%u", level);
+		bench::Report(name, planarSeconds, double(planar.indices.size() / 3), "tri");
+
+		Mesh curved;
+		double curvedSeconds = bench::MeasureBest(context.iterations, [&]() { MeshOperations::PNTriangleSubdivide(&base, &curved, level); });
+		snprintf(name, sizeof(name), "PNTriangleSubdivide L%u", level);
+		bench::Report(name, curvedSeconds, double(curved.indices.size() / 3), "tri");
+
+		size_t planarOpen = 0, curvedOpen = 0;
+		for (const HalfEdge& halfEdge : planar.halfEdges)
+			planarOpen += halfEdge.twin == INVALID ? 1 : 0;
+		for (const HalfEdge& halfEdge : curved.halfEdges)
+			curvedOpen += halfEdge.twin == INVALID ? 1 : 0;
+		printf("    %zu triangles, %zu vertices planar, %zu PN, open edges %zu planar, %zu PN\n", curved.indices.size() / 3,
+			planar.vertices.size(), curved.vertices.size(), planarOpen, curvedOpen);
+	}
+}
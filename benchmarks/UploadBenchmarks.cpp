@@ -0,0 +1,112 @@
+#include "Benchmark.h"
+#include <engine/GeometryUploader.h>
+
+using namespace croissant;
+
+namespace
+{
+	constexpr uint32_t PLAN_UPLOADS = 1 << 16;
+	constexpr uint64_t PLAN_SEGMENT_BYTES = 32 << 20;
+
+	// Replays a plan the way GeometryUploader::Execute records it: each batch restarts at the beginning of a segment and
+	// stages its copies one after another at UploadRing::ALIGNMENT, then copies them to upload.offset + srcOffset.
+	// Checks that every batch fits its segment and that every destination byte is written once, with the right data
+	bool ReplayPlan(const std::vector<BufferUpload>& uploads, const std::vector<GeometryUploader::Batch>& plan, uint64_t segmentSize, uint64_t destinationSize)
+	{
+		std::vector<uint8_t> destination(destinationSize, 0);
+		std::vector<uint8_t> writes(destinationSize, 0);
+		for (const GeometryUploader::Batch& batch : plan)
+		{
+			uint64_t staged = 0;
+			for (const GeometryUploader::Copy& copy : batch.copies)
+			{
+				if (copy.upload >= uploads.size() || copy.size == 0 || staged % UploadRing::ALIGNMENT != 0 || staged + copy.size > segmentSize)
+					return false;
+				const BufferUpload& upload = uploads[copy.upload];
+				if (copy.srcOffset + copy.size > upload.size || upload.offset + copy.srcOffset + copy.size > destinationSize)
+					return false;
+
+				const uint8_t* source = static_cast<const uint8_t*>(upload.data) + copy.srcOffset;
+				for (uint64_t b = 0; b < copy.size; b++)
+				{
+					destination[upload.offset + copy.srcOffset + b] = source[b];
+					writes[upload.offset + copy.srcOffset + b]++;
+				}
+				staged = (staged + copy.size + UploadRing::ALIGNMENT - 1) & ~(UploadRing::ALIGNMENT - 1);
+			}
+			if (batch.stagingBytes != std::min(staged, segmentSize))
+				return false;
+		}
+
+		for (const BufferUpload& upload : uploads)
+		{
+			for (uint64_t b = 0; b < upload.size; b++)
+			{
+				if (writes[upload.offset + b] != 1 || destination[upload.offset + b] != static_cast<const uint8_t*>(upload.data)[b])
+					return false;
+			}
+		}
+		return true;
+	}
+}
+
+// GeometryUploader::BuildPlan on hand-checked layouts: packing into one segment, splitting at a segment boundary and
+// an upload larger than a segment, then random uploads replayed byte by byte. Times planning a scene's worth of uploads
+CROISSANT_BENCHMARK(GeometryUploadPlan)
+{
+	std::vector<uint8_t> source(4096);
+	for (size_t b = 0; b < source.size(); b++)
+		source[b] = uint8_t(b * 131 + 7);
+
+	// Three small uploads share a segment, each staged at the next aligned offset
+	std::vector<BufferUpload> uploads = {
+		{ nullptr, 0, source.data(), 10 },
+		{ nullptr, 16, source.data() + 100, 20 },
+		{ nullptr, 48, source.data() + 200, 30 },
+	};
+	std::vector<GeometryUploader::Batch> plan = GeometryUploader::BuildPlan(uploads, 256);
+	bench::Check(plan.size() == 1 && plan[0].copies.size() == 3 && plan[0].stagingBytes == 16 + 32 + 32, "small uploads pack into one aligned segment");
+	bench::Check(ReplayPlan(uploads, plan, 256, 78), "packed uploads land at their offsets");
+
+	// The second upload starts at 48 and only 16 bytes of it fit, the rest opens the next batch
+	uploads = {
+		{ nullptr, 0, source.data(), 40 },
+		{ nullptr, 40, source.data() + 40, 40 },
+	};
+	plan = GeometryUploader::BuildPlan(uploads, 64);
+	bench::Check(plan.size() == 2 && plan[0].copies.size() == 2 && plan[1].copies.size() == 1
+		&& plan[0].copies[1].srcOffset == 0 && plan[0].copies[1].size == 16 && plan[1].copies[0].srcOffset == 16 && plan[1].copies[0].size == 24,
+		"an upload crossing the segment end is split there");
+	bench::Check(ReplayPlan(uploads, plan, 64, 80), "split uploads land at their offsets");
+
+	// One upload of three and a bit segments
+	uploads = { { nullptr, 8, source.data(), 200 } };
+	plan = GeometryUploader::BuildPlan(uploads, 64);
+	bench::Check(plan.size() == 4 && plan[0].copies[0].size == 64 && plan[3].copies[0].srcOffset == 192 && plan[3].copies[0].size == 8,
+		"an upload larger than a segment spans several batches");
+	bench::Check(ReplayPlan(uploads, plan, 64, 208), "a large upload lands at its offset");
+	bench::Check(GeometryUploader::BuildPlan(uploads, 0).empty(), "a zero segment size plans nothing");
+
+	// Random sizes, including empty uploads, laid out back to back in one destination buffer
+	bench::Random random;
+	uploads.clear();
+	uint64_t destinationSize = 0;
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		const uint64_t size = random.Next() % 4 == 0 ? 0 : random.Next() % 1000;
+		const uint64_t offset = random.Next() % 3000;
+		uploads.push_back({ nullptr, destinationSize, source.data() + offset, size });
+		destinationSize += size;
+	}
+	for (uint64_t segmentSize : { 64ull, 1000ull, 4096ull })
+		bench::Check(ReplayPlan(uploads, GeometryUploader::BuildPlan(uploads, segmentSize), segmentSize, destinationSize), "random uploads land at their offsets exactly once");
+
+	// Timing: vertex and index buffers of a large scene, 1 KB to 1 MB each
+	uploads.clear();
+	for (uint32_t i = 0; i < PLAN_UPLOADS; i++)
+		uploads.push_back({ nullptr, 0, nullptr, 1024 + random.Next() % (1 << 20) });
+	size_t batches = 0;
+	double seconds = bench::MeasureBest(context.iterations, [&]() { batches = GeometryUploader::BuildPlan(uploads, PLAN_SEGMENT_BYTES).size(); });
+	bench::Report("GeometryUploader::BuildPlan", seconds, double(PLAN_UPLOADS), "upload");
+	printf("    %zu batches of %llu MB\n", batches, (unsigned long long)(PLAN_SEGMENT_BYTES >> 20));
+}
@@ -0,0 +1,75 @@
+#include "Benchmark.h"
+#include <engine/Geometry.h>
+#include <engine/ProceduralMesh.h>
+
+using namespace croissant;
+
+namespace
+{
+	constexpr uint64_t BASE_TRIANGLES = 2 * 64 * 64;
+	constexpr int SUBDIVISION_LEVELS = 5;
+
+	// Index-order position gather, the vertex fetch pattern of a depth prepass.
+	// Four accumulators keep the loop bound by memory rather than by the add latency
+	template <typename T>
+	float GatherPositions(const Mesh& mesh, const T* stream)
+	{
+		auto position = [stream](uint32_t index) -> const glm::vec3&
+		{
+			if constexpr (std::is_same_v<T, Vertex>)
+				return stream[index].position;
+			else
+				return stream[index];
+		};
+
+		glm::vec3 sum[4] = { glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f) };
+		const size_t count = mesh.indices.size() & ~size_t(3);
+		for (size_t i = 0; i < count; i += 4)
+		{
+			sum[0] += position(mesh.indices[i + 0]);
+			sum[1] += position(mesh.indices[i + 1]);
+			sum[2] += position(mesh.indices[i + 2]);
+			sum[3] += position(mesh.indices[i + 3]);
+		}
+		glm::vec3 total = sum[0] + sum[1] + sum[2] + sum[3];
+		return total.x + total.y + total.z;
+	}
+}
+
+// Depth prepass vertex traffic of the interleaved and split-position layouts across subdivision levels
+CROISSANT_BENCHMARK(DepthPrepassFetch)
+{
+	ProceduralMeshSettings settings;
+	settings.shape = ProceduralShape::Grid;
+	settings.triangleCount = BASE_TRIANGLES;
+	std::vector<Mesh> levels(1);
+	ProceduralMesh::Generate(settings, levels[0]);
+	for (int i = 0; i < SUBDIVISION_LEVELS; i++)
+	{
+		levels.emplace_back();
+		MeshOperations::PlanarSubdivide(&levels[i], &levels.back());
+	}
+
+	volatile float sink = 0.0f;
+	for (size_t level = 0; level < levels.size(); level++)
+	{
+		const Mesh& mesh = levels[level];
+		std::vector<glm::vec3> positions(mesh.vertices.size());
+		for (size_t i = 0; i < positions.size(); i++)
+			positions[i] = mesh.vertices[i].position;
+
+		double interleaved = bench::MeasureBest(context.iterations, [&]() { sink = sink + GatherPositions(mesh, mesh.vertices.data()); });
+		double split = bench::MeasureBest(context.iterations, [&]() { sink = sink + GatherPositions(mesh, positions.data()); });
+
+		char name[64];
+		snprintf(name, sizeof(name), "DepthPrepassFetch L%zu interleaved", level);
+		bench::Report(name, interleaved, double(mesh.indices.size()), "idx");
+		snprintf(name, sizeof(name), "DepthPrepassFetch L%zu split", level);
+		bench::Report(name, split, double(mesh.indices.size()), "idx");
+
+		const double vertexCount = double(mesh.vertices.size());
+		printf("    %.0f vertices, vertex data read %.2f MB interleaved, %.2f MB split (%.0f%% less)\n", vertexCount,
+			vertexCount * sizeof(Vertex) / 1048576.0, vertexCount * sizeof(glm::vec3) / 1048576.0,
+			100.0 * (1.0 - double(sizeof(glm::vec3)) / double(sizeof(Vertex))));
+	}
+}
@@ -0,0 +1,26 @@
+#ifndef FACE_NEIGHBOURS_HLSLI
+#define FACE_NEIGHBOURS_HLSLI
+
+// Decoding of Geometry::m_FaceNeighbourBuffer, see MeshOperations::GenerateFaceNeighbours.
+// Component k of a face is the face across its edge (v_k, v_k+1).
+
+#define NEIGHBOUR_FACE_MASK 0x3FFFFFFF
+#define NEIGHBOUR_SHARP     0x40000000
+#define NEIGHBOUR_BOUNDARY  0x80000000
+
+uint GetNeighbourFace(uint packed)
+{
+    return packed & NEIGHBOUR_FACE_MASK;
+}
+
+bool IsBoundaryEdge(uint packed)
+{
+    return (packed & NEIGHBOUR_BOUNDARY) != 0;
+}
+
+bool IsSharpEdge(uint packed)
+{
+    return (packed & NEIGHBOUR_SHARP) != 0;
+}
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef QTANGENT_HLSLI
+#define QTANGENT_HLSLI
+
+// Decodes the QTANGENT stream written by MeshOperations::ComputeTangentFrames.
+// The quaternion rotates the tangent frame (tangent, cross(normal, tangent), normal); the sign of w is the
+// handedness of the bitangent.
+
+float3 RotateByQuaternion(float4 q, float3 v)
+{
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+void DecodeQTangent(float4 qtangent, out float3 tangent, out float3 bitangent, out float3 normal)
+{
+    float4 q = normalize(qtangent);
+    tangent = RotateByQuaternion(q, float3(1.0, 0.0, 0.0));
+    normal = RotateByQuaternion(q, float3(0.0, 0.0, 1.0));
+    bitangent = cross(normal, tangent) * (qtangent.w < 0.0 ? -1.0 : 1.0);
+}
+
+#endif
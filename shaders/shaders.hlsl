@@ -9,25 +9,66 @@ cbuffer CB : register(b0)
 };
 
 
+// i_normalTransform is the cofactor of the instance's upper 3x3 (InstanceData), so normals stay perpendicular under non-uniform scale
+void TransformForward(float3 i_position, float3 i_normal, float4x4 i_instance, float3x3 i_normalTransform, out float4 o_pos, out float3 o_normalWS, out float3 o_normalVS)
+{
+	float4 worldPos = mul(i_instance, float4(i_position.x, i_position.y, i_position.z, 1.0));
+	float3 normal = normalize(mul(i_normalTransform, i_normal));
+    o_pos =  mul(g_Transform , worldPos);
+	o_normalWS = normal;
+	float3 viewNormal = mul(g_ForwardView, float4(normal.x,normal.y,normal.z, 0.0)).xyz; 	// Transform normal to view space
+    o_normalVS = float3(viewNormal.x, viewNormal.y, viewNormal.z);								 // Use the normal as color for this pass
+}
+
 void main_vs(
 	float3 i_position   : POSITION, 
 	float2 i_uv			: UV,
 	float3 i_normal   	: NORMAL, 
+	float4x4 i_instance	: TRANSFORM,		// Per-instance world transform
+	float3x3 i_normalTransform : NORMAL_TRANSFORM,
 	out float4 o_pos	: SV_Position,
 	out float3 o_normalWS	: COLOR1,
-	out float3 o_normalVS   : COLOR4 
+	out float3 o_normalVS   : COLOR4,
+	out float o_ambient		: COLOR5
 )
 {
-    o_pos =  mul(g_Transform , float4(i_position.x, i_position.y, i_position.z, 1.0));
-	o_normalWS = i_normal;
-	float3 viewNormal = mul(g_ForwardView, float4(i_normal.x,i_normal.y,i_normal.z, 0.0)).xyz; 	// Transform normal to view space
-    o_normalVS = float3(viewNormal.x, viewNormal.y, viewNormal.z);								 // Use the normal as color for this pass
+	TransformForward(i_position, i_normal, i_instance, i_normalTransform, o_pos, o_normalWS, o_normalVS);
+	o_ambient = 0.0f;	// No ambient term without baked AO, lit as before
+}
+
+// Meshes with baked per-vertex AO (AOBaker), bound in vertex slot 4
+void main_ao_vs(
+	float3 i_position   : POSITION,
+	float2 i_uv			: UV,
+	float3 i_normal   	: NORMAL,
+	float4x4 i_instance	: TRANSFORM,
+	float3x3 i_normalTransform : NORMAL_TRANSFORM,
+	float i_ao			: AO,
+	out float4 o_pos	: SV_Position,
+	out float3 o_normalWS	: COLOR1,
+	out float3 o_normalVS   : COLOR4,
+	out float o_ambient		: COLOR5
+)
+{
+	TransformForward(i_position, i_normal, i_instance, i_normalTransform, o_pos, o_normalWS, o_normalVS);
+	o_ambient = 0.26f * i_ao;	// Ambient term, occluded by the baked AO
+}
+
+// Depth prepass and shadow maps, matches the GeometryPass::DepthOnly input layout
+void depth_vs(
+	float3 i_position   : POSITION,
+	float4x4 i_instance	: TRANSFORM,
+	out float4 o_pos	: SV_Position
+)
+{
+	o_pos = mul(g_Transform, mul(i_instance, float4(i_position, 1.0)));
 }
 
 void main_ps	(
 	in float4 i_pos 		: SV_Position,
 	in float3 o_normalWS	: COLOR1,
 	in float3 o_normalVS    : COLOR4,
+	in float i_ambient		: COLOR5,
 	out float4 o_color      : SV_Target)
 {
 	// directional light source
@@ -36,6 +77,7 @@ void main_ps	(
 	lightDir 		= normalize(lightDir);
 	float3 normal 	= normalize(o_normalVS);
 	float diffuse 	= max(dot(normal, lightDir), 0.0f) * 0.74f;
+	diffuse 		+= i_ambient; // From the vertex shader, 0 for meshes without baked AO
 
 	o_color = float4(diffuse, diffuse, diffuse, 1.0f); // Apply diffuse lighting
 	o_color = pow(o_color,(1.0f / 2.2f)); // Apply gamma correction
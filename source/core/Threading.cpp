@@ -0,0 +1,18 @@
+#include <core/Threading.h>
+
+namespace croissant
+{
+	namespace threading
+	{
+		tf::Executor& GetExecutor()
+		{
+			static tf::Executor executor(std::max(1u, std::thread::hardware_concurrency()));
+			return executor;
+		}
+
+		size_t GetWorkerCount()
+		{
+			return GetExecutor().num_workers();
+		}
+	}
+};
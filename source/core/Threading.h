@@ -0,0 +1,39 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <taskflow/taskflow.hpp>
+
+namespace croissant
+{
+	namespace threading
+	{
+		// Shared worker pool for CPU-side engine passes (loading, mesh processing, baking)
+		tf::Executor& GetExecutor();
+
+		size_t GetWorkerCount();
+
+		// Splits [0, count) into contiguous ranges of at least grainSize elements and calls function(begin, end) for each
+		// range on the shared executor. Blocks until every range has finished. Must not be called from inside a worker.
+		template <typename F>
+		void ParallelFor(size_t count, size_t grainSize, F&& function)
+		{
+			if (count == 0)
+				return;
+
+			const size_t maxRanges = GetWorkerCount() * 4;
+			const size_t rangeCount = std::clamp<size_t>(count / std::max<size_t>(grainSize, 1), 1, std::max<size_t>(maxRanges, 1));
+			if (rangeCount == 1)
+			{
+				function(size_t(0), count);
+				return;
+			}
+
+			tf::Taskflow taskflow;
+			taskflow.for_each_index(size_t(0), rangeCount, size_t(1), [&](size_t range)
+			{
+				function(count * range / rangeCount, count * (range + 1) / rangeCount);
+			});
+			GetExecutor().run(taskflow).wait();
+		}
+	}
+};
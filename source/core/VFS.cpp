@@ -34,6 +34,10 @@
 #else
 extern "C" {
 #include <glob.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 }
 #endif // _WIN32
 
@@ -67,6 +71,131 @@ Blob::~Blob()
     m_size = 0;
 }
 
+std::shared_ptr<MappedBlob> MappedBlob::map(const std::filesystem::path& name)
+{
+    auto blob = std::make_shared<MappedBlob>();
+
+#ifdef WIN32
+
+    HANDLE file = CreateFileW(name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        // file does not exist or is locked
+        return nullptr;
+    }
+    blob->m_fileHandle = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        // empty files cannot be mapped
+        return nullptr;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        return nullptr;
+    }
+    blob->m_mappingHandle = mapping;
+
+    blob->m_data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (blob->m_data == nullptr)
+    {
+        return nullptr;
+    }
+    blob->m_size = static_cast<size_t>(size.QuadPart);
+
+#else // WIN32
+
+    int fd = open(name.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        // file does not exist or is locked
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        // empty files cannot be mapped
+        close(fd);
+        return nullptr;
+    }
+
+    void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps its own reference to the file
+
+    if (data == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    madvise(data, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+    blob->m_data = data;
+    blob->m_size = static_cast<size_t>(st.st_size);
+
+#endif // WIN32
+
+    return blob;
+}
+
+MappedBlob::~MappedBlob()
+{
+#ifdef WIN32
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mappingHandle)
+        CloseHandle(m_mappingHandle);
+    if (m_fileHandle)
+        CloseHandle(m_fileHandle);
+#else
+    if (m_data)
+        munmap(m_data, m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+const void* MappedBlob::data() const
+{
+    return m_data;
+}
+
+size_t MappedBlob::size() const
+{
+    return m_size;
+}
+
+void MappedBlob::evict(size_t offset, size_t size) const
+{
+    if (!m_data || offset >= m_size)
+        return;
+
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const size_t pageSize = info.dwPageSize;
+#else
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+
+    // only whole pages, partial ones may still be in use by a neighbouring range
+    const size_t begin = (offset + pageSize - 1) / pageSize * pageSize;
+    const size_t end = std::min(offset + size, m_size) / pageSize * pageSize;
+    if (begin >= end)
+        return;
+
+    char* address = static_cast<char*>(m_data) + begin;
+#ifdef WIN32
+    // unlocking pages that are not locked removes them from the working set
+    VirtualUnlock(address, end - begin);
+#else
+    madvise(address, end - begin, MADV_DONTNEED);
+#endif
+}
+
 bool NativeFileSystem::folderExists(const std::filesystem::path& name)
 {
 	return std::filesystem::exists(name) && std::filesystem::is_directory(name);
@@ -122,6 +251,11 @@ std::shared_ptr<IBlob> NativeFileSystem::readFile(const std::filesystem::path& n
     return std::make_shared<Blob>(data, size);
 }
 
+std::shared_ptr<IBlob> NativeFileSystem::mapFile(const std::filesystem::path& name)
+{
+    return MappedBlob::map(name);
+}
+
 bool NativeFileSystem::writeFile(const std::filesystem::path& name, const void* data, size_t size)
 {
     // TODO: better error reporting
@@ -272,6 +406,11 @@ std::shared_ptr<IBlob> RelativeFileSystem::readFile(const std::filesystem::path&
     return m_UnderlyingFS->readFile(m_BasePath / name.relative_path());
 }
 
+std::shared_ptr<IBlob> RelativeFileSystem::mapFile(const std::filesystem::path& name)
+{
+    return m_UnderlyingFS->mapFile(m_BasePath / name.relative_path());
+}
+
 bool RelativeFileSystem::writeFile(const std::filesystem::path& name, const void* data, size_t size)
 {
     return m_UnderlyingFS->writeFile(m_BasePath / name.relative_path(), data, size);
@@ -384,6 +523,19 @@ std::shared_ptr<IBlob> RootFileSystem::readFile(const std::filesystem::path& nam
     return nullptr;
 }
 
+std::shared_ptr<IBlob> RootFileSystem::mapFile(const std::filesystem::path& name)
+{
+    std::filesystem::path relativePath;
+    IFileSystem* fs = nullptr;
+
+    if (findMountPoint(name, &relativePath, &fs))
+    {
+        return fs->mapFile(relativePath);
+    }
+
+    return nullptr;
+}
+
 bool RootFileSystem::writeFile(const std::filesystem::path& name, const void* data, size_t size)
 {
     std::filesystem::path relativePath;
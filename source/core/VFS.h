@@ -81,6 +81,34 @@ namespace vfs
         [[nodiscard]] size_t size() const override;
     };
 
+    // Read-only view of a file mapped into the address space.
+    // Pages are loaded by the OS on first access and never copied into the heap.
+    class MappedBlob : public IBlob
+    {
+    private:
+        void* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef WIN32
+        void* m_fileHandle = nullptr;
+        void* m_mappingHandle = nullptr;
+#endif
+
+    public:
+        // Returns nullptr if the file cannot be opened or mapped.
+        static std::shared_ptr<MappedBlob> map(const std::filesystem::path& name);
+
+        MappedBlob() = default;
+        MappedBlob(const MappedBlob&) = delete;
+        MappedBlob& operator=(const MappedBlob&) = delete;
+        ~MappedBlob() override;
+        [[nodiscard]] const void* data() const override;
+        [[nodiscard]] size_t size() const override;
+
+        // Drops the resident pages fully inside [offset, offset + size) once a reader is done with them.
+        // They are read back from the file if touched again, so streaming readers keep peak memory low.
+        void evict(size_t offset, size_t size) const;
+    };
+
     // Basic interface for the virtual file system.
     class IFileSystem
     {
@@ -97,6 +125,11 @@ namespace vfs
         // Returns nullptr if the file cannot be read.
         virtual std::shared_ptr<IBlob> readFile(const std::filesystem::path& name) = 0;
 
+        // Map the entire file for reading, for large files that should not be copied into memory.
+        // File systems without mapping support fall back to reading the file.
+        // Returns nullptr if the file cannot be read.
+        virtual std::shared_ptr<IBlob> mapFile(const std::filesystem::path& name) { return readFile(name); }
+
         // Write the entire file.
         // Returns false if the file cannot be written.
         virtual bool writeFile(const std::filesystem::path& name, const void* data, size_t size) = 0;
@@ -120,6 +153,7 @@ namespace vfs
 		bool folderExists(const std::filesystem::path& name) override;
         bool fileExists(const std::filesystem::path& name) override;
         std::shared_ptr<IBlob> readFile(const std::filesystem::path& name) override;
+        std::shared_ptr<IBlob> mapFile(const std::filesystem::path& name) override;
         bool writeFile(const std::filesystem::path& name, const void* data, size_t size) override;
         int enumerateFiles(const std::filesystem::path& path, const std::vector<std::string>& extensions, enumerate_callback_t callback, bool allowDuplicates = false) override;
         int enumerateDirectories(const std::filesystem::path& path, enumerate_callback_t callback, bool allowDuplicates = false) override;
@@ -141,6 +175,7 @@ namespace vfs
         bool folderExists(const std::filesystem::path& name) override;
         bool fileExists(const std::filesystem::path& name) override;
         std::shared_ptr<IBlob> readFile(const std::filesystem::path& name) override;
+        std::shared_ptr<IBlob> mapFile(const std::filesystem::path& name) override;
         bool writeFile(const std::filesystem::path& name, const void* data, size_t size) override;
         int enumerateFiles(const std::filesystem::path& path, const std::vector<std::string>& extensions, enumerate_callback_t callback, bool allowDuplicates = false) override;
         int enumerateDirectories(const std::filesystem::path& path, enumerate_callback_t callback, bool allowDuplicates = false) override;
@@ -162,6 +197,7 @@ namespace vfs
 		bool folderExists(const std::filesystem::path& name) override;
         bool fileExists(const std::filesystem::path& name) override;
         std::shared_ptr<IBlob> readFile(const std::filesystem::path& name) override;
+        std::shared_ptr<IBlob> mapFile(const std::filesystem::path& name) override;
         bool writeFile(const std::filesystem::path& name, const void* data, size_t size) override;
         int enumerateFiles(const std::filesystem::path& path, const std::vector<std::string>& extensions, enumerate_callback_t callback, bool allowDuplicates = false) override;
         int enumerateDirectories(const std::filesystem::path& path, enumerate_callback_t callback, bool allowDuplicates = false) override;
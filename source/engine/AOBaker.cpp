@@ -0,0 +1,179 @@
+#include <engine/AOBaker.h>
+#include <core/Threading.h>
+#include <core/log.h>
+
+namespace croissant
+{
+	namespace
+	{
+		// PCG hash, so every vertex gets the same jitter on every run and cached bakes are reproducible
+		uint32_t HashRandom(uint32_t& state)
+		{
+			state = state * 747796405u + 2891336453u;
+			const uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+			return (word >> 22u) ^ word;
+		}
+
+		float RandomFloat(uint32_t& state)
+		{
+			return float(HashRandom(state) >> 8) * (1.0f / 16777216.0f);
+		}
+
+		// Orthonormal basis around a unit normal, from Duff et al., Building an Orthonormal Basis, Revisited
+		void BuildBasis(const glm::vec3& n, glm::vec3& outTangent, glm::vec3& outBitangent)
+		{
+			const float sign = std::copysign(1.0f, n.z);
+			const float a = -1.0f / (sign + n.z);
+			const float b = n.x * n.y * a;
+			outTangent = glm::vec3(1.0f + sign * n.x * n.x * a, sign * b, -sign * n.x);
+			outBitangent = glm::vec3(b, sign + n.y * n.y * a, -n.y);
+		}
+
+		uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+		{
+			// FNV-1a over 64-bit words, then the remaining bytes
+			const uint64_t prime = 0x100000001B3ull;
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+			size_t i = 0;
+			for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+			{
+				uint64_t word;
+				memcpy(&word, bytes + i, sizeof(word));
+				hash = (hash ^ word) * prime;
+			}
+			for (; i < size; i++)
+				hash = (hash ^ bytes[i]) * prime;
+			return hash;
+		}
+	}
+
+	bool AOBaker::Bake(Mesh* mesh, const AOBakeSettings& settings)
+	{
+		auto startTime = std::chrono::high_resolution_clock::now();
+		TriangleBVH bvh;
+		if (!bvh.Build(*mesh))
+		{
+			logger::warning("AOBaker::Bake: Could not build the triangle BVH.");
+			return false;
+		}
+		const double buildSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		if (!Bake(mesh, bvh, settings))
+			return false;
+
+		m_Stats.buildSeconds = buildSeconds;
+		return true;
+	}
+
+	bool AOBaker::Bake(Mesh* mesh, const TriangleBVH& bvh, const AOBakeSettings& settings)
+	{
+		m_Stats = Stats();
+		if (mesh->vertices.empty() || bvh.Empty())
+		{
+			logger::warning("AOBaker::Bake: Nothing to bake.");
+			return false;
+		}
+
+		auto startTime = std::chrono::high_resolution_clock::now();
+
+		const uint32_t strata = std::max(uint32_t(std::ceil(std::sqrt(float(std::max(settings.raysPerVertex, 1u))))), 1u);
+		const float diagonal = glm::length(bvh.GetMaxBounds() - bvh.GetMinBounds());
+		const float maxDistance = settings.maxDistance * diagonal;
+		const float bias = settings.bias * diagonal;
+
+		mesh->ambientOcclusion.resize(mesh->vertices.size());
+		std::atomic<uint64_t> rays = 0;
+		threading::ParallelFor(mesh->vertices.size(), VERTEX_BATCH, [&](size_t begin, size_t end)
+		{
+			uint64_t cast = 0;
+			for (size_t v = begin; v < end; v++)
+			{
+				const Vertex& vertex = mesh->vertices[v];
+				const float length = glm::length(vertex.normal);
+				if (!(length > 0.0f))
+				{
+					mesh->ambientOcclusion[v] = 255;
+					continue;
+				}
+
+				const glm::vec3 normal = vertex.normal / length;
+				glm::vec3 tangent, bitangent;
+				BuildBasis(normal, tangent, bitangent);
+				const glm::vec3 origin = vertex.position + normal * bias;
+
+				// Cosine-weighted directions, so the unoccluded fraction is the cosine-weighted visibility
+				uint32_t state = uint32_t(v) * 9781u + 1u;
+				uint32_t visible = 0;
+				for (uint32_t i = 0; i < strata; i++)
+				{
+					for (uint32_t j = 0; j < strata; j++)
+					{
+						const float u = (float(i) + RandomFloat(state)) / float(strata);
+						const float phi = 2.0f * 3.14159265f * (float(j) + RandomFloat(state)) / float(strata);
+						const float radius = std::sqrt(u);
+						const glm::vec3 direction = tangent * (radius * std::cos(phi)) + bitangent * (radius * std::sin(phi)) + normal * std::sqrt(1.0f - u);
+						if (!bvh.IsOccluded(origin, direction, maxDistance))
+							visible++;
+					}
+				}
+
+				mesh->ambientOcclusion[v] = uint8_t((visible * 255 + strata * strata / 2) / (strata * strata));
+				cast += strata * strata;
+			}
+			rays += cast;
+		});
+
+		m_Stats.vertices = mesh->vertices.size();
+		m_Stats.rays = rays;
+		m_Stats.bakeSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		logger::info("Baked AO for %zu vertices against %u triangles in %.2f ms: %llu rays, %.2f Mrays/s.",
+			mesh->vertices.size(), bvh.GetTriangleCount(), m_Stats.bakeSeconds * 1000.0, (unsigned long long)m_Stats.rays, m_Stats.GetRaysPerSecond() / 1e6);
+		return true;
+	}
+
+	uint64_t AOBaker::HashMesh(const Mesh& mesh)
+	{
+		uint64_t hash = 0xCBF29CE484222325ull;
+		hash = HashBytes(hash, mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+		hash = HashBytes(hash, mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+		return hash;
+	}
+
+	bool AOBaker::LoadOrBake(vfs::IFileSystem& fileSystem, const std::filesystem::path& path, Mesh* mesh, const AOBakeSettings& settings)
+	{
+		FileHeader expected = {};
+		expected.magic = FILE_MAGIC;
+		expected.version = FILE_VERSION;
+		expected.vertexCount = uint32_t(mesh->vertices.size());
+		expected.raysPerVertex = settings.raysPerVertex;
+		expected.maxDistance = settings.maxDistance;
+		expected.bias = settings.bias;
+		expected.meshHash = HashMesh(*mesh);
+
+		if (fileSystem.fileExists(path))
+		{
+			std::shared_ptr<vfs::IBlob> blob = fileSystem.readFile(path);
+			if (blob && blob->size() == sizeof(FileHeader) + mesh->vertices.size() && memcmp(blob->data(), &expected, sizeof(FileHeader)) == 0)
+			{
+				const uint8_t* data = static_cast<const uint8_t*>(blob->data()) + sizeof(FileHeader);
+				mesh->ambientOcclusion.assign(data, data + mesh->vertices.size());
+				m_Stats = Stats();
+				m_Stats.vertices = mesh->vertices.size();
+				m_Stats.fromCache = true;
+				return true;
+			}
+			logger::info("%s is stale, baking AO again.", path.generic_string().c_str());
+		}
+
+		if (!Bake(mesh, settings))
+			return false;
+
+		std::vector<uint8_t> data(sizeof(FileHeader) + mesh->ambientOcclusion.size());
+		memcpy(data.data(), &expected, sizeof(FileHeader));
+		memcpy(data.data() + sizeof(FileHeader), mesh->ambientOcclusion.data(), mesh->ambientOcclusion.size());
+		if (!fileSystem.writeFile(path, data.data(), data.size()))
+			logger::warning("AOBaker::LoadOrBake: Failed to write %s, the AO will be baked again next time.", path.generic_string().c_str());
+		return true;
+	}
+};
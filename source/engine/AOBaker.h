@@ -0,0 +1,64 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <core/VFS.h>
+#include <engine/TriangleBVH.h>
+
+namespace croissant
+{
+	struct AOBakeSettings
+	{
+		uint32_t raysPerVertex = 64;	// Rounded up to a square, one ray per stratum of the hemisphere
+		float    maxDistance = 0.1f;	// Occluder search radius, as a fraction of the mesh bounds diagonal
+		float    bias = 1e-4f;			// Ray origin offset along the normal, same units as maxDistance
+	};
+
+	// Bakes per-vertex ambient occlusion into Mesh::ambientOcclusion. Every vertex casts cosine-weighted rays over
+	// its normal's hemisphere, jittered within a square grid of strata, and stores the unoccluded fraction.
+	// Vertices are processed in batches of VERTEX_BATCH on all workers
+	class AOBaker
+	{
+	public:
+		static constexpr uint32_t VERTEX_BATCH = 256;
+		static constexpr uint32_t FILE_MAGIC = 0x4F415343;	// "CSAO"
+		static constexpr uint32_t FILE_VERSION = 1;
+
+		struct Stats
+		{
+			uint64_t vertices = 0;
+			uint64_t rays = 0;
+			double   buildSeconds = 0.0;	// BVH build, 0 when baking against a prebuilt one
+			double   bakeSeconds = 0.0;
+			bool     fromCache = false;
+
+			double GetRaysPerSecond() const { return bakeSeconds > 0.0 ? double(rays) / bakeSeconds : 0.0; }
+		};
+
+		bool Bake(Mesh* mesh, const AOBakeSettings& settings);
+
+		// The BVH may hold other meshes as well, such as the rest of the scene
+		bool Bake(Mesh* mesh, const TriangleBVH& bvh, const AOBakeSettings& settings);
+
+		// Loads the AO of mesh from path if it was baked from the same vertices, indices and settings, otherwise
+		// bakes it and writes it there, so the bake only runs when the mesh changes
+		bool LoadOrBake(vfs::IFileSystem& fileSystem, const std::filesystem::path& path, Mesh* mesh, const AOBakeSettings& settings);
+
+		const Stats& GetLastStats() const { return m_Stats; }
+
+	private:
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t vertexCount;
+			uint32_t raysPerVertex;
+			float    maxDistance;
+			float    bias;
+			uint64_t meshHash;
+		};
+
+		static uint64_t HashMesh(const Mesh& mesh);
+
+		Stats m_Stats;
+	};
+};
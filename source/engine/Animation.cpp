@@ -0,0 +1,383 @@
+#include <engine/Animation.h>
+#include <core/log.h>
+
+namespace croissant
+{
+	namespace
+	{
+		constexpr float TIME_SCALE = 65535.0f;
+		constexpr float ROTATION_RANGE = 0.70710678f;	// Smallest-three components lie in [-1/sqrt(2), 1/sqrt(2)]
+		constexpr float ROTATION_STEPS = 32767.0f;		// 15 bits per component
+
+		// Error metrics compare against a threshold prepared once per track, avoiding square roots and acos per key
+		struct VectorError
+		{
+			float limit;
+			explicit VectorError(float tolerance) : limit(tolerance * tolerance) {}
+			bool Within(const glm::vec3& a, const glm::vec3& b) const { return glm::dot(a - b, a - b) <= limit; }
+		};
+
+		// Rotations are within tolerance when the angle between them is. Unit quaternions on the same hemisphere that
+		// are an angle apart are a chord of 2 sin(angle / 4) apart, compared squared: cos(angle / 2) would round to 1 in
+		// float for tolerances below about 5e-4 radians and accept any nearby key
+		struct RotationError
+		{
+			float limit;
+			explicit RotationError(float tolerance)
+			{
+				const float chord = 2.0f * std::sin(std::min(tolerance, 3.14159265f) * 0.25f);
+				limit = chord * chord;
+			}
+			bool Within(const glm::vec4& a, const glm::vec4& b) const
+			{
+				const glm::vec4 na = glm::normalize(a);
+				const glm::vec4 nb = glm::dot(a, b) < 0.0f ? -glm::normalize(b) : glm::normalize(b);
+				return glm::dot(na - nb, na - nb) <= limit;
+			}
+		};
+
+		glm::vec3 Interpolate(const glm::vec3& a, const glm::vec3& b, float alpha) { return a + (b - a) * alpha; }
+
+		// Normalised lerp along the shorter arc
+		glm::vec4 Interpolate(const glm::vec4& a, const glm::vec4& b, float alpha)
+		{
+			glm::vec4 target = glm::dot(a, b) < 0.0f ? -b : b;
+			return glm::normalize(a + (target - a) * alpha);
+		}
+
+		// Greedy reduction: from each kept key, extends the segment as far as every skipped key stays within tolerance
+		template <typename T, typename Error>
+		std::vector<uint32_t> ReduceKeys(const std::vector<float>& times, const std::vector<T>& values, const Error& error)
+		{
+			std::vector<uint32_t> kept;
+			const uint32_t count = uint32_t(std::min(times.size(), values.size()));
+			if (count == 0)
+				return kept;
+
+			// Static channels are common and would otherwise cost a quadratic scan
+			kept.push_back(0);
+			bool constant = true;
+			for (uint32_t k = 1; k < count && constant; k++)
+				constant = error.Within(values[0], values[k]);
+			if (constant)
+				return kept;
+
+			uint32_t start = 0;
+			while (start + 1 < count)
+			{
+				uint32_t end = start + 1;
+				while (end + 1 < count)
+				{
+					const uint32_t candidate = end + 1;
+					const float span = std::max(times[candidate] - times[start], 1e-9f);
+
+					bool fits = true;
+					for (uint32_t k = start + 1; k < candidate && fits; k++)
+					{
+						float alpha = (times[k] - times[start]) / span;
+						fits = error.Within(Interpolate(values[start], values[candidate], alpha), values[k]);
+					}
+
+					if (!fits)
+						break;
+					end = candidate;
+				}
+
+				kept.push_back(end);
+				start = end;
+			}
+
+			return kept;
+		}
+
+		uint16_t QuantizeTime(float time, float duration)
+		{
+			float fraction = duration > 0.0f ? std::clamp(time / duration, 0.0f, 1.0f) : 0.0f;
+			return uint16_t(std::lround(fraction * TIME_SCALE));
+		}
+
+		// Smallest-three: the largest component is made positive and dropped, the other three are stored in 15 bits each.
+		// The index of the dropped component goes in the top bits of the first two words.
+		void EncodeRotation(glm::vec4 q, uint16_t& a, uint16_t& b, uint16_t& c)
+		{
+			q = glm::normalize(q);
+			int largest = 0;
+			for (int k = 1; k < 4; k++)
+			{
+				if (std::abs(q[k]) > std::abs(q[largest]))
+					largest = k;
+			}
+			if (q[largest] < 0.0f)
+				q = -q;
+
+			uint16_t words[3];
+			for (int k = 0, j = 0; k < 4; k++)
+			{
+				if (k == largest)
+					continue;
+				float normalized = std::clamp(q[k] / ROTATION_RANGE * 0.5f + 0.5f, 0.0f, 1.0f);
+				words[j++] = uint16_t(std::lround(normalized * ROTATION_STEPS));
+			}
+
+			a = uint16_t(words[0] | ((largest & 1) << 15));
+			b = uint16_t(words[1] | ((largest >> 1) << 15));
+			c = words[2];
+		}
+
+		// Branch-free decode, the dropped component is placed with selects
+		inline glm::vec4 DecodeRotation(uint16_t a, uint16_t b, uint16_t c)
+		{
+			const int largest = (a >> 15) | ((b >> 15) << 1);
+			const float v0 = (float(a & 0x7FFF) / ROTATION_STEPS * 2.0f - 1.0f) * ROTATION_RANGE;
+			const float v1 = (float(b & 0x7FFF) / ROTATION_STEPS * 2.0f - 1.0f) * ROTATION_RANGE;
+			const float v2 = (float(c & 0x7FFF) / ROTATION_STEPS * 2.0f - 1.0f) * ROTATION_RANGE;
+			const float w = std::sqrt(std::max(0.0f, 1.0f - v0 * v0 - v1 * v1 - v2 * v2));
+
+			return glm::vec4(
+				largest == 0 ? w : v0,
+				largest == 1 ? w : (largest < 1 ? v0 : v1),
+				largest == 2 ? w : (largest < 2 ? v1 : v2),
+				largest == 3 ? w : v2);
+		}
+
+		template <typename Channel>
+		void BeginTrack(Channel& channel)
+		{
+			channel.firstKey.push_back(uint32_t(channel.times.size()));
+		}
+
+		template <typename Channel>
+		void EndTrack(Channel& channel)
+		{
+			channel.lastKey.push_back(uint32_t(channel.times.size()) - 1);
+		}
+
+		void AppendVectorTrack(const std::vector<float>& times, const std::vector<glm::vec3>& values, const glm::vec3& defaultValue,
+			float tolerance, float duration, std::vector<uint16_t>& outTimes, std::vector<float>& x, std::vector<float>& y, std::vector<float>& z)
+		{
+			std::vector<uint32_t> kept = ReduceKeys(times, values, VectorError(tolerance));
+			if (kept.empty())
+			{
+				outTimes.push_back(0);
+				x.push_back(defaultValue.x);
+				y.push_back(defaultValue.y);
+				z.push_back(defaultValue.z);
+				return;
+			}
+
+			for (uint32_t k : kept)
+			{
+				outTimes.push_back(QuantizeTime(times[k], duration));
+				x.push_back(values[k].x);
+				y.push_back(values[k].y);
+				z.push_back(values[k].z);
+			}
+		}
+	}
+
+	AnimationClip::AnimationClip(std::string name, float duration, const std::vector<SourceTrack>& tracks)
+		: m_Name(std::move(name))
+		, m_Duration(duration)
+	{
+		for (const SourceTrack& track : tracks)
+		{
+			m_TrackNames.push_back(track.nodeName);
+			m_SourceSize += track.translations.size() * (sizeof(float) + sizeof(glm::vec3));
+			m_SourceSize += track.rotations.size() * (sizeof(float) + sizeof(glm::vec4));
+			m_SourceSize += track.scales.size() * (sizeof(float) + sizeof(glm::vec3));
+
+			BeginTrack(m_Translations);
+			AppendVectorTrack(track.translationTimes, track.translations, glm::vec3(0.0f), track.tolerances.translation, duration,
+				m_Translations.times, m_Translations.x, m_Translations.y, m_Translations.z);
+			EndTrack(m_Translations);
+
+			BeginTrack(m_Scales);
+			AppendVectorTrack(track.scaleTimes, track.scales, glm::vec3(1.0f), track.tolerances.scale, duration,
+				m_Scales.times, m_Scales.x, m_Scales.y, m_Scales.z);
+			EndTrack(m_Scales);
+
+			BeginTrack(m_Rotations);
+			std::vector<uint32_t> kept = ReduceKeys(track.rotationTimes, track.rotations, RotationError(track.tolerances.rotation));
+			if (kept.empty())
+			{
+				uint16_t a, b, c;
+				EncodeRotation(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), a, b, c);
+				m_Rotations.times.push_back(0);
+				m_Rotations.a.push_back(a);
+				m_Rotations.b.push_back(b);
+				m_Rotations.c.push_back(c);
+			}
+			for (uint32_t k : kept)
+			{
+				uint16_t a, b, c;
+				EncodeRotation(track.rotations[k], a, b, c);
+				m_Rotations.times.push_back(QuantizeTime(track.rotationTimes[k], duration));
+				m_Rotations.a.push_back(a);
+				m_Rotations.b.push_back(b);
+				m_Rotations.c.push_back(c);
+			}
+			EndTrack(m_Rotations);
+		}
+	}
+
+	std::unique_ptr<AnimationClip> AnimationClip::FromAssimp(const aiAnimation* animation, const Tolerances& tolerances)
+	{
+		// Assimp leaves the tick rate at 0 when the file does not specify one
+		const double ticksPerSecond = animation->mTicksPerSecond > 0.0 ? animation->mTicksPerSecond : 25.0;
+
+		std::vector<SourceTrack> tracks(animation->mNumChannels);
+		for (unsigned int i = 0; i < animation->mNumChannels; i++)
+		{
+			const aiNodeAnim* channel = animation->mChannels[i];
+			SourceTrack& track = tracks[i];
+			track.nodeName = channel->mNodeName.C_Str();
+			track.tolerances = tolerances;
+
+			for (unsigned int k = 0; k < channel->mNumPositionKeys; k++)
+			{
+				const aiVectorKey& key = channel->mPositionKeys[k];
+				track.translationTimes.push_back(float(key.mTime / ticksPerSecond));
+				track.translations.emplace_back(key.mValue.x, key.mValue.y, key.mValue.z);
+			}
+			for (unsigned int k = 0; k < channel->mNumRotationKeys; k++)
+			{
+				const aiQuatKey& key = channel->mRotationKeys[k];
+				track.rotationTimes.push_back(float(key.mTime / ticksPerSecond));
+				track.rotations.emplace_back(key.mValue.x, key.mValue.y, key.mValue.z, key.mValue.w);
+			}
+			for (unsigned int k = 0; k < channel->mNumScalingKeys; k++)
+			{
+				const aiVectorKey& key = channel->mScalingKeys[k];
+				track.scaleTimes.push_back(float(key.mTime / ticksPerSecond));
+				track.scales.emplace_back(key.mValue.x, key.mValue.y, key.mValue.z);
+			}
+		}
+
+		return std::make_unique<AnimationClip>(animation->mName.C_Str(), float(animation->mDuration / ticksPerSecond), tracks);
+	}
+
+	size_t AnimationClip::GetCompressedSize() const
+	{
+		auto channelSize = [](const KeyTimes& channel)
+		{
+			return channel.times.size() * sizeof(uint16_t) + (channel.firstKey.size() + channel.lastKey.size()) * sizeof(uint32_t);
+		};
+
+		return channelSize(m_Translations) + m_Translations.x.size() * 3 * sizeof(float) +
+			channelSize(m_Scales) + m_Scales.x.size() * 3 * sizeof(float) +
+			channelSize(m_Rotations) + m_Rotations.a.size() * 3 * sizeof(uint16_t);
+	}
+
+	AnimationSampler::AnimationSampler(const AnimationClip& clip) : m_Clip(clip)
+	{
+		const uint32_t trackCount = clip.GetTrackCount();
+		for (Segment* segment : { &m_Translation, &m_Rotation, &m_Scale })
+		{
+			segment->cursor.resize(trackCount);
+			segment->next.resize(trackCount);
+			segment->alpha.resize(trackCount);
+		}
+
+		m_Translation.cursor = clip.m_Translations.firstKey;
+		m_Rotation.cursor = clip.m_Rotations.firstKey;
+		m_Scale.cursor = clip.m_Scales.firstKey;
+
+		m_T.resize(trackCount);
+		m_R.resize(trackCount);
+		m_S.resize(trackCount);
+	}
+
+	void AnimationSampler::UpdateSegment(const AnimationClip::KeyTimes& channel, float time, Segment& segment)
+	{
+		const uint16_t* times = channel.times.data();
+		const uint32_t trackCount = uint32_t(segment.cursor.size());
+
+		// Forward playback moves each cursor by at most a key or two
+		for (uint32_t t = 0; t < trackCount; t++)
+		{
+			uint32_t cursor = segment.cursor[t];
+			const uint32_t last = channel.lastKey[t];
+			while (cursor < last && float(times[cursor + 1]) <= time)
+				cursor++;
+
+			segment.cursor[t] = cursor;
+			segment.next[t] = std::min(cursor + 1, last);
+		}
+
+		for (uint32_t t = 0; t < trackCount; t++)
+		{
+			const float t0 = float(times[segment.cursor[t]]);
+			const float t1 = float(times[segment.next[t]]);
+			segment.alpha[t] = std::clamp((time - t0) / std::max(t1 - t0, 1.0f), 0.0f, 1.0f);
+		}
+	}
+
+	void AnimationSampler::Sample(float time, glm::mat4* outLocalTransforms)
+	{
+		const float duration = m_Clip.GetDuration();
+		const float fraction = duration > 0.0f ? std::clamp(time / duration, 0.0f, 1.0f) : 0.0f;
+		const float keyTime = fraction * TIME_SCALE;
+
+		if (keyTime < m_LastTime)
+		{
+			m_Translation.cursor = m_Clip.m_Translations.firstKey;
+			m_Rotation.cursor = m_Clip.m_Rotations.firstKey;
+			m_Scale.cursor = m_Clip.m_Scales.firstKey;
+			m_CursorResets++;
+		}
+		m_LastTime = keyTime;
+
+		UpdateSegment(m_Clip.m_Translations, keyTime, m_Translation);
+		UpdateSegment(m_Clip.m_Rotations, keyTime, m_Rotation);
+		UpdateSegment(m_Clip.m_Scales, keyTime, m_Scale);
+
+		const uint32_t trackCount = m_Clip.GetTrackCount();
+		const AnimationClip::VectorChannel& translations = m_Clip.m_Translations;
+		const AnimationClip::VectorChannel& scales = m_Clip.m_Scales;
+		const AnimationClip::RotationChannel& rotations = m_Clip.m_Rotations;
+
+		// Straight interpolation loops over the gathered key pairs
+		for (uint32_t t = 0; t < trackCount; t++)
+		{
+			const uint32_t k0 = m_Translation.cursor[t], k1 = m_Translation.next[t];
+			const float alpha = m_Translation.alpha[t];
+			m_T[t] = glm::vec3(
+				translations.x[k0] + (translations.x[k1] - translations.x[k0]) * alpha,
+				translations.y[k0] + (translations.y[k1] - translations.y[k0]) * alpha,
+				translations.z[k0] + (translations.z[k1] - translations.z[k0]) * alpha);
+		}
+
+		for (uint32_t t = 0; t < trackCount; t++)
+		{
+			const uint32_t k0 = m_Scale.cursor[t], k1 = m_Scale.next[t];
+			const float alpha = m_Scale.alpha[t];
+			m_S[t] = glm::vec3(
+				scales.x[k0] + (scales.x[k1] - scales.x[k0]) * alpha,
+				scales.y[k0] + (scales.y[k1] - scales.y[k0]) * alpha,
+				scales.z[k0] + (scales.z[k1] - scales.z[k0]) * alpha);
+		}
+
+		for (uint32_t t = 0; t < trackCount; t++)
+		{
+			const uint32_t k0 = m_Rotation.cursor[t], k1 = m_Rotation.next[t];
+			const glm::vec4 q0 = DecodeRotation(rotations.a[k0], rotations.b[k0], rotations.c[k0]);
+			const glm::vec4 q1 = DecodeRotation(rotations.a[k1], rotations.b[k1], rotations.c[k1]);
+			m_R[t] = Interpolate(q0, q1, m_Rotation.alpha[t]);
+		}
+
+		for (uint32_t t = 0; t < trackCount; t++)
+		{
+			const glm::vec4& q = m_R[t];
+			const glm::vec3& s = m_S[t];
+			const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+			const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+			const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+			outLocalTransforms[t] = glm::mat4(
+				glm::vec4(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f) * s.x,
+				glm::vec4(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f) * s.y,
+				glm::vec4(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f) * s.z,
+				glm::vec4(m_T[t], 1.0f));
+		}
+	}
+};
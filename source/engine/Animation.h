@@ -0,0 +1,110 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <assimp/scene.h>
+#include <glm/glm.hpp>
+
+namespace croissant
+{
+	// Keyframe animation clip with compressed structure-of-arrays tracks.
+	// Each track animates one node through translation, rotation and scale channels. Keys that linear interpolation
+	// reproduces within the track's tolerance are dropped, key times are stored as 16-bit fractions of the clip and
+	// rotations use the smallest-three encoding in 48 bits. Keys of all tracks are concatenated per channel.
+	class AnimationClip
+	{
+	public:
+		// Maximum error allowed when dropping keys: scene units for translation and scale, radians for rotation
+		struct Tolerances
+		{
+			float translation = 1e-4f;
+			float rotation = 1e-4f;
+			float scale = 1e-4f;
+		};
+
+		// Uncompressed keys of one node, times in seconds. Rotations are (x, y, z, w) quaternions
+		struct SourceTrack
+		{
+			std::string nodeName;
+			std::vector<float> translationTimes, rotationTimes, scaleTimes;
+			std::vector<glm::vec3> translations;
+			std::vector<glm::vec4> rotations;
+			std::vector<glm::vec3> scales;
+			Tolerances tolerances;
+		};
+
+		AnimationClip(std::string name, float duration, const std::vector<SourceTrack>& tracks);
+
+		// Converts an Assimp animation, every channel gets the given tolerances
+		static std::unique_ptr<AnimationClip> FromAssimp(const aiAnimation* animation, const Tolerances& tolerances);
+
+		const std::string& GetName() const { return m_Name; }
+		float GetDuration() const { return m_Duration; }
+		uint32_t GetTrackCount() const { return uint32_t(m_TrackNames.size()); }
+		const std::string& GetTrackName(uint32_t track) const { return m_TrackNames[track]; }
+
+		// Size of the keys as float times and values, and as stored
+		size_t GetSourceSize() const { return m_SourceSize; }
+		size_t GetCompressedSize() const;
+		uint32_t GetKeyCount() const { return uint32_t(m_Translations.times.size() + m_Rotations.times.size() + m_Scales.times.size()); }
+
+	private:
+		friend class AnimationSampler;
+
+		struct KeyTimes
+		{
+			std::vector<uint32_t> firstKey;	// Per track, every track has at least one key
+			std::vector<uint32_t> lastKey;	// Per track, inclusive
+			std::vector<uint16_t> times;	// Per key, fraction of the clip duration
+		};
+
+		struct VectorChannel : KeyTimes
+		{
+			std::vector<float> x, y, z;
+		};
+
+		struct RotationChannel : KeyTimes
+		{
+			std::vector<uint16_t> a, b, c;	// Smallest-three words
+		};
+
+		std::string m_Name;
+		float m_Duration = 0.0f;
+		std::vector<std::string> m_TrackNames;
+		VectorChannel m_Translations;
+		VectorChannel m_Scales;
+		RotationChannel m_Rotations;
+		size_t m_SourceSize = 0;
+	};
+
+	// Evaluates every track of a clip per call. Key cursors are kept between calls, so forward playback only
+	// steps over the keys passed since the last sample; seeking backwards restarts them.
+	class AnimationSampler
+	{
+	public:
+		explicit AnimationSampler(const AnimationClip& clip);
+
+		// Writes one local transform (T * R * S) per track. Time is clamped to the clip
+		void Sample(float time, glm::mat4* outLocalTransforms);
+
+		uint32_t GetCursorResets() const { return m_CursorResets; }
+
+	private:
+		struct Segment
+		{
+			std::vector<uint32_t> cursor;	// Current key per track
+			std::vector<uint32_t> next;		// Key after the cursor, or the cursor at the end of the track
+			std::vector<float> alpha;		// Interpolation factor between the two
+		};
+
+		void UpdateSegment(const AnimationClip::KeyTimes& channel, float time, Segment& segment);
+
+		const AnimationClip& m_Clip;
+		Segment m_Translation, m_Rotation, m_Scale;
+		float m_LastTime = -1.0f;
+		uint32_t m_CursorResets = 0;
+
+		// Interpolated values per track
+		std::vector<glm::vec3> m_T, m_S;
+		std::vector<glm::vec4> m_R;
+	};
+};
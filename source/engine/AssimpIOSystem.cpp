@@ -0,0 +1,104 @@
+#include <engine/AssimpIOSystem.h>
+#include <core/log.h>
+
+namespace croissant
+{
+	size_t VFSIOStream::Read(void* pvBuffer, size_t pSize, size_t pCount)
+	{
+		if (pSize == 0 || pCount == 0)
+		{
+			return 0;
+		}
+
+		const size_t available = m_Blob->size() - m_Position;
+		const size_t elements = std::min(pCount, available / pSize);
+		const size_t bytes = elements * pSize;
+		if (bytes == 0)
+		{
+			return 0;
+		}
+
+		memcpy(pvBuffer, static_cast<const uint8_t*>(m_Blob->data()) + m_Position, bytes);
+		m_Position += bytes;
+
+		return elements;
+	}
+
+	size_t VFSIOStream::Write(const void* pvBuffer, size_t pSize, size_t pCount)
+	{
+		// VFS blobs are read-only
+		return 0;
+	}
+
+	aiReturn VFSIOStream::Seek(size_t pOffset, aiOrigin pOrigin)
+	{
+		size_t newPosition = 0;
+		switch (pOrigin)
+		{
+		case aiOrigin_SET: newPosition = pOffset; break;
+		case aiOrigin_CUR: newPosition = m_Position + pOffset; break;
+		case aiOrigin_END: newPosition = m_Blob->size() - pOffset; break;
+		default: return aiReturn_FAILURE;
+		}
+
+		if (newPosition > m_Blob->size())
+		{
+			return aiReturn_FAILURE;
+		}
+
+		m_Position = newPosition;
+		return aiReturn_SUCCESS;
+	}
+
+	size_t VFSIOStream::Tell() const
+	{
+		return m_Position;
+	}
+
+	size_t VFSIOStream::FileSize() const
+	{
+		return m_Blob->size();
+	}
+
+	void VFSIOStream::Flush()
+	{
+	}
+
+	std::filesystem::path VFSIOSystem::NormalizePath(const char* pFile)
+	{
+		// Assimp builds side-file paths with whatever separator the model path used
+		std::string path = pFile;
+		std::replace(path.begin(), path.end(), '\\', '/');
+		return std::filesystem::path(path).lexically_normal();
+	}
+
+	bool VFSIOSystem::Exists(const char* pFile) const
+	{
+		return m_FS->fileExists(NormalizePath(pFile));
+	}
+
+	Assimp::IOStream* VFSIOSystem::Open(const char* pFile, const char* pMode)
+	{
+		if (strchr(pMode, 'w') || strchr(pMode, 'a'))
+		{
+			logger::warning("VFSIOSystem::Open: write access requested for %s, VFS streams are read-only.", pFile);
+			return nullptr;
+		}
+
+		std::shared_ptr<vfs::IBlob> blob = m_FS->readFile(NormalizePath(pFile));
+		if (!blob)
+		{
+			return nullptr;
+		}
+
+		m_BytesRead += blob->size();
+		m_FilesOpened++;
+
+		return new VFSIOStream(std::move(blob));
+	}
+
+	void VFSIOSystem::Close(Assimp::IOStream* pFile)
+	{
+		delete pFile;
+	}
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <core/VFS.h>
+
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
+
+namespace croissant
+{
+	// Read-only Assimp stream over a VFS blob. Reads are served straight from the blob memory,
+	// so whatever backs the blob (native file, archive, memory-mapped view) is used as is.
+	class VFSIOStream : public Assimp::IOStream
+	{
+	public:
+		VFSIOStream(std::shared_ptr<vfs::IBlob> blob) : m_Blob(std::move(blob)) {}
+
+		size_t Read(void* pvBuffer, size_t pSize, size_t pCount) override;
+		size_t Write(const void* pvBuffer, size_t pSize, size_t pCount) override;
+		aiReturn Seek(size_t pOffset, aiOrigin pOrigin) override;
+		size_t Tell() const override;
+		size_t FileSize() const override;
+		void Flush() override;
+
+	private:
+		std::shared_ptr<vfs::IBlob> m_Blob;
+		size_t m_Position = 0;
+	};
+
+	// Routes every file Assimp opens (the model and any side files such as .bin or .mtl) through a vfs::IFileSystem.
+	// Ownership is taken by Assimp::Importer::SetIOHandler.
+	class VFSIOSystem : public Assimp::IOSystem
+	{
+	public:
+		VFSIOSystem(std::shared_ptr<vfs::IFileSystem> fs) : m_FS(std::move(fs)) {}
+
+		bool Exists(const char* pFile) const override;
+		char getOsSeparator() const override { return '/'; }
+		Assimp::IOStream* Open(const char* pFile, const char* pMode = "rb") override;
+		void Close(Assimp::IOStream* pFile) override;
+
+		// Read instrumentation, accumulated over all files opened by this system
+		size_t GetBytesRead() const { return m_BytesRead; }
+		uint32_t GetFilesOpened() const { return m_FilesOpened; }
+
+	private:
+		static std::filesystem::path NormalizePath(const char* pFile);
+
+		std::shared_ptr<vfs::IFileSystem> m_FS;
+		size_t m_BytesRead = 0;
+		uint32_t m_FilesOpened = 0;
+	};
+};
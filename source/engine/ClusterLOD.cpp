@@ -0,0 +1,747 @@
+#include <engine/ClusterLOD.h>
+#include <core/Threading.h>
+#include <core/log.h>
+
+#include <queue>
+
+namespace croissant
+{
+	namespace
+	{
+		constexpr float INFINITE_ERROR = std::numeric_limits<float>::infinity();
+
+		uint64_t SpreadBits(uint32_t value)
+		{
+			uint64_t x = value & 0x1FFFFF;
+			x = (x | (x << 32)) & 0x1F00000000FFFFull;
+			x = (x | (x << 16)) & 0x1F0000FF0000FFull;
+			x = (x | (x << 8)) & 0x100F00F00F00F00Full;
+			x = (x | (x << 4)) & 0x10C30C30C30C30C3ull;
+			x = (x | (x << 2)) & 0x1249249249249249ull;
+			return x;
+		}
+
+		// 63-bit Morton code of a point inside [minBounds, minBounds + 1 / inverseExtent]
+		uint64_t MortonCode(const glm::vec3& position, const glm::vec3& minBounds, const glm::vec3& inverseExtent)
+		{
+			const glm::vec3 unit = glm::clamp((position - minBounds) * inverseExtent, glm::vec3(0.0f), glm::vec3(1.0f));
+			const glm::vec3 scaled = unit * float(0x1FFFFF);
+			return SpreadBits(uint32_t(scaled.x)) | (SpreadBits(uint32_t(scaled.y)) << 1) | (SpreadBits(uint32_t(scaled.z)) << 2);
+		}
+
+		glm::vec3 InverseExtent(const glm::vec3& minBounds, const glm::vec3& maxBounds)
+		{
+			return 1.0f / glm::max(maxBounds - minBounds, glm::vec3(1e-12f));
+		}
+
+		// Centre of the box, radius to the furthest vertex
+		glm::vec4 BoundingSphere(const std::vector<Vertex>& vertices, const uint32_t* indices, size_t indexCount)
+		{
+			glm::vec3 minBounds(std::numeric_limits<float>::max()), maxBounds(-std::numeric_limits<float>::max());
+			for (size_t i = 0; i < indexCount; i++)
+			{
+				minBounds = glm::min(minBounds, vertices[indices[i]].position);
+				maxBounds = glm::max(maxBounds, vertices[indices[i]].position);
+			}
+
+			const glm::vec3 centre = (minBounds + maxBounds) * 0.5f;
+			float radiusSquared = 0.0f;
+			for (size_t i = 0; i < indexCount; i++)
+			{
+				const glm::vec3 offset = vertices[indices[i]].position - centre;
+				radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+			}
+			return glm::vec4(centre, std::sqrt(radiusSquared));
+		}
+
+		// Sphere enclosing every sphere, centred on their box
+		glm::vec4 MergeSpheres(const std::vector<glm::vec4>& spheres)
+		{
+			glm::vec3 minBounds(std::numeric_limits<float>::max()), maxBounds(-std::numeric_limits<float>::max());
+			for (const glm::vec4& sphere : spheres)
+			{
+				minBounds = glm::min(minBounds, glm::vec3(sphere) - glm::vec3(sphere.w));
+				maxBounds = glm::max(maxBounds, glm::vec3(sphere) + glm::vec3(sphere.w));
+			}
+
+			const glm::vec3 centre = (minBounds + maxBounds) * 0.5f;
+			float radius = 0.0f;
+			for (const glm::vec4& sphere : spheres)
+				radius = std::max(radius, glm::length(glm::vec3(sphere) - centre) + sphere.w);
+			return glm::vec4(centre, radius);
+		}
+
+		// Reorders the triangles along a Morton curve of their centroids and cuts them into runs of at most
+		// maxTriangles, appended to outRanges as (first triangle, triangle count)
+		void SplitIntoClusters(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t maxTriangles, std::vector<std::pair<uint32_t, uint32_t>>& outRanges)
+		{
+			const size_t triangleCount = indices.size() / 3;
+			glm::vec3 minBounds(std::numeric_limits<float>::max()), maxBounds(-std::numeric_limits<float>::max());
+			std::vector<glm::vec3> centroids(triangleCount);
+			for (size_t t = 0; t < triangleCount; t++)
+			{
+				centroids[t] = (vertices[indices[t * 3]].position + vertices[indices[t * 3 + 1]].position + vertices[indices[t * 3 + 2]].position) / 3.0f;
+				minBounds = glm::min(minBounds, centroids[t]);
+				maxBounds = glm::max(maxBounds, centroids[t]);
+			}
+
+			const glm::vec3 inverseExtent = InverseExtent(minBounds, maxBounds);
+			std::vector<std::pair<uint64_t, uint32_t>> order(triangleCount);
+			for (size_t t = 0; t < triangleCount; t++)
+				order[t] = { MortonCode(centroids[t], minBounds, inverseExtent), uint32_t(t) };
+			std::sort(order.begin(), order.end());
+
+			std::vector<uint32_t> sorted(indices.size());
+			for (size_t t = 0; t < triangleCount; t++)
+				memcpy(&sorted[t * 3], &indices[size_t(order[t].second) * 3], 3 * sizeof(uint32_t));
+			indices.swap(sorted);
+
+			for (uint32_t first = 0; first < triangleCount; first += maxTriangles)
+				outRanges.emplace_back(first, std::min<uint32_t>(maxTriangles, uint32_t(triangleCount) - first));
+		}
+
+		struct Quadric
+		{
+			double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+
+			static Quadric FromPlane(const glm::dvec3& n, double d)
+			{
+				Quadric q;
+				q.a2 = n.x * n.x; q.ab = n.x * n.y; q.ac = n.x * n.z; q.ad = n.x * d;
+				q.b2 = n.y * n.y; q.bc = n.y * n.z; q.bd = n.y * d;
+				q.c2 = n.z * n.z; q.cd = n.z * d;
+				q.d2 = d * d;
+				return q;
+			}
+
+			Quadric& operator+=(const Quadric& o)
+			{
+				a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad; b2 += o.b2;
+				bc += o.bc; bd += o.bd; c2 += o.c2; cd += o.cd; d2 += o.d2;
+				return *this;
+			}
+
+			// Sum of squared distances to the accumulated planes
+			double Evaluate(const glm::vec3& p) const
+			{
+				const double x = p.x, y = p.y, z = p.z;
+				return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+					+ b2 * y * y + 2 * bc * y * z + 2 * bd * y
+					+ c2 * z * z + 2 * cd * z + d2;
+			}
+		};
+
+		// Quadric error edge collapses of a group of triangles down to targetTriangles, moving a vertex onto one of its
+		// neighbours so no vertex is created. Vertices on edges not shared by exactly two triangles of the group (the
+		// group border and mesh boundaries) never move, so the result still matches the neighbouring groups.
+		// Returns the object space error, the square root of the largest collapse cost
+		float SimplifyGroup(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t targetTriangles)
+		{
+			// Local vertex numbering
+			std::vector<uint32_t> globals(indices);
+			std::sort(globals.begin(), globals.end());
+			globals.erase(std::unique(globals.begin(), globals.end()), globals.end());
+
+			const uint32_t vertexCount = uint32_t(globals.size());
+			std::vector<uint32_t> triangles(indices.size());
+			for (size_t i = 0; i < indices.size(); i++)
+				triangles[i] = uint32_t(std::lower_bound(globals.begin(), globals.end(), indices[i]) - globals.begin());
+
+			std::vector<glm::vec3> positions(vertexCount);
+			for (uint32_t v = 0; v < vertexCount; v++)
+				positions[v] = vertices[globals[v]].position;
+
+			const uint32_t triangleCount = uint32_t(triangles.size() / 3);
+			std::unordered_map<EdgeKey, uint32_t, EdgeKeyHash> edgeUses;
+			edgeUses.reserve(triangles.size());
+			std::vector<std::vector<uint32_t>> vertexTriangles(vertexCount);
+			std::vector<Quadric> quadrics(vertexCount);
+			for (uint32_t t = 0; t < triangleCount; t++)
+			{
+				const uint32_t* corners = &triangles[t * 3];
+				glm::dvec3 normal = glm::cross(glm::dvec3(positions[corners[1]] - positions[corners[0]]), glm::dvec3(positions[corners[2]] - positions[corners[0]]));
+				const double length = glm::length(normal);
+				normal = length > 0.0 ? normal / length : glm::dvec3(0.0);
+				const Quadric plane = Quadric::FromPlane(normal, -glm::dot(normal, glm::dvec3(positions[corners[0]])));
+
+				for (int k = 0; k < 3; k++)
+				{
+					edgeUses[EdgeKey(corners[k], corners[(k + 1) % 3])]++;
+					vertexTriangles[corners[k]].push_back(t);
+					quadrics[corners[k]] += plane;
+				}
+			}
+
+			std::vector<uint8_t> locked(vertexCount, 0);
+			for (const auto& [edge, uses] : edgeUses)
+			{
+				if (uses != 2)
+					locked[edge.v0] = locked[edge.v1] = 1;
+			}
+
+			struct Candidate
+			{
+				double cost;
+				uint32_t from, to;
+				uint32_t fromStamp, toStamp;
+				bool operator>(const Candidate& other) const { return cost > other.cost; }
+			};
+
+			std::vector<uint8_t> alive(triangleCount, 1);
+			std::vector<uint8_t> removed(vertexCount, 0);
+			std::vector<uint32_t> stamps(vertexCount, 0);
+			std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> heap;
+
+			auto push = [&](uint32_t from, uint32_t to)
+			{
+				if (locked[from])
+					return;
+				Quadric q = quadrics[from];
+				q += quadrics[to];
+				heap.push({ q.Evaluate(positions[to]), from, to, stamps[from], stamps[to] });
+			};
+
+			for (uint32_t t = 0; t < triangleCount; t++)
+			{
+				for (int k = 0; k < 3; k++)
+				{
+					push(triangles[t * 3 + k], triangles[t * 3 + (k + 1) % 3]);
+					push(triangles[t * 3 + (k + 1) % 3], triangles[t * 3 + k]);
+				}
+			}
+
+			std::vector<uint32_t> fromNeighbours, toNeighbours;
+			auto gatherNeighbours = [&](uint32_t v, std::vector<uint32_t>& out)
+			{
+				out.clear();
+				for (uint32_t t : vertexTriangles[v])
+				{
+					if (!alive[t])
+						continue;
+					for (int k = 0; k < 3; k++)
+					{
+						if (triangles[t * 3 + k] != v)
+							out.push_back(triangles[t * 3 + k]);
+					}
+				}
+				std::sort(out.begin(), out.end());
+				out.erase(std::unique(out.begin(), out.end()), out.end());
+			};
+
+			uint32_t liveTriangles = triangleCount;
+			double maxCost = 0.0;
+			while (liveTriangles > targetTriangles && !heap.empty())
+			{
+				const Candidate candidate = heap.top();
+				heap.pop();
+				const uint32_t from = candidate.from, to = candidate.to;
+				if (removed[from] || removed[to] || stamps[from] != candidate.fromStamp || stamps[to] != candidate.toStamp)
+					continue;
+
+				// Link condition: the only common neighbours are the apexes of the triangles on the edge
+				uint32_t shared = 0;
+				for (uint32_t t : vertexTriangles[from])
+				{
+					if (alive[t] && (triangles[t * 3] == to || triangles[t * 3 + 1] == to || triangles[t * 3 + 2] == to))
+						shared++;
+				}
+				if (shared == 0)
+					continue;
+
+				gatherNeighbours(from, fromNeighbours);
+				gatherNeighbours(to, toNeighbours);
+				size_t common = 0;
+				for (uint32_t n : fromNeighbours)
+					common += std::binary_search(toNeighbours.begin(), toNeighbours.end(), n) ? 1 : 0;
+				if (common != shared)
+					continue;
+
+				// Locked vertices also belong to triangles outside the group, which may already join them. A new
+				// edge between two of them could duplicate one of those and leave it with more than two triangles
+				bool bridges = false;
+				for (uint32_t n : fromNeighbours)
+				{
+					if (n != to && locked[n] && locked[to] && !std::binary_search(toNeighbours.begin(), toNeighbours.end(), n))
+					{
+						bridges = true;
+						break;
+					}
+				}
+				if (bridges)
+					continue;
+
+				// Reject collapses that flip or flatten a remaining triangle
+				bool flips = false;
+				for (uint32_t t : vertexTriangles[from])
+				{
+					const uint32_t* corners = &triangles[t * 3];
+					if (!alive[t] || corners[0] == to || corners[1] == to || corners[2] == to)
+						continue;
+
+					glm::vec3 moved[3];
+					for (int k = 0; k < 3; k++)
+						moved[k] = positions[corners[k] == from ? to : corners[k]];
+					const glm::vec3 before = glm::cross(positions[corners[1]] - positions[corners[0]], positions[corners[2]] - positions[corners[0]]);
+					const glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+					if (glm::dot(before, after) <= 0.1f * glm::length(before) * glm::length(after))
+					{
+						flips = true;
+						break;
+					}
+				}
+				if (flips)
+					continue;
+
+				for (uint32_t t : vertexTriangles[from])
+				{
+					if (!alive[t])
+						continue;
+
+					uint32_t* corners = &triangles[t * 3];
+					if (corners[0] == to || corners[1] == to || corners[2] == to)
+					{
+						alive[t] = 0;
+						liveTriangles--;
+						continue;
+					}
+					for (int k = 0; k < 3; k++)
+					{
+						if (corners[k] == from)
+							corners[k] = to;
+					}
+					vertexTriangles[to].push_back(t);
+				}
+
+				removed[from] = 1;
+				quadrics[to] += quadrics[from];
+				stamps[to]++;
+				maxCost = std::max(maxCost, candidate.cost);
+
+				// Only the edges of the kept vertex change cost
+				gatherNeighbours(to, toNeighbours);
+				for (uint32_t n : toNeighbours)
+				{
+					push(n, to);
+					push(to, n);
+				}
+			}
+
+			indices.clear();
+			for (uint32_t t = 0; t < triangleCount; t++)
+			{
+				if (!alive[t])
+					continue;
+				for (int k = 0; k < 3; k++)
+					indices.push_back(globals[triangles[t * 3 + k]]);
+			}
+			return float(std::sqrt(std::max(maxCost, 0.0)));
+		}
+	}
+
+	namespace
+	{
+		// Partitions clusters, ordered along a Morton curve, into groups of at most groupSize that share as many border
+		// edges as possible, so few vertices end up locked on group borders. Every group starts from the first free
+		// cluster in order (last with reverse) and grows by the free cluster sharing the most edges with it. Groups are
+		// appended to outGroups as ranges of outMembers, which holds the cluster indices
+		void GroupClusters(const ClusterDAG& dag, const std::vector<uint32_t>& ordered, uint32_t groupSize, bool reverse,
+			std::vector<uint32_t>& outMembers, std::vector<std::pair<uint32_t, uint32_t>>& outGroups)
+		{
+			const uint32_t count = uint32_t(ordered.size());
+
+			// Clusters of a cut meet on edges that appear in exactly two of them
+			std::unordered_map<EdgeKey, uint32_t, EdgeKeyHash> edgeOwners;
+			std::vector<std::pair<uint32_t, uint32_t>> sharedEdges;
+			for (uint32_t i = 0; i < count; i++)
+			{
+				const Cluster& cluster = dag.clusters[ordered[i]];
+				const uint32_t* indices = &dag.indices[cluster.firstIndex];
+				for (uint32_t corner = 0; corner < cluster.triangleCount * 3; corner++)
+				{
+					const uint32_t next = corner % 3 == 2 ? corner - 2 : corner + 1;
+					const auto [owner, inserted] = edgeOwners.emplace(EdgeKey(indices[corner], indices[next]), i);
+					if (!inserted && owner->second != i)
+					{
+						sharedEdges.emplace_back(owner->second, i);
+						sharedEdges.emplace_back(i, owner->second);
+					}
+				}
+			}
+			std::sort(sharedEdges.begin(), sharedEdges.end());
+
+			// Weighted adjacency, neighbours of i in [offsets[i], offsets[i + 1])
+			std::vector<uint32_t> offsets(count + 1, 0);
+			std::vector<std::pair<uint32_t, uint32_t>> neighbours;	// Cluster, shared edges
+			for (size_t e = 0; e < sharedEdges.size(); e++)
+			{
+				if (e > 0 && sharedEdges[e] == sharedEdges[e - 1])
+					neighbours.back().second++;
+				else
+				{
+					neighbours.emplace_back(sharedEdges[e].second, 1);
+					offsets[sharedEdges[e].first + 1]++;
+				}
+			}
+			for (uint32_t i = 0; i < count; i++)
+				offsets[i + 1] += offsets[i];
+
+			std::vector<uint8_t> grouped(count, 0);
+			std::vector<uint32_t> weights(count, 0);
+			std::vector<uint32_t> candidates;
+			for (uint32_t step = 0; step < count; step++)
+			{
+				const uint32_t seed = reverse ? count - 1 - step : step;
+				if (grouped[seed])
+					continue;
+
+				const uint32_t first = uint32_t(outMembers.size());
+				candidates.clear();
+				for (uint32_t added = seed; added != INVALID;)
+				{
+					grouped[added] = 1;
+					outMembers.push_back(ordered[added]);
+					if (outMembers.size() - first >= groupSize)
+						break;
+
+					for (uint32_t n = offsets[added]; n < offsets[added + 1]; n++)
+					{
+						const auto [neighbour, shared] = neighbours[n];
+						if (grouped[neighbour])
+							continue;
+						if (weights[neighbour] == 0)
+							candidates.push_back(neighbour);
+						weights[neighbour] += shared;
+					}
+
+					added = INVALID;
+					for (uint32_t candidate : candidates)
+					{
+						if (!grouped[candidate] && (added == INVALID || weights[candidate] > weights[added]))
+							added = candidate;
+					}
+				}
+				for (uint32_t candidate : candidates)
+					weights[candidate] = 0;
+				outGroups.emplace_back(first, uint32_t(outMembers.size()) - first);
+			}
+		}
+	}
+
+	bool ClusterDAG::Build(const Mesh& mesh, const ClusterLODSettings& settings, ClusterDAG& outDAG)
+	{
+		outDAG = ClusterDAG();
+		if (mesh.indices.empty() || settings.maxClusterTriangles == 0 || settings.groupSize == 0)
+		{
+			logger::warning("ClusterDAG::Build: Nothing to build.");
+			return false;
+		}
+
+		auto startTime = std::chrono::high_resolution_clock::now();
+
+		auto addCluster = [&](const uint32_t* indices, uint32_t triangleCount, uint32_t level, const glm::vec4& lodBounds, float error)
+		{
+			Cluster cluster;
+			cluster.firstIndex = uint32_t(outDAG.indices.size());
+			cluster.triangleCount = triangleCount;
+			cluster.level = level;
+			cluster.group = INVALID;
+			cluster.bounds = BoundingSphere(mesh.vertices, indices, size_t(triangleCount) * 3);
+			cluster.lodBounds = level == 0 ? cluster.bounds : lodBounds;
+			cluster.error = error;
+			cluster.parentLodBounds = glm::vec4(cluster.lodBounds);
+			cluster.parentError = INFINITE_ERROR;
+			outDAG.indices.insert(outDAG.indices.end(), indices, indices + size_t(triangleCount) * 3);
+			outDAG.clusters.push_back(cluster);
+		};
+
+		// Level 0, the source triangles
+		std::vector<uint32_t> current;
+		{
+			std::vector<uint32_t> indices = mesh.indices;
+			std::vector<std::pair<uint32_t, uint32_t>> ranges;
+			SplitIntoClusters(mesh.vertices, indices, settings.maxClusterTriangles, ranges);
+			outDAG.indices.reserve(indices.size() * 2);
+			outDAG.clusters.reserve(ranges.size() * 2);
+			for (const auto& [first, count] : ranges)
+			{
+				current.push_back(uint32_t(outDAG.clusters.size()));
+				addCluster(&indices[size_t(first) * 3], count, 0, glm::vec4(0.0f), 0.0f);
+			}
+		}
+
+		struct GroupResult
+		{
+			std::vector<uint32_t> indices;
+			std::vector<std::pair<uint32_t, uint32_t>> ranges;
+			float error = 0.0f;
+			bool simplified = false;
+		};
+
+		// current is always a complete cut of the mesh: the clusters of the last level plus those whose groups could not
+		// be simplified yet, which are carried forward and grouped again with their new neighbours. A pass that
+		// simplifies nothing retries the same level with groups twice as large, until one group holds every cluster
+		uint32_t level = 0;
+		uint32_t groupSize = settings.groupSize;
+		for (uint32_t pass = 0; level + 1 < settings.maxLevels && current.size() > 1; pass++)
+		{
+			// Groups of adjacent clusters, seeded along a Morton curve of the cluster bounds. Odd passes seed from the
+			// other end so borders locked in one pass tend to be interior in the next
+			glm::vec3 minBounds(std::numeric_limits<float>::max()), maxBounds(-std::numeric_limits<float>::max());
+			for (uint32_t c : current)
+			{
+				minBounds = glm::min(minBounds, glm::vec3(outDAG.clusters[c].bounds));
+				maxBounds = glm::max(maxBounds, glm::vec3(outDAG.clusters[c].bounds));
+			}
+			const glm::vec3 inverseExtent = InverseExtent(minBounds, maxBounds);
+			std::vector<std::pair<uint64_t, uint32_t>> order(current.size());
+			for (size_t i = 0; i < current.size(); i++)
+				order[i] = { MortonCode(glm::vec3(outDAG.clusters[current[i]].bounds), minBounds, inverseExtent), current[i] };
+			std::sort(order.begin(), order.end());
+			for (size_t i = 0; i < current.size(); i++)
+				current[i] = order[i].second;
+
+			std::vector<uint32_t> members;
+			std::vector<std::pair<uint32_t, uint32_t>> groups;	// Ranges of members
+			GroupClusters(outDAG, current, groupSize, pass % 2 == 1, members, groups);
+
+			std::vector<GroupResult> results(groups.size());
+			threading::ParallelFor(groups.size(), 1, [&](size_t begin, size_t end)
+			{
+				for (size_t g = begin; g < end; g++)
+				{
+					GroupResult& result = results[g];
+					for (uint32_t i = groups[g].first; i < groups[g].first + groups[g].second; i++)
+					{
+						const Cluster& cluster = outDAG.clusters[members[i]];
+						result.indices.insert(result.indices.end(), outDAG.indices.begin() + cluster.firstIndex, outDAG.indices.begin() + cluster.firstIndex + size_t(cluster.triangleCount) * 3);
+					}
+
+					const uint32_t triangleCount = uint32_t(result.indices.size() / 3);
+					result.error = SimplifyGroup(mesh.vertices, result.indices, triangleCount / 2);
+					const uint32_t simplifiedCount = uint32_t(result.indices.size() / 3);
+					result.simplified = simplifiedCount > 0 && float(simplifiedCount) <= float(triangleCount) * (1.0f - settings.minReduction);
+					if (result.simplified)
+						SplitIntoClusters(mesh.vertices, result.indices, settings.maxClusterTriangles, result.ranges);
+				}
+			});
+
+			std::vector<uint32_t> next;
+			std::vector<glm::vec4> memberSpheres;
+			bool simplifiedAny = false;
+			for (size_t g = 0; g < groups.size(); g++)
+			{
+				const GroupResult& result = results[g];
+				if (!result.simplified)
+				{
+					for (uint32_t i = groups[g].first; i < groups[g].first + groups[g].second; i++)
+						next.push_back(members[i]);
+					continue;
+				}
+				simplifiedAny = true;
+
+				// Monotonic bounds: the group covers the spheres and errors of all its members
+				memberSpheres.clear();
+				float error = result.error;
+				for (uint32_t i = groups[g].first; i < groups[g].first + groups[g].second; i++)
+				{
+					const Cluster& member = outDAG.clusters[members[i]];
+					memberSpheres.push_back(member.lodBounds);
+					error = std::max(error, member.error);
+				}
+				const glm::vec4 lodBounds = MergeSpheres(memberSpheres);
+
+				const uint32_t group = outDAG.groupCount++;
+				for (uint32_t i = groups[g].first; i < groups[g].first + groups[g].second; i++)
+				{
+					Cluster& member = outDAG.clusters[members[i]];
+					member.group = group;
+					member.parentLodBounds = lodBounds;
+					member.parentError = error;
+				}
+
+				for (const auto& [first, count] : result.ranges)
+				{
+					next.push_back(uint32_t(outDAG.clusters.size()));
+					addCluster(&result.indices[size_t(first) * 3], count, level + 1, lodBounds, error);
+				}
+			}
+
+			if (!simplifiedAny)
+			{
+				if (groupSize >= current.size())
+					break;
+				groupSize *= 2;
+				continue;
+			}
+			groupSize = settings.groupSize;
+			current.swap(next);
+			level++;
+		}
+
+		outDAG.levelCount = level + 1;
+		outDAG.indices.shrink_to_fit();
+		outDAG.clusters.shrink_to_fit();
+
+		const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+		logger::info("Built cluster LOD DAG of %zu triangles in %.2f ms: %zu clusters in %u groups over %u levels.",
+			mesh.indices.size() / 3, seconds * 1000.0, outDAG.clusters.size(), outDAG.groupCount, outDAG.levelCount);
+		return true;
+	}
+
+	void ClusterLODSelector::Init(const ClusterDAG& dag)
+	{
+		const size_t count = dag.clusters.size();
+		for (std::vector<float>* stream : { &m_CentreX, &m_CentreY, &m_CentreZ, &m_Radius, &m_Error,
+			&m_ParentCentreX, &m_ParentCentreY, &m_ParentCentreZ, &m_ParentRadius, &m_ParentError })
+			stream->resize(count);
+		m_TriangleCounts.resize(count);
+
+		for (size_t c = 0; c < count; c++)
+		{
+			const Cluster& cluster = dag.clusters[c];
+			m_CentreX[c] = cluster.lodBounds.x;
+			m_CentreY[c] = cluster.lodBounds.y;
+			m_CentreZ[c] = cluster.lodBounds.z;
+			m_Radius[c] = cluster.lodBounds.w;
+			m_Error[c] = cluster.error;
+			m_ParentCentreX[c] = cluster.parentLodBounds.x;
+			m_ParentCentreY[c] = cluster.parentLodBounds.y;
+			m_ParentCentreZ[c] = cluster.parentLodBounds.z;
+			m_ParentRadius[c] = cluster.parentLodBounds.w;
+			m_ParentError[c] = cluster.parentError;
+			m_TriangleCounts[c] = cluster.triangleCount;
+		}
+	}
+
+	namespace
+	{
+		// Projected error in pixels of an object space error on a sphere, infinite when the viewer is inside it
+		inline float ProjectError(float error, float x, float y, float z, float radius, const glm::vec3& viewer, float projectionScale)
+		{
+			if (error == 0.0f)
+				return 0.0f;
+			const float dx = x - viewer.x, dy = y - viewer.y, dz = z - viewer.z;
+			const float distance = std::sqrt(dx * dx + dy * dy + dz * dz) - radius;
+			return distance > 0.0f ? error * projectionScale / distance : INFINITE_ERROR;
+		}
+
+		// Every error in a bucket is at most BucketThreshold of it. Bucket 0 holds exact clusters, the last one
+		// infinite errors, so each path from a source cluster to a root crosses any threshold exactly once
+		inline uint32_t ErrorBucket(float pixels)
+		{
+			if (!(pixels > 0.0f))
+				return 0;
+			if (pixels == INFINITE_ERROR)
+				return ClusterLODSelector::ERROR_BUCKETS;
+			const float bucket = std::ceil((std::log2(pixels) + 8.0f) * 4.0f);
+			return uint32_t(std::clamp(bucket, 1.0f, float(ClusterLODSelector::ERROR_BUCKETS - 1)));
+		}
+
+		inline float BucketThreshold(uint32_t bucket)
+		{
+			return bucket == 0 ? 0.0f : std::exp2(float(bucket) / 4.0f - 8.0f);
+		}
+	}
+
+	void ClusterLODSelector::SelectCut(const View& view, const glm::mat4* instances, uint32_t instanceCount, std::vector<Selection>& outSelection)
+	{
+		auto startTime = std::chrono::high_resolution_clock::now();
+		m_Stats = Stats();
+		outSelection.clear();
+
+		const size_t clusterCount = m_Error.size();
+		const size_t batchesPerInstance = (clusterCount + CLUSTER_BATCH - 1) / CLUSTER_BATCH;
+		const size_t batchCount = batchesPerInstance * instanceCount;
+		if (batchCount == 0)
+			return;
+
+		// The viewer moves into each instance's object space, where error over distance is the same as in world space
+		std::vector<glm::vec3> viewers(instanceCount);
+		for (uint32_t i = 0; i < instanceCount; i++)
+			viewers[i] = glm::vec3(glm::inverse(instances[i]) * glm::vec4(view.position, 1.0f));
+
+		auto forEachCluster = [&](size_t batch, auto&& function)
+		{
+			const uint32_t instance = uint32_t(batch / batchesPerInstance);
+			const size_t begin = (batch % batchesPerInstance) * CLUSTER_BATCH;
+			const size_t end = std::min(begin + CLUSTER_BATCH, clusterCount);
+			const glm::vec3& viewer = viewers[instance];
+			for (size_t c = begin; c < end; c++)
+			{
+				const uint32_t bucket = ErrorBucket(ProjectError(m_Error[c], m_CentreX[c], m_CentreY[c], m_CentreZ[c], m_Radius[c], viewer, view.projectionScale));
+				const uint32_t parentBucket = ErrorBucket(ProjectError(m_ParentError[c], m_ParentCentreX[c], m_ParentCentreY[c], m_ParentCentreZ[c], m_ParentRadius[c], viewer, view.projectionScale));
+				function(instance, uint32_t(c), bucket, parentBucket);
+			}
+		};
+
+		// Pass 1: triangles in the cut as a function of the threshold. A cluster joins at its own error and leaves at its parent's
+		const size_t rangeCount = std::max<size_t>(1, std::min(batchCount, threading::GetWorkerCount() * 4));
+		std::vector<std::array<int64_t, ERROR_BUCKETS + 1>> histograms(rangeCount);
+		threading::ParallelFor(rangeCount, 1, [&](size_t beginRange, size_t endRange)
+		{
+			for (size_t range = beginRange; range < endRange; range++)
+			{
+				std::array<int64_t, ERROR_BUCKETS + 1>& histogram = histograms[range];
+				histogram.fill(0);
+				for (size_t batch = batchCount * range / rangeCount; batch < batchCount * (range + 1) / rangeCount; batch++)
+				{
+					forEachCluster(batch, [&](uint32_t, uint32_t cluster, uint32_t bucket, uint32_t parentBucket)
+					{
+						histogram[bucket] += m_TriangleCounts[cluster];
+						histogram[parentBucket] -= m_TriangleCounts[cluster];
+					});
+				}
+			}
+		});
+
+		// Finest threshold at or above the target error that fits the budget, the coarsest cut otherwise
+		uint32_t threshold = ERROR_BUCKETS - 1;
+		int64_t triangles = 0;
+		m_Stats.overBudget = true;
+		for (uint32_t bucket = 0; bucket < ERROR_BUCKETS; bucket++)
+		{
+			for (const auto& histogram : histograms)
+				triangles += histogram[bucket];
+			if (BucketThreshold(bucket) >= view.pixelError && triangles <= int64_t(view.triangleBudget))
+			{
+				threshold = bucket;
+				m_Stats.overBudget = false;
+				break;
+			}
+		}
+
+		// Pass 2: emit the cut
+		std::vector<std::vector<Selection>> selections(rangeCount);
+		threading::ParallelFor(rangeCount, 1, [&](size_t beginRange, size_t endRange)
+		{
+			for (size_t range = beginRange; range < endRange; range++)
+			{
+				for (size_t batch = batchCount * range / rangeCount; batch < batchCount * (range + 1) / rangeCount; batch++)
+				{
+					forEachCluster(batch, [&](uint32_t instance, uint32_t cluster, uint32_t bucket, uint32_t parentBucket)
+					{
+						if (bucket <= threshold && parentBucket > threshold)
+							selections[range].push_back({ instance, cluster });
+					});
+				}
+			}
+		});
+
+		for (const auto& selection : selections)
+			outSelection.insert(outSelection.end(), selection.begin(), selection.end());
+
+		m_Stats.clustersTested = uint32_t(clusterCount * instanceCount);
+		m_Stats.clustersSelected = uint32_t(outSelection.size());
+		for (const Selection& selection : outSelection)
+			m_Stats.trianglesSelected += m_TriangleCounts[selection.cluster];
+		m_Stats.pixelError = BucketThreshold(threshold);
+		m_Stats.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		if (m_Stats.overBudget && !m_WasOverBudget)
+		{
+			logger::warning("ClusterLODSelector: even the coarsest cut of %u instances has %u triangles, over the budget of %u.",
+				instanceCount, m_Stats.trianglesSelected, view.triangleBudget);
+		}
+		m_WasOverBudget = m_Stats.overBudget;
+	}
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <engine/MeshOperations.h>
+
+namespace croissant
+{
+	struct ClusterLODSettings
+	{
+		uint32_t maxClusterTriangles = 128;
+		uint32_t groupSize = 8;				// Clusters simplified together
+		float    minReduction = 0.15f;		// Groups that simplify by less than this are regrouped with their neighbours
+		uint32_t maxLevels = 24;
+	};
+
+	struct Cluster
+	{
+		uint32_t  firstIndex;			// Into ClusterDAG::indices, which reference the source mesh vertices
+		uint32_t  triangleCount;
+		uint32_t  level;				// 0 for the source triangles
+		uint32_t  group;				// Group this cluster was simplified in, INVALID for roots
+		glm::vec4 bounds;				// Bounding sphere of the triangles, for culling
+		glm::vec4 lodBounds;			// Sphere the error is projected from, shared by the clusters of the group that produced it
+		float     error;				// Object space, 0 at level 0
+		glm::vec4 parentLodBounds;		// Sphere and error of the group it was simplified in
+		float     parentError;			// Infinite for roots
+	};
+
+	// Cluster hierarchy for continuous level of detail. Level 0 splits the mesh into clusters; every level then
+	// groups neighbouring clusters, simplifies each group with its outer boundary locked and splits the result
+	// into new clusters, so parents and children of a group share the same border. Errors and LOD spheres are made
+	// monotonic (a group's are at least those of its members), which lets a single projected error threshold pick a
+	// crack-free cut: draw a cluster when its own error is within the threshold and its parent's is not
+	struct ClusterDAG
+	{
+		std::vector<uint32_t> indices;
+		std::vector<Cluster> clusters;
+		uint32_t levelCount = 0;
+		uint32_t groupCount = 0;
+
+		static bool Build(const Mesh& mesh, const ClusterLODSettings& settings, ClusterDAG& outDAG);
+	};
+
+	// Picks a cut through a ClusterDAG per view. The cluster LOD data is kept as structure-of-arrays for two linear
+	// passes over every (instance, cluster) pair: the first builds a histogram of triangle counts over logarithmic
+	// error buckets, which gives the finest threshold that fits the budget, the second emits the clusters of that cut
+	class ClusterLODSelector
+	{
+	public:
+		static constexpr uint32_t ERROR_BUCKETS = 128;	// Four per octave from 2^-8 pixels
+		static constexpr uint32_t CLUSTER_BATCH = 4096;	// Clusters per parallel range
+
+		struct View
+		{
+			glm::vec3 position = glm::vec3(0.0f);
+			float     projectionScale = 1.0f;	// Pixels covered by one world unit at distance one, viewportHeight / (2 tan(fovY / 2))
+			float     pixelError = 1.0f;		// Target error; coarser cuts are only chosen to fit the budget
+			uint32_t  triangleBudget = 1 << 20;
+		};
+
+		struct Selection
+		{
+			uint32_t instance;
+			uint32_t cluster;
+		};
+
+		struct Stats
+		{
+			uint32_t clustersTested = 0;
+			uint32_t clustersSelected = 0;
+			uint32_t trianglesSelected = 0;
+			float    pixelError = 0.0f;			// Threshold of the chosen cut
+			bool     overBudget = false;		// No threshold fit the triangle budget, the coarsest cut was taken
+			double   seconds = 0.0;
+		};
+
+		void Init(const ClusterDAG& dag);
+
+		// Instance transforms may rotate, translate and scale uniformly
+		void SelectCut(const View& view, const glm::mat4* instances, uint32_t instanceCount, std::vector<Selection>& outSelection);
+
+		const Stats& GetLastStats() const { return m_Stats; }
+
+	private:
+		std::vector<float> m_CentreX, m_CentreY, m_CentreZ, m_Radius, m_Error;
+		std::vector<float> m_ParentCentreX, m_ParentCentreY, m_ParentCentreZ, m_ParentRadius, m_ParentError;
+		std::vector<uint32_t> m_TriangleCounts;
+		Stats m_Stats;
+		bool m_WasOverBudget = false;	// Over budget is logged when it starts, not every frame
+	};
+};
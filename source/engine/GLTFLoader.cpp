@@ -0,0 +1,597 @@
+#include <engine/GLTFLoader.h>
+#include <core/log.h>
+#include <charconv>
+
+namespace croissant
+{
+	namespace
+	{
+		constexpr uint32_t GLB_MAGIC		= 0x46546C67; // "glTF"
+		constexpr uint32_t GLB_CHUNK_JSON	= 0x4E4F534A; // "JSON"
+		constexpr uint32_t GLB_CHUNK_BIN	= 0x004E4942; // "BIN\0"
+
+		constexpr uint32_t COMPONENT_UNSIGNED_BYTE	= 5121;
+		constexpr uint32_t COMPONENT_UNSIGNED_SHORT	= 5123;
+		constexpr uint32_t COMPONENT_UNSIGNED_INT	= 5125;
+		constexpr uint32_t COMPONENT_FLOAT			= 5126;
+
+		constexpr uint32_t MODE_TRIANGLES = 4;
+
+		// Minimal JSON document model, just enough for the glTF header.
+		// Strings are views into the source text and escape sequences are kept verbatim.
+		struct JsonValue
+		{
+			enum class Type : uint8_t { Null, Bool, Number, String, Array, Object };
+
+			Type type = Type::Null;
+			double number = 0.0;
+			std::string_view string;
+			std::vector<std::string_view> keys;		// Object keys, parallel to elements
+			std::vector<JsonValue> elements;		// Array items or object values
+
+			const JsonValue* Find(std::string_view key) const
+			{
+				for (size_t i = 0; i < keys.size(); i++)
+				{
+					if (keys[i] == key)
+						return &elements[i];
+				}
+				return nullptr;
+			}
+
+			double GetNumber(std::string_view key, double fallback) const
+			{
+				const JsonValue* value = Find(key);
+				return (value && value->type == Type::Number) ? value->number : fallback;
+			}
+
+			const JsonValue* GetArray(std::string_view key) const
+			{
+				const JsonValue* value = Find(key);
+				return (value && value->type == Type::Array) ? value : nullptr;
+			}
+		};
+
+		class JsonParser
+		{
+		public:
+			JsonParser(std::string_view text) : m_Text(text) {}
+
+			bool Parse(JsonValue& out)
+			{
+				if (!ParseValue(out, 0))
+					return false;
+
+				SkipWhitespace();
+				return m_Pos == m_Text.size();
+			}
+
+		private:
+			static constexpr int MAX_DEPTH = 64;
+
+			std::string_view m_Text;
+			size_t m_Pos = 0;
+
+			void SkipWhitespace()
+			{
+				while (m_Pos < m_Text.size() && (m_Text[m_Pos] == ' ' || m_Text[m_Pos] == '\t' || m_Text[m_Pos] == '\n' || m_Text[m_Pos] == '\r'))
+					m_Pos++;
+			}
+
+			bool Consume(char c)
+			{
+				SkipWhitespace();
+				if (m_Pos < m_Text.size() && m_Text[m_Pos] == c)
+				{
+					m_Pos++;
+					return true;
+				}
+				return false;
+			}
+
+			bool ConsumeLiteral(std::string_view literal)
+			{
+				if (m_Text.substr(m_Pos, literal.size()) != literal)
+					return false;
+				m_Pos += literal.size();
+				return true;
+			}
+
+			bool ParseString(std::string_view& out)
+			{
+				if (!Consume('"'))
+					return false;
+
+				size_t start = m_Pos;
+				while (m_Pos < m_Text.size() && m_Text[m_Pos] != '"')
+				{
+					m_Pos += (m_Text[m_Pos] == '\\') ? 2 : 1;
+				}
+
+				if (m_Pos >= m_Text.size())
+					return false;
+
+				out = m_Text.substr(start, m_Pos - start);
+				m_Pos++;
+				return true;
+			}
+
+			bool ParseValue(JsonValue& out, int depth)
+			{
+				if (depth > MAX_DEPTH)
+					return false;
+
+				SkipWhitespace();
+				if (m_Pos >= m_Text.size())
+					return false;
+
+				switch (m_Text[m_Pos])
+				{
+				case '{':
+				{
+					m_Pos++;
+					out.type = JsonValue::Type::Object;
+					if (Consume('}'))
+						return true;
+					do
+					{
+						std::string_view key;
+						if (!ParseString(key) || !Consume(':'))
+							return false;
+						out.keys.push_back(key);
+						out.elements.emplace_back();
+						if (!ParseValue(out.elements.back(), depth + 1))
+							return false;
+					} while (Consume(','));
+					return Consume('}');
+				}
+				case '[':
+				{
+					m_Pos++;
+					out.type = JsonValue::Type::Array;
+					if (Consume(']'))
+						return true;
+					do
+					{
+						out.elements.emplace_back();
+						if (!ParseValue(out.elements.back(), depth + 1))
+							return false;
+					} while (Consume(','));
+					return Consume(']');
+				}
+				case '"':
+					out.type = JsonValue::Type::String;
+					return ParseString(out.string);
+				case 't':
+					out.type = JsonValue::Type::Bool;
+					out.number = 1.0;
+					return ConsumeLiteral("true");
+				case 'f':
+					out.type = JsonValue::Type::Bool;
+					return ConsumeLiteral("false");
+				case 'n':
+					return ConsumeLiteral("null");
+				default:
+				{
+					out.type = JsonValue::Type::Number;
+					auto [ptr, ec] = std::from_chars(m_Text.data() + m_Pos, m_Text.data() + m_Text.size(), out.number);
+					if (ec != std::errc())
+						return false;
+					m_Pos = ptr - m_Text.data();
+					return true;
+				}
+				}
+			}
+		};
+
+		// Resolved view of an accessor inside the BIN chunk
+		struct Accessor
+		{
+			const uint8_t* data = nullptr;
+			size_t count = 0;
+			size_t stride = 0;
+			uint32_t componentType = 0;
+			uint32_t components = 0;
+		};
+
+		uint32_t ComponentSize(uint32_t componentType)
+		{
+			switch (componentType)
+			{
+			case 5120: case COMPONENT_UNSIGNED_BYTE: return 1;
+			case 5122: case COMPONENT_UNSIGNED_SHORT: return 2;
+			case COMPONENT_UNSIGNED_INT: case COMPONENT_FLOAT: return 4;
+			default: return 0;
+			}
+		}
+
+		uint32_t ComponentCount(std::string_view type)
+		{
+			if (type == "SCALAR") return 1;
+			if (type == "VEC2") return 2;
+			if (type == "VEC3") return 3;
+			if (type == "VEC4") return 4;
+			return 0;
+		}
+
+		bool ResolveAccessor(const JsonValue& root, double accessorIndex, const uint8_t* bin, size_t binSize, Accessor& out)
+		{
+			const JsonValue* accessors = root.GetArray("accessors");
+			const JsonValue* bufferViews = root.GetArray("bufferViews");
+			if (!accessors || !bufferViews || accessorIndex < 0 || size_t(accessorIndex) >= accessors->elements.size())
+				return false;
+
+			const JsonValue& accessor = accessors->elements[size_t(accessorIndex)];
+			const JsonValue* type = accessor.Find("type");
+			double viewIndex = accessor.GetNumber("bufferView", -1.0);
+			if (accessor.Find("sparse") || !type || viewIndex < 0 || size_t(viewIndex) >= bufferViews->elements.size())
+				return false;
+
+			const JsonValue& view = bufferViews->elements[size_t(viewIndex)];
+			if (view.GetNumber("buffer", 0.0) != 0.0)
+				return false; // Only the embedded BIN chunk is supported
+
+			out.componentType = uint32_t(accessor.GetNumber("componentType", 0.0));
+			out.components = ComponentCount(type->string);
+			out.count = size_t(accessor.GetNumber("count", 0.0));
+
+			const size_t elementSize = size_t(ComponentSize(out.componentType)) * out.components;
+			const size_t viewOffset = size_t(view.GetNumber("byteOffset", 0.0));
+			const size_t viewLength = size_t(view.GetNumber("byteLength", 0.0));
+			const size_t accessorOffset = size_t(accessor.GetNumber("byteOffset", 0.0));
+			out.stride = size_t(view.GetNumber("byteStride", double(elementSize)));
+
+			if (elementSize == 0 || out.stride < elementSize || viewOffset + viewLength > binSize)
+				return false;
+
+			if (out.count > 0 && accessorOffset + (out.count - 1) * out.stride + elementSize > viewLength)
+				return false;
+
+			out.data = bin + viewOffset + accessorOffset;
+			return true;
+		}
+
+		// Reads a vec3 accessor and mirrors z for the left-handed convention
+		void CopyMirroredVec3(const Accessor& accessor, glm::vec3 Vertex::* member, Vertex* dst)
+		{
+			for (size_t i = 0; i < accessor.count; i++)
+			{
+				float v[3];
+				memcpy(v, accessor.data + i * accessor.stride, sizeof(v));
+				dst[i].*member = glm::vec3(v[0], v[1], -v[2]);
+			}
+		}
+
+		template <typename T>
+		void CopyNormalizedVec2(const Accessor& accessor, Vertex* dst)
+		{
+			constexpr float scale = 1.0f / float(std::numeric_limits<T>::max());
+			for (size_t i = 0; i < accessor.count; i++)
+			{
+				T v[2];
+				memcpy(v, accessor.data + i * accessor.stride, sizeof(v));
+				dst[i].uv = glm::vec2(float(v[0]) * scale, float(v[1]) * scale);
+			}
+		}
+
+		template <>
+		void CopyNormalizedVec2<float>(const Accessor& accessor, Vertex* dst)
+		{
+			for (size_t i = 0; i < accessor.count; i++)
+			{
+				memcpy(&dst[i].uv, accessor.data + i * accessor.stride, sizeof(glm::vec2));
+			}
+		}
+
+		// Widens indices to 32 bits, rebases them and flips the winding of each triangle in one pass.
+		// Tightly packed source indices keep this loop branch-free so it vectorises.
+		template <typename T>
+		void WidenIndices(const uint8_t* src, size_t triangleCount, uint32_t base, uint32_t* dst)
+		{
+			const T* in = reinterpret_cast<const T*>(src);
+			for (size_t t = 0; t < triangleCount; t++)
+			{
+				dst[t * 3 + 0] = base + uint32_t(in[t * 3 + 0]);
+				dst[t * 3 + 1] = base + uint32_t(in[t * 3 + 2]);
+				dst[t * 3 + 2] = base + uint32_t(in[t * 3 + 1]);
+			}
+		}
+
+		glm::mat4 GetNodeTransform(const JsonValue& node)
+		{
+			if (const JsonValue* matrix = node.GetArray("matrix"); matrix && matrix->elements.size() == 16)
+			{
+				// glTF matrices are column-major like glm
+				glm::mat4 m;
+				for (int c = 0; c < 4; c++)
+					for (int r = 0; r < 4; r++)
+						m[c][r] = float(matrix->elements[c * 4 + r].number);
+				return m;
+			}
+
+			glm::vec3 t(0.0f), s(1.0f);
+			glm::vec4 q(0.0f, 0.0f, 0.0f, 1.0f);
+			if (const JsonValue* translation = node.GetArray("translation"); translation && translation->elements.size() == 3)
+				t = glm::vec3(float(translation->elements[0].number), float(translation->elements[1].number), float(translation->elements[2].number));
+			if (const JsonValue* rotation = node.GetArray("rotation"); rotation && rotation->elements.size() == 4)
+				q = glm::vec4(float(rotation->elements[0].number), float(rotation->elements[1].number), float(rotation->elements[2].number), float(rotation->elements[3].number));
+			if (const JsonValue* scale = node.GetArray("scale"); scale && scale->elements.size() == 3)
+				s = glm::vec3(float(scale->elements[0].number), float(scale->elements[1].number), float(scale->elements[2].number));
+
+			// T * R * S with R from the (x, y, z, w) quaternion
+			const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+			const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+			const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+			return glm::mat4(
+				glm::vec4(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f) * s.x,
+				glm::vec4(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f) * s.y,
+				glm::vec4(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f) * s.z,
+				glm::vec4(t, 1.0f));
+		}
+
+		void CollectInstances(const JsonValue& nodes, size_t nodeIndex, const glm::mat4& parentTransform, std::vector<std::vector<glm::mat4>>& meshInstances, int depth)
+		{
+			if (nodeIndex >= nodes.elements.size() || depth > 64)
+				return;
+
+			const JsonValue& node = nodes.elements[nodeIndex];
+			glm::mat4 transform = parentTransform * GetNodeTransform(node);
+
+			double meshIndex = node.GetNumber("mesh", -1.0);
+			if (meshIndex >= 0 && size_t(meshIndex) < meshInstances.size())
+			{
+				meshInstances[size_t(meshIndex)].push_back(transform);
+			}
+
+			if (const JsonValue* children = node.GetArray("children"))
+			{
+				for (const JsonValue& child : children->elements)
+					CollectInstances(nodes, size_t(child.number), transform, meshInstances, depth + 1);
+			}
+		}
+
+		// Same as Assimp's MakeLeftHanded on node transforms: S * M * S with S = diag(1, 1, -1)
+		glm::mat4 MirrorZ(glm::mat4 m)
+		{
+			m[0][2] = -m[0][2];
+			m[1][2] = -m[1][2];
+			m[3][2] = -m[3][2];
+			m[2][0] = -m[2][0];
+			m[2][1] = -m[2][1];
+			m[2][3] = -m[2][3];
+			return m;
+		}
+
+		bool LoadMesh(const JsonValue& root, const JsonValue& gltfMesh, const uint8_t* bin, size_t binSize, Mesh* outMesh)
+		{
+			const JsonValue* primitives = gltfMesh.GetArray("primitives");
+			if (!primitives)
+				return false;
+
+			// Size the output up front so every primitive copies straight into its final place
+			size_t vertexCount = 0, indexCount = 0;
+			std::vector<Accessor> positions(primitives->elements.size()), normals(positions.size()), uvs(positions.size()), indices(positions.size());
+
+			for (size_t p = 0; p < primitives->elements.size(); p++)
+			{
+				const JsonValue& primitive = primitives->elements[p];
+				const JsonValue* attributes = primitive.Find("attributes");
+				if (!attributes || primitive.GetNumber("mode", MODE_TRIANGLES) != MODE_TRIANGLES || primitive.Find("targets"))
+					return false;
+
+				if (!ResolveAccessor(root, attributes->GetNumber("POSITION", -1.0), bin, binSize, positions[p]) ||
+					positions[p].componentType != COMPONENT_FLOAT || positions[p].components != 3)
+					return false;
+
+				if (attributes->Find("NORMAL") && (!ResolveAccessor(root, attributes->GetNumber("NORMAL", -1.0), bin, binSize, normals[p]) ||
+					normals[p].componentType != COMPONENT_FLOAT || normals[p].components != 3 || normals[p].count != positions[p].count))
+					return false;
+
+				if (attributes->Find("TEXCOORD_0") && (!ResolveAccessor(root, attributes->GetNumber("TEXCOORD_0", -1.0), bin, binSize, uvs[p]) ||
+					uvs[p].components != 2 || uvs[p].count != positions[p].count))
+					return false;
+
+				if (primitive.Find("indices"))
+				{
+					if (!ResolveAccessor(root, primitive.GetNumber("indices", -1.0), bin, binSize, indices[p]) ||
+						indices[p].components != 1 || indices[p].stride != ComponentSize(indices[p].componentType) || indices[p].count % 3 != 0)
+						return false;
+					indexCount += indices[p].count;
+				}
+				else
+				{
+					if (positions[p].count % 3 != 0)
+						return false;
+					indexCount += positions[p].count;
+				}
+
+				vertexCount += positions[p].count;
+			}
+
+			if (vertexCount > size_t(INVALID))
+				return false;
+
+			outMesh->vertices.resize(vertexCount, Vertex{ glm::vec3(0.0f), glm::vec2(0.0f), glm::vec3(0.0f) });
+			outMesh->indices.resize(indexCount);
+
+			size_t vertexBase = 0, indexBase = 0;
+			for (size_t p = 0; p < primitives->elements.size(); p++)
+			{
+				Vertex* dstVertices = outMesh->vertices.data() + vertexBase;
+				uint32_t* dstIndices = outMesh->indices.data() + indexBase;
+
+				CopyMirroredVec3(positions[p], &Vertex::position, dstVertices);
+
+				if (normals[p].data)
+					CopyMirroredVec3(normals[p], &Vertex::normal, dstVertices);
+
+				// Assimp flips V on glTF import and ConvertToLeftHanded flips it back, so UVs are taken as stored
+				if (uvs[p].data)
+				{
+					switch (uvs[p].componentType)
+					{
+					case COMPONENT_FLOAT:			CopyNormalizedVec2<float>(uvs[p], dstVertices); break;
+					case COMPONENT_UNSIGNED_BYTE:	CopyNormalizedVec2<uint8_t>(uvs[p], dstVertices); break;
+					case COMPONENT_UNSIGNED_SHORT:	CopyNormalizedVec2<uint16_t>(uvs[p], dstVertices); break;
+					default: return false;
+					}
+				}
+
+				const uint32_t base = uint32_t(vertexBase);
+				if (indices[p].data)
+				{
+					const size_t triangleCount = indices[p].count / 3;
+					switch (indices[p].componentType)
+					{
+					case COMPONENT_UNSIGNED_BYTE:	WidenIndices<uint8_t>(indices[p].data, triangleCount, base, dstIndices); break;
+					case COMPONENT_UNSIGNED_SHORT:	WidenIndices<uint16_t>(indices[p].data, triangleCount, base, dstIndices); break;
+					case COMPONENT_UNSIGNED_INT:	WidenIndices<uint32_t>(indices[p].data, triangleCount, base, dstIndices); break;
+					default: return false;
+					}
+
+					for (size_t i = 0; i < indices[p].count; i++)
+					{
+						if (dstIndices[i] >= base + positions[p].count)
+							return false;
+					}
+					indexBase += indices[p].count;
+				}
+				else
+				{
+					for (uint32_t t = 0; t < uint32_t(positions[p].count / 3); t++)
+					{
+						dstIndices[t * 3 + 0] = base + t * 3 + 0;
+						dstIndices[t * 3 + 1] = base + t * 3 + 2;
+						dstIndices[t * 3 + 2] = base + t * 3 + 1;
+					}
+					indexBase += positions[p].count;
+				}
+
+				vertexBase += positions[p].count;
+			}
+
+			if (!outMesh->vertices.empty())
+			{
+				outMesh->minBounds = outMesh->maxBounds = outMesh->vertices[0].position;
+				for (const Vertex& v : outMesh->vertices)
+				{
+					outMesh->minBounds = glm::min(outMesh->minBounds, v.position);
+					outMesh->maxBounds = glm::max(outMesh->maxBounds, v.position);
+				}
+			}
+
+			return true;
+		}
+	}
+
+	bool GLTFLoader::LoadGLB(vfs::IFileSystem& fs, const std::filesystem::path& path, std::vector<std::unique_ptr<Mesh>>& outMeshes)
+	{
+		std::shared_ptr<vfs::IBlob> blob = fs.mapFile(path);
+		if (vfs::IBlob::isEmpty(blob.get()))
+		{
+			logger::warning("GLTFLoader: cannot read %s", path.generic_string().c_str());
+			return false;
+		}
+
+		const uint8_t* file = static_cast<const uint8_t*>(blob->data());
+		const size_t fileSize = blob->size();
+
+		uint32_t header[3];
+		if (fileSize < sizeof(header) + 8)
+			return false;
+		memcpy(header, file, sizeof(header));
+		if (header[0] != GLB_MAGIC || header[1] != 2 || header[2] > fileSize)
+		{
+			logger::warning("GLTFLoader: %s is not a glTF 2.0 binary file", path.generic_string().c_str());
+			return false;
+		}
+
+		// Walk the chunks: JSON first, then an optional BIN chunk
+		std::string_view json;
+		const uint8_t* bin = nullptr;
+		size_t binSize = 0;
+		for (size_t offset = sizeof(header); offset + 8 <= header[2];)
+		{
+			uint32_t chunk[2];
+			memcpy(chunk, file + offset, sizeof(chunk));
+			offset += sizeof(chunk);
+			if (offset + chunk[0] > header[2])
+				return false;
+
+			if (chunk[1] == GLB_CHUNK_JSON && json.empty())
+				json = std::string_view(reinterpret_cast<const char*>(file + offset), chunk[0]);
+			else if (chunk[1] == GLB_CHUNK_BIN && !bin)
+			{
+				bin = file + offset;
+				binSize = chunk[0];
+			}
+
+			offset += (size_t(chunk[0]) + 3) & ~size_t(3);
+		}
+
+		JsonValue root;
+		if (json.empty() || !JsonParser(json).Parse(root))
+		{
+			logger::warning("GLTFLoader: malformed JSON chunk in %s", path.generic_string().c_str());
+			return false;
+		}
+
+		if (const JsonValue* buffers = root.GetArray("buffers"))
+		{
+			for (const JsonValue& buffer : buffers->elements)
+			{
+				if (buffer.Find("uri"))
+					return false; // External buffers go through Assimp
+			}
+		}
+
+		const JsonValue* meshes = root.GetArray("meshes");
+		if (!meshes || meshes->elements.empty())
+			return false;
+
+		// Instances come from the default scene; without a scene graph every mesh is placed once at the origin
+		std::vector<std::vector<glm::mat4>> meshInstances(meshes->elements.size());
+		const JsonValue* nodes = root.GetArray("nodes");
+		const JsonValue* scenes = root.GetArray("scenes");
+		if (nodes && scenes && !scenes->elements.empty())
+		{
+			size_t sceneIndex = size_t(root.GetNumber("scene", 0.0));
+			const JsonValue& scene = scenes->elements[std::min(sceneIndex, scenes->elements.size() - 1)];
+			if (const JsonValue* sceneNodes = scene.GetArray("nodes"))
+			{
+				for (const JsonValue& node : sceneNodes->elements)
+					CollectInstances(*nodes, size_t(node.number), glm::mat4(1.0f), meshInstances, 0);
+			}
+		}
+		else
+		{
+			for (auto& instances : meshInstances)
+				instances.push_back(glm::mat4(1.0f));
+		}
+
+		std::vector<std::unique_ptr<Mesh>> loadedMeshes;
+		for (size_t m = 0; m < meshes->elements.size(); m++)
+		{
+			if (meshInstances[m].empty())
+				continue;
+
+			std::unique_ptr<Mesh> mesh = std::make_unique<Mesh>();
+			if (!LoadMesh(root, meshes->elements[m], bin, binSize, mesh.get()))
+			{
+				logger::warning("GLTFLoader: mesh %zu in %s uses features outside the fast path", m, path.generic_string().c_str());
+				return false;
+			}
+
+			for (const glm::mat4& transform : meshInstances[m])
+				mesh->instanceTransforms.push_back(MirrorZ(transform));
+
+			loadedMeshes.push_back(std::move(mesh));
+		}
+
+		for (auto& mesh : loadedMeshes)
+			outMeshes.push_back(std::move(mesh));
+
+		return true;
+	}
+};
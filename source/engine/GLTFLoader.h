@@ -0,0 +1,20 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <core/VFS.h>
+#include <engine/MeshOperations.h>
+
+namespace croissant
+{
+	// Fast path for binary glTF 2.0 (.glb) files that bypasses Assimp.
+	// The file is mapped through the VFS and accessors are copied straight from the BIN chunk into Mesh arrays.
+	// The output matches ModelLoader's Assimp import: left-handed (z mirrored, winding flipped), one Mesh per glTF mesh
+	// with all its triangle primitives merged and one instance transform per referencing node.
+	class GLTFLoader
+	{
+	public:
+		// Returns false if the file is not a self-contained .glb this loader understands
+		// (external buffers, sparse or non-triangle primitives); callers should fall back to Assimp.
+		static bool LoadGLB(vfs::IFileSystem& fs, const std::filesystem::path& path, std::vector<std::unique_ptr<Mesh>>& outMeshes);
+	};
+};
@@ -2,47 +2,275 @@
 
 namespace croissant
 {
-	void Geometry::Init(DeviceManager* deviceManager, nvrhi::CommandListHandle commandList)
+	InstanceData InstanceData::FromTransform(const glm::mat4& transform)
 	{
-		nvrhi::VertexAttributeDesc attributes[] =
+		// The columns of the cofactor matrix are cross products of the columns, so it exists even for singular
+		// scales. It is the inverse transpose times the determinant, whose sign is undone for mirrored transforms
+		const glm::vec3 x = glm::vec3(transform[0]), y = glm::vec3(transform[1]), z = glm::vec3(transform[2]);
+		const float sign = glm::dot(x, glm::cross(y, z)) < 0.0f ? -1.0f : 1.0f;
+		return InstanceData{ transform, glm::mat3(glm::cross(y, z) * sign, glm::cross(z, x) * sign, glm::cross(x, y) * sign) };
+	}
+
+	void Geometry::Init(DeviceManager* deviceManager, nvrhi::CommandListHandle commandList, GeometryMegaBuffer* megaBuffer)
+	{
+		CreateResources(deviceManager, megaBuffer);
+
+		std::vector<BufferUpload> uploads;
+		GetInitialUploads(uploads);
+
+		commandList->open();
+		for (const BufferUpload& upload : uploads)
 		{
-			nvrhi::VertexAttributeDesc()
-				.setName("POSITION")
-				.setFormat(nvrhi::Format::RGB32_FLOAT)
-				.setOffset(0)
-				.setBufferIndex(0)
-				.setElementStride(sizeof(Vertex)),
+			//Write to buffer, with state tracking unless the buffer tracks its own state
+			if (upload.finalState != nvrhi::ResourceStates::Unknown)
+				commandList->beginTrackingBufferState(upload.buffer, nvrhi::ResourceStates::CopyDest);
+			commandList->writeBuffer(upload.buffer, upload.data, upload.size, upload.offset);
+			if (upload.finalState != nvrhi::ResourceStates::Unknown)
+				commandList->setPermanentBufferState(upload.buffer, upload.finalState);
+		}
+		commandList->close();
+		deviceManager->GetDevice()->executeCommandList(commandList);
 
-			 nvrhi::VertexAttributeDesc()
-				.setName("UV")
-				.setFormat(nvrhi::Format::RG32_FLOAT)
-				.setOffset(0)
-				.setBufferIndex(1)
-				.setElementStride(sizeof(Vertex)),
+		FinishUpload();
+	}
 
-			nvrhi::VertexAttributeDesc()
-				.setName("NORMAL")
-				.setFormat(nvrhi::Format::RGB32_FLOAT)
+	void Geometry::CreateResources(DeviceManager* deviceManager, GeometryMegaBuffer* megaBuffer)
+	{
+		// Skinning and dirty-range uploads write whole Vertex records, and the megabuffer holds a single vertex format
+		if (m_Streams == VertexStreams::SplitPosition && (m_Dynamic || !m_Mesh->skin.empty() || megaBuffer))
+		{
+			logger::warning("Split vertex streams are only supported for static geometry with owned buffers, using interleaved.");
+			m_Streams = VertexStreams::Interleaved;
+		}
+
+		std::vector<nvrhi::VertexAttributeDesc> attributes;
+		if (m_Streams == VertexStreams::SplitPosition)
+		{
+			const auto positions = PositionLayout::GetAttributeDescs(0);
+			const auto others = AttributeLayout::GetAttributeDescs(1);
+			attributes.insert(attributes.end(), positions.begin(), positions.end());
+			attributes.insert(attributes.end(), others.begin(), others.end());
+		}
+		else
+		{
+			const auto interleaved = InterleavedLayout::GetAttributeDescs(0);
+			attributes.insert(attributes.end(), interleaved.begin(), interleaved.end());
+		}
+
+		// Optional streams next to the vertex data. Megabuffer geometry draws with a base vertex that would offset
+		// them as well, so they are only used with owned buffers
+		const bool sideStreams = megaBuffer == nullptr;
+		if (!sideStreams && (!m_Mesh->tangentFrames.empty() || !m_Mesh->ambientOcclusion.empty()))
+			logger::warning("Tangent frames and baked AO are not supported with the geometry megabuffer, leaving them out.");
+
+		// Packed tangent frames
+		if (sideStreams && !m_Mesh->tangentFrames.empty())
+		{
+			attributes.push_back(nvrhi::VertexAttributeDesc()
+				.setName("QTANGENT")
+				.setFormat(nvrhi::Format::RGBA8_SNORM)
 				.setOffset(0)
 				.setBufferIndex(2)
-				.setElementStride(sizeof(Vertex)),
-		};
+				.setElementStride(sizeof(uint32_t)));
+		}
 
-		m_InputLayout = deviceManager->GetDevice()->createInputLayout(attributes, uint32_t(std::size(attributes)), nullptr);
+		// Baked ambient occlusion, one byte per vertex
+		if (sideStreams && !m_Mesh->ambientOcclusion.empty())
+		{
+			attributes.push_back(nvrhi::VertexAttributeDesc()
+				.setName("AO")
+				.setFormat(nvrhi::Format::R8_UNORM)
+				.setOffset(0)
+				.setBufferIndex(4)
+				.setElementStride(sizeof(uint8_t)));
+		}
 
-		commandList->open();
+		// Per-instance world transform, one column per semantic index TRANSFORM0..3, then the normal transform
+		const nvrhi::VertexAttributeDesc instanceAttribute = nvrhi::VertexAttributeDesc()
+			.setName("TRANSFORM")
+			.setFormat(nvrhi::Format::RGBA32_FLOAT)
+			.setArraySize(4)
+			.setOffset(offsetof(InstanceData, transform))
+			.setBufferIndex(3)
+			.setElementStride(sizeof(InstanceData))
+			.setIsInstanced(true);
+		attributes.push_back(instanceAttribute);
+		attributes.push_back(nvrhi::VertexAttributeDesc()
+			.setName("NORMAL_TRANSFORM")
+			.setFormat(nvrhi::Format::RGB32_FLOAT)
+			.setArraySize(3)
+			.setOffset(offsetof(InstanceData, normalTransform))
+			.setBufferIndex(3)
+			.setElementStride(sizeof(InstanceData))
+			.setIsInstanced(true));
+
+		m_DeviceManager = deviceManager;
+		m_InputLayout = deviceManager->GetDevice()->createInputLayout(attributes.data(), uint32_t(attributes.size()), nullptr);
+
+		// POSITION comes first in every layout
+		nvrhi::VertexAttributeDesc depthAttributes[] = { attributes[0], instanceAttribute };
+		m_DepthInputLayout = deviceManager->GetDevice()->createInputLayout(depthAttributes, uint32_t(std::size(depthAttributes)), nullptr);
+
+		const uint64_t vertexBytes = m_Mesh->vertices.size() * sizeof(Vertex);
+		const uint64_t indexBytes = m_Mesh->indices.size() * sizeof(uint32_t);
+		const uint64_t adjacencyBytes = m_Mesh->adjacencyIndices.size() * sizeof(uint32_t);
+		m_VertexCapacity = vertexBytes;
+		m_IndexCapacity = indexBytes;
+
+		if (megaBuffer)
+		{
+			m_VertexOffset = megaBuffer->AllocateVertices(vertexBytes, sizeof(Vertex));
+			m_IndexOffset = megaBuffer->AllocateIndices(indexBytes);
+			m_AdjacencyOffset = megaBuffer->AllocateIndices(adjacencyBytes);
+
+			if (m_VertexOffset != RangeAllocator::INVALID_OFFSET && m_IndexOffset != RangeAllocator::INVALID_OFFSET && m_AdjacencyOffset != RangeAllocator::INVALID_OFFSET)
+			{
+				m_MegaBuffer = megaBuffer;
+			}
+			else
+			{
+				logger::warning("Geometry does not fit the megabuffer, creating separate buffers.");
+				megaBuffer->FreeVertices(m_VertexOffset);
+				megaBuffer->FreeIndices(m_IndexOffset);
+				megaBuffer->FreeIndices(m_AdjacencyOffset);
+				m_VertexOffset = m_IndexOffset = m_AdjacencyOffset = 0;
+			}
+		}
+
+		if (m_MegaBuffer)
+		{
+			m_VertexBuffer = m_MegaBuffer->GetVertexBuffer();
+			m_IndexBuffer = m_MegaBuffer->GetIndexBuffer();
+			m_AdjacencyIB = m_MegaBuffer->GetIndexBuffer();
+			UpdateFirstElements();
+		}
+		else
+		{
+			CreateOwnedBuffers();
+		}
+
+		if (sideStreams && !m_Mesh->tangentFrames.empty())
+		{
+			nvrhi::BufferDesc tangentBufferDesc;
+			tangentBufferDesc.isVertexBuffer = true;
+			tangentBufferDesc.byteSize = m_Mesh->tangentFrames.size() * sizeof(uint32_t);
+			tangentBufferDesc.debugName = "TangentFrameBuffer";
+			tangentBufferDesc.initialState = nvrhi::ResourceStates::CopyDest;
+			m_TangentBuffer = deviceManager->GetDevice()->createBuffer(tangentBufferDesc);
+		}
+
+		if (sideStreams && !m_Mesh->ambientOcclusion.empty())
+		{
+			nvrhi::BufferDesc aoBufferDesc;
+			aoBufferDesc.isVertexBuffer = true;
+			aoBufferDesc.byteSize = m_Mesh->ambientOcclusion.size();
+			aoBufferDesc.debugName = "AmbientOcclusionBuffer";
+			aoBufferDesc.initialState = nvrhi::ResourceStates::CopyDest;
+			m_AmbientOcclusionBuffer = deviceManager->GetDevice()->createBuffer(aoBufferDesc);
+		}
+
+		// Neighbour faces for compute passes, one uint3 per face
+		if (!m_Mesh->faceNeighbours.empty())
+		{
+			nvrhi::BufferDesc neighbourBufferDesc;
+			neighbourBufferDesc.byteSize = m_Mesh->faceNeighbours.size() * sizeof(uint32_t);
+			neighbourBufferDesc.structStride = 3 * sizeof(uint32_t);
+			neighbourBufferDesc.debugName = "FaceNeighbourBuffer";
+			neighbourBufferDesc.initialState = nvrhi::ResourceStates::CopyDest;
+			m_FaceNeighbourBuffer = deviceManager->GetDevice()->createBuffer(neighbourBufferDesc);
+		}
+
+		// Crease and boundary lines, drawn with m_FirstVertex as the base vertex like the triangles
+		if (m_Mesh->featureEdges.topologyVersion != INVALID)
+		{
+			MeshOperations::GetFeatureEdgeLines(m_Mesh, m_FeatureEdgeLines);
+			m_CreaseLineCount = uint32_t(m_Mesh->featureEdges.creases.size());
+			m_BoundaryLineCount = uint32_t(m_Mesh->featureEdges.boundaries.size());
+		}
+		if (!m_FeatureEdgeLines.empty())
+		{
+			nvrhi::BufferDesc featureEdgeBufferDesc;
+			featureEdgeBufferDesc.isIndexBuffer = true;
+			featureEdgeBufferDesc.byteSize = m_FeatureEdgeLines.size() * sizeof(uint32_t);
+			featureEdgeBufferDesc.debugName = "FeatureEdgeIndexBuffer";
+			featureEdgeBufferDesc.initialState = nvrhi::ResourceStates::CopyDest;
+			m_FeatureEdgeIB = deviceManager->GetDevice()->createBuffer(featureEdgeBufferDesc);
+		}
+
+		// Triangle strips, drawn with m_FirstVertex as the base vertex like the list
+		if (!m_Mesh->stripIndices.empty())
+		{
+			nvrhi::BufferDesc stripBufferDesc;
+			stripBufferDesc.isIndexBuffer = true;
+			stripBufferDesc.byteSize = m_Mesh->stripIndices.size() * sizeof(uint32_t);
+			stripBufferDesc.debugName = "StripIndexBuffer";
+			stripBufferDesc.initialState = nvrhi::ResourceStates::CopyDest;
+			m_StripIB = deviceManager->GetDevice()->createBuffer(stripBufferDesc);
+			m_StripIndexCount = uint32_t(m_Mesh->stripIndices.size());
+		}
+
+		if (!m_Mesh->skin.empty())
+		{
+			m_Skinning = std::make_unique<SkinningEngine>(*m_Mesh);
 
+			nvrhi::BufferDesc uploadBufferDesc;
+			uploadBufferDesc.byteSize = vertexBytes;
+			uploadBufferDesc.debugName = "SkinningUploadBuffer";
+			uploadBufferDesc.cpuAccess = nvrhi::CpuAccessMode::Write;
+			uploadBufferDesc.enableAutomaticStateTracking(nvrhi::ResourceStates::CopySource);
+
+			m_SkinningUploadBuffers.resize(std::max(deviceManager->GetDeviceParams().maxFramesInFlight, 1u));
+			for (nvrhi::BufferHandle& uploadBuffer : m_SkinningUploadBuffers)
+				uploadBuffer = deviceManager->GetDevice()->createBuffer(uploadBufferDesc);
+		}
+
+		//Create instance buffer, a mesh not placed by the scene graph gets a single identity instance
+		m_InstanceCount = m_Mesh->instanceTransforms.empty() ? 1 : uint32_t(m_Mesh->instanceTransforms.size());
+
+		nvrhi::BufferDesc instanceBufferDesc;
+		instanceBufferDesc.isVertexBuffer = true;
+		instanceBufferDesc.byteSize = m_InstanceCount * sizeof(InstanceData);
+		instanceBufferDesc.debugName = "InstanceBuffer";
+		instanceBufferDesc.initialState = nvrhi::ResourceStates::CopyDest;
+		m_InstanceBuffer = deviceManager->GetDevice()->createBuffer(instanceBufferDesc);
+
+		m_InstanceData.clear();
+		if (m_Mesh->instanceTransforms.empty())
+			m_InstanceData.push_back(InstanceData::FromTransform(glm::mat4(1.0f)));
+		for (const glm::mat4& transform : m_Mesh->instanceTransforms)
+			m_InstanceData.push_back(InstanceData::FromTransform(transform));
+	}
+
+	void Geometry::CreateOwnedBuffers()
+	{
 		//Create vertex buffer
 		nvrhi::BufferDesc vertexBufferDesc;
 		vertexBufferDesc.isVertexBuffer = true;
 		vertexBufferDesc.byteSize = m_Mesh->vertices.size() * sizeof(Vertex);
 		vertexBufferDesc.debugName = "VertexBuffer";
 		vertexBufferDesc.initialState = nvrhi::ResourceStates::CopyDest;
-		m_VertexBuffer = deviceManager->GetDevice()->createBuffer(vertexBufferDesc);
 
-		commandList->beginTrackingBufferState(m_VertexBuffer, nvrhi::ResourceStates::CopyDest);
-		commandList->writeBuffer(m_VertexBuffer, m_Mesh->vertices.data(), m_Mesh->vertices.size() * sizeof(Vertex));
-		commandList->setPermanentBufferState(m_VertexBuffer, nvrhi::ResourceStates::VertexBuffer);
+		if (m_Streams == VertexStreams::SplitPosition)
+		{
+			m_PackedPositions = PositionLayout::Convert(*m_Mesh);
+			m_PackedAttributes = AttributeLayout::Convert(*m_Mesh);
+
+			nvrhi::BufferDesc attributeBufferDesc = vertexBufferDesc;
+			attributeBufferDesc.byteSize = m_PackedAttributes.size();
+			attributeBufferDesc.debugName = "AttributeBuffer";
+			m_AttributeBuffer = m_DeviceManager->GetDevice()->createBuffer(attributeBufferDesc);
+
+			vertexBufferDesc.byteSize = m_PackedPositions.size();
+			vertexBufferDesc.debugName = "PositionBuffer";
+		}
+
+		// Vertices that are rewritten after Init keep automatic state tracking so copies can target them
+		if (m_Dynamic || !m_Mesh->skin.empty())
+		{
+			vertexBufferDesc.debugName = m_Mesh->skin.empty() ? "DynamicVertexBuffer" : "SkinnedVertexBuffer";
+			vertexBufferDesc.enableAutomaticStateTracking(nvrhi::ResourceStates::VertexBuffer);
+		}
+		m_VertexBuffer = m_DeviceManager->GetDevice()->createBuffer(vertexBufferDesc);
 
 		//Create index buffer
 		nvrhi::BufferDesc indexBufferDesc;
@@ -50,13 +278,13 @@ namespace croissant
 		indexBufferDesc.byteSize = m_Mesh->indices.size() * sizeof(uint32_t);
 		indexBufferDesc.debugName = "IndexBuffer";
 		indexBufferDesc.initialState = nvrhi::ResourceStates::CopyDest;
-		m_IndexBuffer = deviceManager->GetDevice()->createBuffer(indexBufferDesc);
-
 
-		//Write to buffer, with state tracking
-		commandList->beginTrackingBufferState(m_IndexBuffer, nvrhi::ResourceStates::CopyDest);
-		commandList->writeBuffer(m_IndexBuffer, m_Mesh->indices.data(), m_Mesh->indices.size() * sizeof(uint32_t));
-		commandList->setPermanentBufferState(m_IndexBuffer, nvrhi::ResourceStates::IndexBuffer);
+		if (m_Dynamic)
+		{
+			indexBufferDesc.debugName = "DynamicIndexBuffer";
+			indexBufferDesc.enableAutomaticStateTracking(nvrhi::ResourceStates::IndexBuffer);
+		}
+		m_IndexBuffer = m_DeviceManager->GetDevice()->createBuffer(indexBufferDesc);
 
 		//Create adjacency index buffer
 		nvrhi::BufferDesc indexBufferDescAdj;
@@ -64,13 +292,212 @@ namespace croissant
 		indexBufferDescAdj.byteSize = m_Mesh->adjacencyIndices.size() * sizeof(uint32_t);
 		indexBufferDescAdj.debugName = "IndexBufferAdjacency";
 		indexBufferDescAdj.initialState = nvrhi::ResourceStates::CopyDest;
-		m_AdjacencyIB = deviceManager->GetDevice()->createBuffer(indexBufferDescAdj);
+		m_AdjacencyIB = m_DeviceManager->GetDevice()->createBuffer(indexBufferDescAdj);
+	}
 
-		//Write to buffer, with state tracking
-		commandList->beginTrackingBufferState(m_AdjacencyIB, nvrhi::ResourceStates::CopyDest);
-		commandList->writeBuffer(m_AdjacencyIB, m_Mesh->adjacencyIndices.data(), m_Mesh->adjacencyIndices.size() * sizeof(uint32_t));
-		commandList->setPermanentBufferState(m_AdjacencyIB, nvrhi::ResourceStates::IndexBuffer);
-		commandList->close();
-		deviceManager->GetDevice()->executeCommandList(commandList);
+	void Geometry::GetInitialUploads(std::vector<BufferUpload>& uploads) const
+	{
+		// Shared megabuffer ranges and dynamic buffers track their own state, the rest become permanent after the upload
+		const bool ownedStatic = m_MegaBuffer == nullptr && !m_Dynamic;
+		const nvrhi::ResourceStates vertexState = ownedStatic && m_Mesh->skin.empty() ? nvrhi::ResourceStates::VertexBuffer : nvrhi::ResourceStates::Unknown;
+		const nvrhi::ResourceStates indexState = ownedStatic ? nvrhi::ResourceStates::IndexBuffer : nvrhi::ResourceStates::Unknown;
+		const nvrhi::ResourceStates adjacencyState = m_MegaBuffer ? nvrhi::ResourceStates::Unknown : nvrhi::ResourceStates::IndexBuffer;
+
+		if (m_Streams == VertexStreams::SplitPosition)
+		{
+			uploads.push_back({ m_VertexBuffer, 0, m_PackedPositions.data(), m_PackedPositions.size(), vertexState });
+			uploads.push_back({ m_AttributeBuffer, 0, m_PackedAttributes.data(), m_PackedAttributes.size(), vertexState });
+		}
+		else
+		{
+			uploads.push_back({ m_VertexBuffer, m_VertexOffset, m_Mesh->vertices.data(), m_Mesh->vertices.size() * sizeof(Vertex), vertexState });
+		}
+		uploads.push_back({ m_IndexBuffer, m_IndexOffset, m_Mesh->indices.data(), m_Mesh->indices.size() * sizeof(uint32_t), indexState });
+		uploads.push_back({ m_AdjacencyIB, m_AdjacencyOffset, m_Mesh->adjacencyIndices.data(), m_Mesh->adjacencyIndices.size() * sizeof(uint32_t), adjacencyState });
+
+		if (m_TangentBuffer)
+			uploads.push_back({ m_TangentBuffer, 0, m_Mesh->tangentFrames.data(), m_Mesh->tangentFrames.size() * sizeof(uint32_t), nvrhi::ResourceStates::VertexBuffer });
+
+		if (m_AmbientOcclusionBuffer)
+			uploads.push_back({ m_AmbientOcclusionBuffer, 0, m_Mesh->ambientOcclusion.data(), m_Mesh->ambientOcclusion.size(), nvrhi::ResourceStates::VertexBuffer });
+
+		if (m_FaceNeighbourBuffer)
+			uploads.push_back({ m_FaceNeighbourBuffer, 0, m_Mesh->faceNeighbours.data(), m_Mesh->faceNeighbours.size() * sizeof(uint32_t), nvrhi::ResourceStates::ShaderResource });
+
+		if (m_FeatureEdgeIB)
+			uploads.push_back({ m_FeatureEdgeIB, 0, m_FeatureEdgeLines.data(), m_FeatureEdgeLines.size() * sizeof(uint32_t), nvrhi::ResourceStates::IndexBuffer });
+
+		if (m_StripIB)
+			uploads.push_back({ m_StripIB, 0, m_Mesh->stripIndices.data(), m_Mesh->stripIndices.size() * sizeof(uint32_t), nvrhi::ResourceStates::IndexBuffer });
+
+		uploads.push_back({ m_InstanceBuffer, 0, m_InstanceData.data(), m_InstanceData.size() * sizeof(InstanceData), nvrhi::ResourceStates::VertexBuffer });
+	}
+
+	void Geometry::FinishUpload()
+	{
+		if (m_Streams == VertexStreams::SplitPosition)
+		{
+			logger::info("Depth pass vertex fetch: %.2f MB split, %.2f MB interleaved.",
+				GetVertexFetchBytes(GeometryPass::DepthOnly) / 1048576.0, m_Mesh->vertices.size() * sizeof(Vertex) / 1048576.0);
+		}
+		std::vector<uint8_t>().swap(m_PackedPositions);
+		std::vector<uint8_t>().swap(m_PackedAttributes);
+		std::vector<uint32_t>().swap(m_FeatureEdgeLines);
+		std::vector<InstanceData>().swap(m_InstanceData);
+
+		if (m_Dynamic)
+		{
+			m_UploadRing.Init(m_DeviceManager->GetDevice(), m_StagingSegmentSize, std::max(m_DeviceManager->GetDeviceParams().maxFramesInFlight, 1u));
+		}
+	}
+
+	uint32_t Geometry::GetVertexBufferBindings(GeometryPass pass, nvrhi::VertexBufferBinding* bindings) const
+	{
+		uint32_t count = 0;
+		bindings[count++] = nvrhi::VertexBufferBinding().setBuffer(m_VertexBuffer).setSlot(0).setOffset(0);
+
+		if (pass == GeometryPass::Forward && m_Streams == VertexStreams::SplitPosition)
+			bindings[count++] = nvrhi::VertexBufferBinding().setBuffer(m_AttributeBuffer).setSlot(1).setOffset(0);
+
+		if (pass == GeometryPass::Forward && m_TangentBuffer)
+			bindings[count++] = nvrhi::VertexBufferBinding().setBuffer(m_TangentBuffer).setSlot(2).setOffset(0);
+
+		bindings[count++] = nvrhi::VertexBufferBinding().setBuffer(m_InstanceBuffer).setSlot(3).setOffset(0);
+
+		if (pass == GeometryPass::Forward && m_AmbientOcclusionBuffer)
+			bindings[count++] = nvrhi::VertexBufferBinding().setBuffer(m_AmbientOcclusionBuffer).setSlot(4).setOffset(0);
+		return count;
+	}
+
+	uint64_t Geometry::GetVertexFetchBytes(GeometryPass pass) const
+	{
+		const uint64_t vertexCount = m_Mesh->vertices.size();
+		if (pass == GeometryPass::DepthOnly)
+			return vertexCount * (m_Streams == VertexStreams::Interleaved ? InterleavedLayout::Stride : PositionLayout::Stride);
+
+		uint64_t stride = m_Streams == VertexStreams::Interleaved ? InterleavedLayout::Stride : PositionLayout::Stride + AttributeLayout::Stride;
+		if (m_TangentBuffer)
+			stride += sizeof(uint32_t);
+		if (m_AmbientOcclusionBuffer)
+			stride += sizeof(uint8_t);
+		return vertexCount * stride;
+	}
+
+	void Geometry::UpdateFirstElements()
+	{
+		m_FirstVertex = uint32_t(m_VertexOffset / sizeof(Vertex));
+		m_FirstIndex = uint32_t(m_IndexOffset / sizeof(uint32_t));
+		m_FirstAdjacencyIndex = uint32_t(m_AdjacencyOffset / sizeof(uint32_t));
+	}
+
+	void Geometry::UploadDirtyRanges(nvrhi::ICommandList* commandList, DirtyRanges& ranges, nvrhi::BufferHandle& buffer, uint64_t& offset, uint64_t& capacity,
+		const void* data, size_t elementCount, size_t elementSize, bool vertices)
+	{
+		if (ranges.Empty())
+			return;
+
+		// An array that outgrew its allocation is reallocated and uploaded in full
+		const uint64_t byteSize = uint64_t(elementCount) * elementSize;
+		if (byteSize > capacity)
+		{
+			if (m_MegaBuffer)
+			{
+				// The old range is kept until the new one exists, so a full megabuffer leaves the mesh at its previous size
+				const uint64_t newOffset = vertices ? m_MegaBuffer->AllocateVertices(byteSize, elementSize) : m_MegaBuffer->AllocateIndices(byteSize);
+				if (newOffset == RangeAllocator::INVALID_OFFSET)
+				{
+					ranges.Clear();
+					return;
+				}
+
+				if (vertices)
+					m_MegaBuffer->FreeVertices(offset);
+				else
+					m_MegaBuffer->FreeIndices(offset);
+				offset = newOffset;
+			}
+			else
+			{
+				nvrhi::BufferDesc desc = buffer->getDesc();
+				desc.byteSize = byteSize;
+				buffer = m_DeviceManager->GetDevice()->createBuffer(desc);
+			}
+
+			capacity = byteSize;
+			commandList->writeBuffer(buffer, data, byteSize, offset);
+			m_UploadStats.bytesReallocated += byteSize;
+			m_UploadStats.reallocations++;
+			ranges.Clear();
+			return;
+		}
+
+		ranges.Coalesce(uint32_t(std::max<size_t>(COALESCE_GAP_BYTES / elementSize, 1)));
+		for (const DirtyRanges::Range& range : ranges.GetRanges())
+		{
+			const size_t end = std::min<size_t>(range.end, elementCount);
+			if (range.begin < end)
+			{
+				m_UploadRing.Upload(commandList, buffer, offset + uint64_t(range.begin) * elementSize,
+					static_cast<const uint8_t*>(data) + size_t(range.begin) * elementSize, uint64_t(end - range.begin) * elementSize);
+			}
+		}
+		ranges.Clear();
+	}
+
+	void Geometry::Update(nvrhi::ICommandList* commandList, Mesh& mesh)
+	{
+		if (!m_Dynamic || !m_UploadRing.IsInitialized())
+			return;
+		if (&mesh != m_Mesh)
+		{
+			logger::warning("Geometry::Update called with a mesh other than its own.");
+			return;
+		}
+
+		m_UploadStats = UploadStats();
+		m_UploadRing.BeginFrame(m_DeviceManager->GetFrameIndex());
+		const UploadRing::FrameStats ringBefore = m_UploadRing.GetFrameStats();	// Earlier updates of this frame
+		UploadDirtyRanges(commandList, mesh.dirtyVertices, m_VertexBuffer, m_VertexOffset, m_VertexCapacity,
+			mesh.vertices.data(), mesh.vertices.size(), sizeof(Vertex), true);
+		UploadDirtyRanges(commandList, mesh.dirtyIndices, m_IndexBuffer, m_IndexOffset, m_IndexCapacity,
+			mesh.indices.data(), mesh.indices.size(), sizeof(uint32_t), false);
+		UpdateFirstElements();
+
+		const UploadRing::FrameStats& ring = m_UploadRing.GetFrameStats();
+		m_UploadStats.bytesStaged = ring.bytesStaged - ringBefore.bytesStaged;
+		m_UploadStats.bytesOverflowed = ring.bytesOverflowed - ringBefore.bytesOverflowed;
+		m_UploadStats.copies = ring.copies - ringBefore.copies;
+
+		// Steady-state frames only stage through the ring, the slow paths are worth seeing
+		if (m_UploadStats.reallocations > 0 || m_UploadStats.bytesOverflowed > 0)
+		{
+			logger::info("Geometry update: %.2f MB staged in %u copies, %.2f MB past the ring segment, %.2f MB in %u reallocations.",
+				m_UploadStats.bytesStaged / 1048576.0, m_UploadStats.copies, m_UploadStats.bytesOverflowed / 1048576.0,
+				m_UploadStats.bytesReallocated / 1048576.0, m_UploadStats.reallocations);
+		}
+	}
+
+	void Geometry::UpdateSkinning(nvrhi::ICommandList* commandList)
+	{
+		if (!m_Skinning || !m_Skinning->IsDirty())
+			return;
+
+		// The upload buffer of this frame slot is no longer read by the GPU once the frame is allowed to start
+		nvrhi::IBuffer* uploadBuffer = m_SkinningUploadBuffers[m_DeviceManager->GetFrameIndex() % m_SkinningUploadBuffers.size()];
+		Vertex* mapped = static_cast<Vertex*>(m_DeviceManager->GetDevice()->mapBuffer(uploadBuffer, nvrhi::CpuAccessMode::Write));
+		if (!mapped)
+		{
+			logger::warning("Failed to map the skinning upload buffer.");
+			return;
+		}
+
+		m_Skinning->Skin(mapped, m_SkinnedRanges);
+		m_DeviceManager->GetDevice()->unmapBuffer(uploadBuffer);
+
+		for (const SkinningEngine::VertexRange& range : m_SkinnedRanges)
+		{
+			const uint64_t offset = uint64_t(range.begin) * sizeof(Vertex);
+			commandList->copyBuffer(m_VertexBuffer, m_VertexOffset + offset, uploadBuffer, offset, uint64_t(range.end - range.begin) * sizeof(Vertex));
+		}
 	}
 };
\ No newline at end of file
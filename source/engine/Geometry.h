@@ -1,32 +1,159 @@
 #pragma once
 
 #include <engine/ModelLoader.h>
+#include <engine/Skinning.h>
+#include <engine/UploadRing.h>
+#include <engine/GeometryMegaBuffer.h>
+#include <engine/GeometryUploader.h>
+#include <engine/VertexLayout.h>
 #include <render/backend/DeviceManager.h>
 #include <core/VFS.h>
 
 namespace croissant
 {
+	// How vertex data is laid out in the GPU buffers
+	enum class VertexStreams
+	{
+		Interleaved,	// One stream of Vertex
+		SplitPosition,	// PositionLayout in m_VertexBuffer, AttributeLayout in m_AttributeBuffer
+	};
+
+	// Passes with their own input layout and vertex buffer bindings
+	enum class GeometryPass
+	{
+		Forward,
+		DepthOnly,		// Positions and instance transforms only, for depth prepasses and shadow maps
+	};
+
+	// Per-instance data in vertex slot 3
+	struct InstanceData
+	{
+		glm::mat4 transform;		// TRANSFORM0..3, object to world
+		glm::mat3 normalTransform;	// NORMAL_TRANSFORM0..2, cofactor of the upper 3x3 so non-uniform scale keeps normals perpendicular
+
+		static InstanceData FromTransform(const glm::mat4& transform);
+	};
+
 	class Geometry
 	{
 	public:
-		Geometry(const Mesh* mesh): m_Mesh(mesh) {};
+		// Dynamic geometry keeps its buffers updatable and uploads the Mesh's dirty ranges in Update
+		Geometry(const Mesh* mesh, bool dynamic = false): m_Mesh(mesh), m_Dynamic(dynamic) {};
 		~Geometry()
 		{
 			if (m_VertexBuffer)
 				m_VertexBuffer = nullptr;
 			if (m_IndexBuffer)
 				m_IndexBuffer = nullptr;
+			if (m_InstanceBuffer)
+				m_InstanceBuffer = nullptr;
+			if (m_MegaBuffer)
+			{
+				m_MegaBuffer->FreeVertices(m_VertexOffset);
+				m_MegaBuffer->FreeIndices(m_IndexOffset);
+				m_MegaBuffer->FreeIndices(m_AdjacencyOffset);
+			}
 		}
 
-		void Init(DeviceManager* deviceManager, nvrhi::CommandListHandle commandList);
+		// With a megaBuffer the vertex, index and adjacency data are sub-allocated from it and m_VertexBuffer,
+		// m_IndexBuffer and m_AdjacencyIB all point at the shared buffers. Draw with m_FirstIndex / m_FirstAdjacencyIndex
+		// as the start index and m_FirstVertex as the base vertex. Falls back to owned buffers when the megabuffer is full
+		void Init(DeviceManager* deviceManager, nvrhi::CommandListHandle commandList, GeometryMegaBuffer* megaBuffer = nullptr);
+
+		// Init split in three for GeometryUploader, which batches the uploads of many geometries:
+		// create the buffers, list the data they need, then finish once the uploads are recorded
+		void CreateResources(DeviceManager* deviceManager, GeometryMegaBuffer* megaBuffer = nullptr);
+		void GetInitialUploads(std::vector<BufferUpload>& uploads) const;
+		void FinishUpload();
+
+		// Skinned meshes only: re-skins the dirty vertices on the CPU into this frame's upload buffer and records
+		// copies of the written ranges into m_VertexBuffer. Call with an open command list after posing m_Skinning.
+		void UpdateSkinning(nvrhi::ICommandList* commandList);
+
+		// Dynamic meshes only: uploads the coalesced dirty vertex and index ranges of mesh, which must be m_Mesh, through
+		// the staging ring and clears them. Ranges marked before Init are uploaded again by the first call.
+		// Call once per frame with an open command list
+		void Update(nvrhi::ICommandList* commandList, Mesh& mesh);
+
+		nvrhi::IInputLayout* GetInputLayout(GeometryPass pass) const { return pass == GeometryPass::DepthOnly ? m_DepthInputLayout : m_InputLayout; }
+
+		// Fills the vertex buffer bindings of a pass, at most 5, and returns how many were written.
+		// Offsets are relative to the buffers; megabuffer geometry draws with m_FirstVertex as the base vertex
+		uint32_t GetVertexBufferBindings(GeometryPass pass, nvrhi::VertexBufferBinding* bindings) const;
+
+		// Bytes of vertex data a pass fetches when every vertex is read once
+		uint64_t GetVertexFetchBytes(GeometryPass pass) const;
+
+		struct UploadStats
+		{
+			uint64_t bytesStaged = 0;		// Dirty ranges copied through the ring
+			uint64_t bytesOverflowed = 0;	// Dirty ranges that did not fit the ring segment, written with writeBuffer
+			uint64_t bytesReallocated = 0;	// Arrays that outgrew their allocation, written in full with writeBuffer
+			uint32_t copies = 0;
+			uint32_t reallocations = 0;
+
+			uint64_t GetTotalBytes() const { return bytesStaged + bytesOverflowed + bytesReallocated; }
+		};
+
+		// Uploads of the last Update
+		const UploadStats& GetUploadStats() const { return m_UploadStats; }
 
 		nvrhi::InputLayoutHandle m_InputLayout;
+		nvrhi::InputLayoutHandle m_DepthInputLayout;
 
 		nvrhi::BufferHandle m_ConstantBuffer;
 		nvrhi::BufferHandle m_VertexBuffer;
+		nvrhi::BufferHandle m_AttributeBuffer;	// VertexStreams::SplitPosition only
+		nvrhi::BufferHandle m_TangentBuffer;	// Packed tangent frames in slot 2, only when the Mesh has tangentFrames
+		nvrhi::BufferHandle m_AmbientOcclusionBuffer;	// R8_UNORM in slot 4, only when the Mesh has ambientOcclusion
 		nvrhi::BufferHandle m_IndexBuffer;
 		nvrhi::BufferHandle m_AdjacencyIB;
+		nvrhi::BufferHandle m_FaceNeighbourBuffer;	// Structured uint3 per face, only when the Mesh has faceNeighbours
+		nvrhi::BufferHandle m_FeatureEdgeIB;		// Line list of the Mesh's featureEdges, creases first, only when they were built
+		nvrhi::BufferHandle m_StripIB;				// The Mesh's stripIndices for PrimitiveType::TriangleStrip, only when it has them
+		nvrhi::BufferHandle m_InstanceBuffer;	// One InstanceData per instance, bound to vertex slot 3
+
+		uint32_t m_InstanceCount = 1;
+		uint32_t m_CreaseLineCount = 0;		// Lines in m_FeatureEdgeIB, boundaries start after the creases
+		uint32_t m_BoundaryLineCount = 0;
+		uint32_t m_StripIndexCount = 0;		// Indices in m_StripIB, restart indices included
+
+		GeometryMegaBuffer* m_MegaBuffer = nullptr;	// Null when the buffers above are owned
+		uint64_t m_VertexOffset = 0;				// Byte offsets of this mesh in the buffers, 0 when owned
+		uint64_t m_IndexOffset = 0;
+		uint64_t m_AdjacencyOffset = 0;
+		uint64_t m_VertexCapacity = 0;				// Bytes reserved for this mesh, grows with dynamic meshes
+		uint64_t m_IndexCapacity = 0;
+		uint32_t m_FirstVertex = 0;
+		uint32_t m_FirstIndex = 0;
+		uint32_t m_FirstAdjacencyIndex = 0;
+
+		std::unique_ptr<SkinningEngine> m_Skinning;					// Null for static meshes
+		std::vector<nvrhi::BufferHandle> m_SkinningUploadBuffers;	// CPU-writable, one per frame in flight
+		std::vector<SkinningEngine::VertexRange> m_SkinnedRanges;
 
 		const Mesh* m_Mesh;
+		DeviceManager* m_DeviceManager = nullptr;
+
+		bool m_Dynamic = false;
+		VertexStreams m_Streams = VertexStreams::Interleaved;	// Set before Init. Dynamic, skinned and megabuffer geometry stays interleaved
+		uint64_t m_StagingSegmentSize = 4 << 20;	// Per frame in flight, set before Init
+		UploadRing m_UploadRing;
+
+	private:
+		UploadStats m_UploadStats;
+
+		static constexpr size_t COALESCE_GAP_BYTES = 4096; // Ranges closer than this are uploaded as one copy
+
+		void UploadDirtyRanges(nvrhi::ICommandList* commandList, DirtyRanges& ranges, nvrhi::BufferHandle& buffer, uint64_t& offset, uint64_t& capacity,
+			const void* data, size_t elementCount, size_t elementSize, bool vertices);
+		void CreateOwnedBuffers();
+		void UpdateFirstElements();
+
+		// Data staged for the initial upload, released by FinishUpload
+		std::vector<uint8_t> m_PackedPositions;
+		std::vector<uint8_t> m_PackedAttributes;
+		std::vector<uint32_t> m_FeatureEdgeLines;
+		std::vector<InstanceData> m_InstanceData;
 	};
 };
\ No newline at end of file
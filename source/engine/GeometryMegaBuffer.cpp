@@ -0,0 +1,58 @@
+#include <engine/GeometryMegaBuffer.h>
+#include <core/log.h>
+
+namespace croissant
+{
+	bool GeometryMegaBuffer::Init(nvrhi::IDevice* device, uint64_t vertexBytes, uint64_t indexBytes)
+	{
+		// Shared by many meshes that are written at different times, so both keep automatic state tracking
+		nvrhi::BufferDesc vertexBufferDesc;
+		vertexBufferDesc.isVertexBuffer = true;
+		vertexBufferDesc.byteSize = vertexBytes;
+		vertexBufferDesc.debugName = "MegaVertexBuffer";
+		vertexBufferDesc.enableAutomaticStateTracking(nvrhi::ResourceStates::VertexBuffer);
+		m_VertexBuffer = device->createBuffer(vertexBufferDesc);
+
+		nvrhi::BufferDesc indexBufferDesc;
+		indexBufferDesc.isIndexBuffer = true;
+		indexBufferDesc.byteSize = indexBytes;
+		indexBufferDesc.debugName = "MegaIndexBuffer";
+		indexBufferDesc.enableAutomaticStateTracking(nvrhi::ResourceStates::IndexBuffer);
+		m_IndexBuffer = device->createBuffer(indexBufferDesc);
+
+		if (!m_VertexBuffer || !m_IndexBuffer)
+		{
+			logger::warning("Failed to create the geometry megabuffer.");
+			return false;
+		}
+
+		m_VertexAllocator.Reset(vertexBytes);
+		m_IndexAllocator.Reset(indexBytes);
+		return true;
+	}
+
+	uint64_t GeometryMegaBuffer::AllocateVertices(uint64_t bytes, uint64_t stride)
+	{
+		// Empty arrays still get a unique offset so every Geometry frees what it allocated
+		uint64_t offset = m_VertexAllocator.Allocate(std::max(bytes, stride), stride);
+		if (offset == RangeAllocator::INVALID_OFFSET)
+		{
+			RangeAllocator::Stats stats = m_VertexAllocator.GetStats();
+			logger::warning("Megabuffer out of vertex space: %llu bytes requested, largest free block %llu (fragmentation %.2f).",
+				(unsigned long long)bytes, (unsigned long long)stats.largestFreeBlock, stats.GetFragmentation());
+		}
+		return offset;
+	}
+
+	uint64_t GeometryMegaBuffer::AllocateIndices(uint64_t bytes)
+	{
+		uint64_t offset = m_IndexAllocator.Allocate(std::max<uint64_t>(bytes, sizeof(uint32_t)), sizeof(uint32_t));
+		if (offset == RangeAllocator::INVALID_OFFSET)
+		{
+			RangeAllocator::Stats stats = m_IndexAllocator.GetStats();
+			logger::warning("Megabuffer out of index space: %llu bytes requested, largest free block %llu (fragmentation %.2f).",
+				(unsigned long long)bytes, (unsigned long long)stats.largestFreeBlock, stats.GetFragmentation());
+		}
+		return offset;
+	}
+};
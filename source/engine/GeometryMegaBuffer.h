@@ -0,0 +1,36 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <nvrhi/nvrhi.h>
+#include <engine/RangeAllocator.h>
+
+namespace croissant
+{
+	// One large vertex buffer and one index buffer shared by every Geometry initialised with it.
+	// Geometry records its byte offsets instead of owning buffers, so draws across meshes keep the same bindings.
+	// There is a single vertex layout (Vertex) and index format (R32_UINT) in the engine, hence one buffer of each.
+	class GeometryMegaBuffer
+	{
+	public:
+		bool Init(nvrhi::IDevice* device, uint64_t vertexBytes, uint64_t indexBytes);
+
+		// Returns RangeAllocator::INVALID_OFFSET when the buffer is full.
+		// Vertex offsets are aligned to the vertex stride so they can be used as a base vertex
+		uint64_t AllocateVertices(uint64_t bytes, uint64_t stride);
+		uint64_t AllocateIndices(uint64_t bytes);
+		void FreeVertices(uint64_t offset) { m_VertexAllocator.Free(offset); }
+		void FreeIndices(uint64_t offset) { m_IndexAllocator.Free(offset); }
+
+		nvrhi::IBuffer* GetVertexBuffer() const { return m_VertexBuffer; }
+		nvrhi::IBuffer* GetIndexBuffer() const { return m_IndexBuffer; }
+
+		RangeAllocator::Stats GetVertexStats() const { return m_VertexAllocator.GetStats(); }
+		RangeAllocator::Stats GetIndexStats() const { return m_IndexAllocator.GetStats(); }
+
+	private:
+		nvrhi::BufferHandle m_VertexBuffer;
+		nvrhi::BufferHandle m_IndexBuffer;
+		RangeAllocator m_VertexAllocator;
+		RangeAllocator m_IndexAllocator;
+	};
+};
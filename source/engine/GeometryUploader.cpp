@@ -0,0 +1,153 @@
+#include <engine/GeometryUploader.h>
+#include <engine/Geometry.h>
+#include <core/log.h>
+
+namespace croissant
+{
+	std::vector<GeometryUploader::Batch> GeometryUploader::BuildPlan(const std::vector<BufferUpload>& uploads, uint64_t segmentSize)
+	{
+		std::vector<Batch> batches;
+		if (segmentSize == 0)
+			return batches;
+
+		for (uint32_t i = 0; i < uint32_t(uploads.size()); i++)
+		{
+			uint64_t srcOffset = 0;
+			while (srcOffset < uploads[i].size)
+			{
+				if (batches.empty() || batches.back().stagingBytes >= segmentSize)
+					batches.emplace_back();
+
+				Batch& batch = batches.back();
+				const uint64_t size = std::min(uploads[i].size - srcOffset, segmentSize - batch.stagingBytes);
+				batch.copies.push_back(Copy{ i, srcOffset, size });
+				batch.stagingBytes = std::min((batch.stagingBytes + size + UploadRing::ALIGNMENT - 1) & ~(UploadRing::ALIGNMENT - 1), segmentSize);
+				srcOffset += size;
+			}
+		}
+		return batches;
+	}
+
+	bool GeometryUploader::Init(DeviceManager* deviceManager, uint64_t segmentSize, uint32_t segmentCount)
+	{
+		m_DeviceManager = deviceManager;
+		nvrhi::IDevice* device = deviceManager->GetDevice();
+
+		if (!m_Ring.Init(device, segmentSize, segmentCount))
+			return false;
+
+		m_SegmentQueries.resize(m_Ring.GetSegmentCount());
+		for (nvrhi::EventQueryHandle& query : m_SegmentQueries)
+			query = device->createEventQuery();
+		m_SegmentInFlight.assign(m_Ring.GetSegmentCount(), false);
+
+		m_CommandList = device->createCommandList();
+		if (deviceManager->GetDeviceParams().enableCopyQueue)
+			m_CopyCommandList = device->createCommandList(nvrhi::CommandListParameters().setQueueType(nvrhi::CommandQueue::Copy));
+
+		return true;
+	}
+
+	void GeometryUploader::Add(Geometry* geometry, GeometryMegaBuffer* megaBuffer)
+	{
+		geometry->CreateResources(m_DeviceManager, megaBuffer);
+		m_Pending.push_back(geometry);
+	}
+
+	void GeometryUploader::Execute(const std::vector<BufferUpload>& uploads, nvrhi::ICommandList* commandList, nvrhi::CommandQueue queue)
+	{
+		nvrhi::IDevice* device = m_DeviceManager->GetDevice();
+
+		for (const Batch& batch : BuildPlan(uploads, m_Ring.GetSegmentSize()))
+		{
+			// Wait until the GPU is done with the previous contents of this segment
+			const uint32_t segment = m_BatchIndex % m_Ring.GetSegmentCount();
+			if (m_SegmentInFlight[segment])
+				device->waitEventQuery(m_SegmentQueries[segment]);
+			m_Ring.BeginFrame(m_BatchIndex++);
+
+			commandList->open();
+			std::unordered_set<nvrhi::IBuffer*> tracked;
+			for (const Copy& copy : batch.copies)
+			{
+				const BufferUpload& upload = uploads[copy.upload];
+				if (upload.finalState != nvrhi::ResourceStates::Unknown && tracked.insert(upload.buffer).second)
+					commandList->beginTrackingBufferState(upload.buffer, nvrhi::ResourceStates::CopyDest);
+
+				m_Ring.Upload(commandList, upload.buffer, upload.offset + copy.srcOffset, static_cast<const uint8_t*>(upload.data) + copy.srcOffset, copy.size);
+				m_Stats.bytes += copy.size;
+				m_Stats.copies++;
+			}
+			commandList->close();
+
+			const uint64_t instance = device->executeCommandList(commandList, queue);
+			if (queue == nvrhi::CommandQueue::Copy)
+				m_LastCopyInstance = instance;
+
+			device->resetEventQuery(m_SegmentQueries[segment]);
+			device->setEventQuery(m_SegmentQueries[segment], queue);
+			m_SegmentInFlight[segment] = true;
+			m_Stats.commandLists++;
+		}
+	}
+
+	bool GeometryUploader::Flush()
+	{
+		if (!m_Ring.IsInitialized())
+		{
+			logger::warning("GeometryUploader::Flush called before Init.");
+			return false;
+		}
+
+		std::vector<BufferUpload> uploads;
+		for (Geometry* geometry : m_Pending)
+			geometry->GetInitialUploads(uploads);
+
+		// Buffers with automatic state tracking return to a vertex or index state at the end of every command list,
+		// which the copy queue cannot do, so only permanently-stated buffers are moved there
+		std::vector<BufferUpload> copyQueueUploads;
+		std::vector<BufferUpload> graphicsUploads;
+		for (const BufferUpload& upload : uploads)
+		{
+			if (upload.finalState != nvrhi::ResourceStates::Unknown && m_CopyCommandList)
+				copyQueueUploads.push_back(upload);
+			else
+				graphicsUploads.push_back(upload);
+		}
+
+		m_LastCopyInstance = 0;
+		if (!copyQueueUploads.empty())
+			Execute(copyQueueUploads, m_CopyCommandList, nvrhi::CommandQueue::Copy);
+		Execute(graphicsUploads, m_CommandList, nvrhi::CommandQueue::Graphics);
+
+		// Permanent states are set once every range of a buffer has been written, all in one graphics command list
+		nvrhi::IDevice* device = m_DeviceManager->GetDevice();
+		if (m_LastCopyInstance != 0)
+			device->queueWaitForCommandList(nvrhi::CommandQueue::Graphics, nvrhi::CommandQueue::Copy, m_LastCopyInstance);
+
+		m_CommandList->open();
+		for (const BufferUpload& upload : uploads)
+		{
+			if (upload.finalState != nvrhi::ResourceStates::Unknown && upload.size > 0)
+			{
+				m_CommandList->beginTrackingBufferState(upload.buffer, nvrhi::ResourceStates::CopyDest);
+				m_CommandList->setPermanentBufferState(upload.buffer, upload.finalState);
+			}
+		}
+		m_CommandList->close();
+		device->executeCommandList(m_CommandList);
+		m_Stats.commandLists++;
+
+		for (size_t segment = 0; segment < m_SegmentQueries.size(); segment++)
+		{
+			if (m_SegmentInFlight[segment])
+				device->waitEventQuery(m_SegmentQueries[segment]);
+			m_SegmentInFlight[segment] = false;
+		}
+
+		for (Geometry* geometry : m_Pending)
+			geometry->FinishUpload();
+		m_Pending.clear();
+		return true;
+	}
+};
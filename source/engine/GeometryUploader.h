@@ -0,0 +1,78 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <nvrhi/nvrhi.h>
+#include <engine/UploadRing.h>
+#include <render/backend/DeviceManager.h>
+
+namespace croissant
+{
+	class Geometry;
+	class GeometryMegaBuffer;
+
+	// One buffer range to fill with CPU data at load time
+	struct BufferUpload
+	{
+		nvrhi::IBuffer* buffer = nullptr;
+		uint64_t offset = 0;
+		const void* data = nullptr;
+		uint64_t size = 0;
+		nvrhi::ResourceStates finalState = nvrhi::ResourceStates::Unknown;	// Permanent state after the upload, Unknown for buffers with automatic state tracking
+	};
+
+	// Uploads the initial data of many geometries through a fixed-size staging ring instead of one submit per Geometry::Init.
+	// Copies are packed into as few command lists as the ring allows; a segment is only refilled once the GPU has
+	// consumed it. With DeviceCreationParameters::enableCopyQueue the permanently-stated buffers go through the copy queue.
+	class GeometryUploader
+	{
+	public:
+		struct Copy
+		{
+			uint32_t upload;		// Index into the upload list
+			uint64_t srcOffset;		// Byte range of that upload
+			uint64_t size;
+		};
+
+		struct Batch
+		{
+			std::vector<Copy> copies;
+			uint64_t stagingBytes = 0;	// Including UploadRing alignment
+		};
+
+		struct Stats
+		{
+			uint64_t bytes = 0;
+			uint32_t copies = 0;
+			uint32_t commandLists = 0;
+		};
+
+		// Splits the uploads into batches that each fit one ring segment, packed the way UploadRing stages them.
+		// Needs no device, uploads larger than a segment are split across batches
+		static std::vector<Batch> BuildPlan(const std::vector<BufferUpload>& uploads, uint64_t segmentSize);
+
+		bool Init(DeviceManager* deviceManager, uint64_t segmentSize = 32 << 20, uint32_t segmentCount = 2);
+
+		// Creates the geometry's buffers now and queues its data for the next Flush
+		void Add(Geometry* geometry, GeometryMegaBuffer* megaBuffer = nullptr);
+
+		// Records and submits every queued upload, then waits for the GPU so the geometries are ready to draw
+		bool Flush();
+
+		const Stats& GetStats() const { return m_Stats; }
+
+	private:
+		void Execute(const std::vector<BufferUpload>& uploads, nvrhi::ICommandList* commandList, nvrhi::CommandQueue queue);
+
+		DeviceManager* m_DeviceManager = nullptr;
+		nvrhi::CommandListHandle m_CommandList;
+		nvrhi::CommandListHandle m_CopyCommandList;		// Null without a copy queue
+		std::vector<nvrhi::EventQueryHandle> m_SegmentQueries;
+		std::vector<bool> m_SegmentInFlight;
+		UploadRing m_Ring;
+		uint32_t m_BatchIndex = 0;
+		uint64_t m_LastCopyInstance = 0;
+
+		std::vector<Geometry*> m_Pending;
+		Stats m_Stats;
+	};
+};
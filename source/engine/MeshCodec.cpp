@@ -0,0 +1,684 @@
+#include <engine/MeshCodec.h>
+#include <core/Threading.h>
+#include <core/log.h>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CROISSANT_CODEC_SSE2 1
+#else
+#define CROISSANT_CODEC_SSE2 0
+#endif
+
+namespace croissant
+{
+	namespace
+	{
+		// Index codec. A code byte per triangle: the high nibble is the distance of the shared edge in the edge FIFO,
+		// or CODE_NO_EDGE followed by a second byte with the codes of the other two vertices. Vertex codes (low
+		// nibbles) are VERTEX_NEXT for the next unseen index, 1 + distance for a hit in the vertex FIFO, or
+		// VERTEX_EXPLICIT for a zigzag varint delta against the last explicit index in the data stream
+		constexpr uint32_t FIFO_SIZE = 16;
+		constexpr uint8_t CODE_NO_EDGE = 15;
+		constexpr uint8_t VERTEX_NEXT = 0;
+		constexpr uint8_t VERTEX_EXPLICIT = 15;
+
+		struct IndexFifos
+		{
+			uint32_t edges[FIFO_SIZE][2];
+			uint32_t vertices[FIFO_SIZE];
+			uint32_t edgeOffset = 0;
+			uint32_t vertexOffset = 0;
+			uint32_t next = 0;		// Lowest index not seen yet, when indices are first used in order
+			uint32_t last = 0;		// Last explicit index
+
+			IndexFifos()
+			{
+				memset(edges, 0xFF, sizeof(edges));
+				memset(vertices, 0xFF, sizeof(vertices));
+			}
+
+			void PushEdge(uint32_t a, uint32_t b)
+			{
+				edges[edgeOffset % FIFO_SIZE][0] = a;
+				edges[edgeOffset % FIFO_SIZE][1] = b;
+				edgeOffset++;
+			}
+
+			void PushVertex(uint32_t v)
+			{
+				vertices[vertexOffset % FIFO_SIZE] = v;
+				vertexOffset++;
+			}
+
+			// Distance of edge (a, b) from the newest entry, FIFO_SIZE - 1 when absent
+			uint32_t FindEdge(uint32_t a, uint32_t b) const
+			{
+				for (uint32_t d = 0; d < FIFO_SIZE - 1; d++)
+				{
+					const uint32_t* edge = edges[(edgeOffset - 1 - d) % FIFO_SIZE];
+					if (edge[0] == a && edge[1] == b)
+						return d;
+				}
+				return FIFO_SIZE - 1;
+			}
+
+			uint32_t FindVertex(uint32_t v) const
+			{
+				for (uint32_t d = 0; d < FIFO_SIZE - 2; d++)
+				{
+					if (vertices[(vertexOffset - 1 - d) % FIFO_SIZE] == v)
+						return d;
+				}
+				return FIFO_SIZE;
+			}
+		};
+
+		void WriteVarint(std::vector<uint8_t>& out, uint32_t value)
+		{
+			while (value >= 0x80)
+			{
+				out.push_back(uint8_t(value | 0x80));
+				value >>= 7;
+			}
+			out.push_back(uint8_t(value));
+		}
+
+		bool ReadVarint(const uint8_t*& data, const uint8_t* end, uint32_t& outValue)
+		{
+			outValue = 0;
+			for (uint32_t shift = 0; shift < 35; shift += 7)
+			{
+				if (data == end)
+					return false;
+				const uint8_t byte = *data++;
+				outValue |= uint32_t(byte & 0x7F) << shift;
+				if (byte < 0x80)
+					return true;
+			}
+			return false;
+		}
+
+		uint8_t EncodeVertex(IndexFifos& fifos, uint32_t v, std::vector<uint8_t>& data)
+		{
+			if (v == fifos.next)
+			{
+				fifos.next++;
+				fifos.PushVertex(v);
+				return VERTEX_NEXT;
+			}
+
+			const uint32_t distance = fifos.FindVertex(v);
+			if (distance < FIFO_SIZE)
+				return uint8_t(1 + distance);
+
+			const int32_t delta = int32_t(v - fifos.last);
+			WriteVarint(data, uint32_t((delta << 1) ^ (delta >> 31)));
+			fifos.last = v;
+			fifos.PushVertex(v);
+			return VERTEX_EXPLICIT;
+		}
+
+		// Fails on indices past vertexCount, which also covers FIFO slots never written
+		bool DecodeVertex(IndexFifos& fifos, uint8_t code, const uint8_t*& data, const uint8_t* end, uint32_t vertexCount, uint32_t& outVertex)
+		{
+			if (code == VERTEX_NEXT)
+			{
+				outVertex = fifos.next++;
+				fifos.PushVertex(outVertex);
+				return outVertex < vertexCount;
+			}
+			if (code != VERTEX_EXPLICIT)
+			{
+				outVertex = fifos.vertices[(fifos.vertexOffset - code) % FIFO_SIZE];
+				return outVertex < vertexCount;
+			}
+
+			uint32_t zigzag;
+			if (!ReadVarint(data, end, zigzag))
+				return false;
+			outVertex = fifos.last + uint32_t(int32_t(zigzag >> 1) ^ -int32_t(zigzag & 1));
+			fifos.last = outVertex;
+			fifos.PushVertex(outVertex);
+			return outVertex < vertexCount;
+		}
+
+		// Vertex codec: bits per group of 16 deltas for each of the four header codes
+		constexpr uint32_t GROUP_BITS[4] = { 0, 2, 4, 8 };
+
+		inline uint8_t ZigzagByte(uint8_t delta)
+		{
+			return uint8_t((delta << 1) ^ uint8_t(int8_t(delta) >> 7));
+		}
+
+		// Payload bytes of the four groups described by a header byte
+		struct GroupSizeTable
+		{
+			uint8_t sizes[256];
+
+			GroupSizeTable()
+			{
+				for (uint32_t header = 0; header < 256; header++)
+				{
+					sizes[header] = 0;
+					for (uint32_t g = 0; g < 4; g++)
+						sizes[header] += uint8_t(GROUP_BITS[(header >> (g * 2)) & 3] * 2);
+				}
+			}
+		};
+		const GroupSizeTable s_GroupSizes;
+
+#if CROISSANT_CODEC_SSE2
+		// Masks selecting the 2-, 4- and 8-bit unpacking of a group for each header code
+		alignas(16) const uint8_t GROUP_SELECT[4][3][16] = {
+			{ {}, {}, {} },
+			{ { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }, {}, {} },
+			{ {}, { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }, {} },
+			{ {}, {}, { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF } },
+		};
+
+		// Branchless unpacking of groups into values continuing from carry. Reads 16 bytes per group whatever its size,
+		// so the caller keeps 16 readable bytes past the payload
+		inline void DecodeGroups(const uint8_t* header, size_t groups, const uint8_t* data, __m128i carry, uint8_t* out)
+		{
+			const __m128i lowNibbles = _mm_set1_epi8(0x0F);
+			const __m128i lowPairs = _mm_set1_epi8(0x03);
+			const __m128i one = _mm_set1_epi8(1);
+			const __m128i lowSeven = _mm_set1_epi8(0x7F);
+
+			// Offsets first, so the loads below do not wait on each other
+			uint32_t modes[MeshCodec::VERTEX_BLOCK / 16], offsets[MeshCodec::VERTEX_BLOCK / 16];
+			uint32_t offset = 0;
+			for (size_t g = 0; g < groups; g++)
+			{
+				modes[g] = (header[g / 4] >> ((g % 4) * 2)) & 3;
+				offsets[g] = offset;
+				offset += GROUP_BITS[modes[g]] * 2;
+			}
+
+			for (size_t g = 0; g < groups; g++)
+			{
+				const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offsets[g]));
+				const __m128i* select = reinterpret_cast<const __m128i*>(GROUP_SELECT[modes[g]]);
+
+				const __m128i a = _mm_and_si128(packed, lowPairs);
+				const __m128i b = _mm_and_si128(_mm_srli_epi16(packed, 2), lowPairs);
+				const __m128i c = _mm_and_si128(_mm_srli_epi16(packed, 4), lowPairs);
+				const __m128i d = _mm_and_si128(_mm_srli_epi16(packed, 6), lowPairs);
+				const __m128i pairs = _mm_unpacklo_epi64(_mm_unpacklo_epi32(a, b), _mm_unpacklo_epi32(c, d));
+				const __m128i nibbles = _mm_unpacklo_epi64(_mm_and_si128(packed, lowNibbles), _mm_and_si128(_mm_srli_epi16(packed, 4), lowNibbles));
+				__m128i deltas = _mm_or_si128(_mm_or_si128(_mm_and_si128(pairs, _mm_load_si128(select)), _mm_and_si128(nibbles, _mm_load_si128(select + 1))),
+					_mm_and_si128(packed, _mm_load_si128(select + 2)));
+
+				// Zigzag, then a prefix sum over the 16 bytes and the running value
+				deltas = _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(deltas, 1), lowSeven), _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(deltas, one)));
+				deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 1));
+				deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 2));
+				deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 4));
+				deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 8));
+				const __m128i values = _mm_add_epi8(deltas, carry);
+				_mm_store_si128(reinterpret_cast<__m128i*>(out + g * 16), values);
+
+				const __m128i top = _mm_unpackhi_epi8(values, values);
+				carry = _mm_shuffle_epi32(_mm_shufflehi_epi16(top, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			}
+		}
+#endif
+
+		// Decodes one lane of a block: groups of 16 zigzag deltas into running byte values continuing from last
+		bool DecodeLane(const uint8_t*& data, const uint8_t* end, size_t groups, uint8_t& last, uint8_t* out)
+		{
+			const size_t headerBytes = (groups + 3) / 4;
+			if (size_t(end - data) < headerBytes)
+				return false;
+			const uint8_t* header = data;
+			size_t payloadBytes = 0;
+			for (size_t h = 0; h < headerBytes; h++)
+				payloadBytes += s_GroupSizes.sizes[header[h]];
+			data += headerBytes;
+			if (size_t(end - data) < payloadBytes)
+				return false;
+
+#if CROISSANT_CODEC_SSE2
+			if (size_t(end - data) >= payloadBytes + 16)
+			{
+				DecodeGroups(header, groups, data, _mm_set1_epi8(char(last)), out);
+			}
+			else
+			{
+				// Near the end of the stream, decode from a padded copy
+				alignas(16) uint8_t padded[MeshCodec::VERTEX_BLOCK + 16] = {};
+				memcpy(padded, data, payloadBytes);
+				DecodeGroups(header, groups, padded, _mm_set1_epi8(char(last)), out);
+			}
+			data += payloadBytes;
+#else
+			uint8_t value = last;
+			for (size_t g = 0; g < groups; g++)
+			{
+				const uint32_t bits = GROUP_BITS[(header[g / 4] >> ((g % 4) * 2)) & 3];
+				for (uint32_t i = 0; i < 16; i++)
+				{
+					uint8_t zigzag = 0;
+					if (bits == 8)
+						zigzag = data[i];
+					else if (bits == 4)
+						zigzag = (data[i % 8] >> ((i / 8) * 4)) & 0x0F;
+					else if (bits == 2)
+						zigzag = (data[i % 4] >> ((i / 4) * 2)) & 0x03;
+					value = uint8_t(value + ((zigzag >> 1) ^ uint8_t(-(zigzag & 1))));
+					out[g * 16 + i] = value;
+				}
+				data += bits * 2;
+			}
+#endif
+			last = out[groups * 16 - 1];
+			return true;
+		}
+
+		// A chunk starts with the first index expected to be new and the size of its code stream
+		void EncodeIndexChunk(const uint32_t* indices, size_t indexCount, uint32_t next, std::vector<uint8_t>& outData)
+		{
+			IndexFifos fifos;
+			fifos.next = fifos.last = next;
+			std::vector<uint8_t> codes, data;
+			codes.reserve(indexCount / 3 + 16);
+			data.reserve(indexCount / 3);
+
+			for (size_t t = 0; t + 2 < indexCount; t += 3)
+			{
+				// A rotation whose first edge was emitted, reversed, by an earlier triangle
+				uint32_t rotation = 0, edgeDistance = FIFO_SIZE - 1;
+				for (uint32_t r = 0; r < 3 && edgeDistance == FIFO_SIZE - 1; r++)
+				{
+					edgeDistance = fifos.FindEdge(indices[t + (r + 1) % 3], indices[t + r]);
+					rotation = r;
+				}
+
+				const uint32_t a = indices[t + rotation], b = indices[t + (rotation + 1) % 3], c = indices[t + (rotation + 2) % 3];
+				if (edgeDistance != FIFO_SIZE - 1)
+				{
+					codes.push_back(uint8_t((edgeDistance << 4) | EncodeVertex(fifos, c, data)));
+					fifos.PushEdge(b, c);
+					fifos.PushEdge(c, a);
+				}
+				else
+				{
+					const uint8_t codeA = EncodeVertex(fifos, a, data);
+					const uint8_t codeB = EncodeVertex(fifos, b, data);
+					const uint8_t codeC = EncodeVertex(fifos, c, data);
+					codes.push_back(uint8_t((CODE_NO_EDGE << 4) | codeA));
+					codes.push_back(uint8_t((codeB << 4) | codeC));
+					fifos.PushEdge(a, b);
+					fifos.PushEdge(b, c);
+					fifos.PushEdge(c, a);
+				}
+			}
+
+			const uint32_t header[2] = { next, uint32_t(codes.size()) };
+			const size_t offset = outData.size();
+			outData.resize(offset + sizeof(header));
+			memcpy(outData.data() + offset, header, sizeof(header));
+			outData.insert(outData.end(), codes.begin(), codes.end());
+			outData.insert(outData.end(), data.begin(), data.end());
+		}
+
+		bool DecodeIndexChunk(const uint8_t* data, size_t size, uint32_t* outIndices, size_t indexCount, uint32_t vertexCount)
+		{
+			uint32_t header[2];
+			if (indexCount % 3 != 0 || size < sizeof(header))
+				return false;
+			memcpy(header, data, sizeof(header));
+			const uint32_t codeBytes = header[1];
+			if (size - sizeof(header) < codeBytes)
+				return false;
+
+			const uint8_t* code = data + sizeof(header);
+			const uint8_t* codeEnd = code + codeBytes;
+			const uint8_t* explicitData = codeEnd;
+			const uint8_t* end = data + size;
+
+			IndexFifos fifos;
+			fifos.next = fifos.last = header[0];
+			for (size_t t = 0; t < indexCount; t += 3)
+			{
+				if (code == codeEnd)
+					return false;
+
+				const uint8_t first = *code++;
+				uint32_t* triangle = outIndices + t;
+				if ((first >> 4) != CODE_NO_EDGE)
+				{
+					const uint32_t* edge = fifos.edges[(fifos.edgeOffset - 1 - (first >> 4)) % FIFO_SIZE];
+					triangle[0] = edge[1];
+					triangle[1] = edge[0];
+					if (triangle[0] >= vertexCount || triangle[1] >= vertexCount ||
+						!DecodeVertex(fifos, first & 0x0F, explicitData, end, vertexCount, triangle[2]))
+						return false;
+					fifos.PushEdge(triangle[1], triangle[2]);
+					fifos.PushEdge(triangle[2], triangle[0]);
+				}
+				else
+				{
+					if (code == codeEnd)
+						return false;
+					const uint8_t second = *code++;
+					if (!DecodeVertex(fifos, first & 0x0F, explicitData, end, vertexCount, triangle[0]) ||
+						!DecodeVertex(fifos, second >> 4, explicitData, end, vertexCount, triangle[1]) ||
+						!DecodeVertex(fifos, second & 0x0F, explicitData, end, vertexCount, triangle[2]))
+						return false;
+					fifos.PushEdge(triangle[0], triangle[1]);
+					fifos.PushEdge(triangle[1], triangle[2]);
+					fifos.PushEdge(triangle[2], triangle[0]);
+				}
+			}
+			return code == codeEnd && explicitData == end;
+		}
+
+		void EncodeVertexChunk(const void* vertices, size_t vertexCount, size_t stride, std::vector<uint8_t>& outData)
+		{
+			const uint8_t* bytes = static_cast<const uint8_t*>(vertices);
+			std::vector<uint8_t> last(stride, 0);
+			uint8_t zigzag[MeshCodec::VERTEX_BLOCK];
+
+			for (size_t first = 0; first < vertexCount; first += MeshCodec::VERTEX_BLOCK)
+			{
+				const size_t count = std::min<size_t>(MeshCodec::VERTEX_BLOCK, vertexCount - first);
+				const size_t groups = (count + 15) / 16;
+				for (size_t k = 0; k < stride; k++)
+				{
+					// Padding deltas are zero, so the lane ends on the last real value
+					memset(zigzag, 0, sizeof(zigzag));
+					for (size_t i = 0; i < count; i++)
+					{
+						const uint8_t value = bytes[(first + i) * stride + k];
+						zigzag[i] = ZigzagByte(uint8_t(value - last[k]));
+						last[k] = value;
+					}
+
+					const size_t headerOffset = outData.size();
+					outData.resize(headerOffset + (groups + 3) / 4, 0);
+					for (size_t g = 0; g < groups; g++)
+					{
+						const uint8_t* group = zigzag + g * 16;
+						uint8_t largest = 0;
+						for (uint32_t i = 0; i < 16; i++)
+							largest = std::max(largest, group[i]);
+
+						const uint32_t mode = largest == 0 ? 0 : largest < 4 ? 1 : largest < 16 ? 2 : 3;
+						outData[headerOffset + g / 4] |= uint8_t(mode << ((g % 4) * 2));
+						if (mode == 1)
+						{
+							for (uint32_t j = 0; j < 4; j++)
+								outData.push_back(uint8_t(group[j] | (group[j + 4] << 2) | (group[j + 8] << 4) | (group[j + 12] << 6)));
+						}
+						else if (mode == 2)
+						{
+							for (uint32_t j = 0; j < 8; j++)
+								outData.push_back(uint8_t(group[j] | (group[j + 8] << 4)));
+						}
+						else if (mode == 3)
+						{
+							outData.insert(outData.end(), group, group + 16);
+						}
+					}
+				}
+			}
+		}
+
+		bool DecodeVertexChunk(const uint8_t* data, size_t size, void* outVertices, size_t vertexCount, size_t stride)
+		{
+			uint8_t* bytes = static_cast<uint8_t*>(outVertices);
+			const uint8_t* end = data + size;
+			std::vector<uint8_t> last(stride, 0);
+			alignas(16) uint8_t lanes[4][MeshCodec::VERTEX_BLOCK];
+
+			for (size_t first = 0; first < vertexCount; first += MeshCodec::VERTEX_BLOCK)
+			{
+				const size_t count = std::min<size_t>(MeshCodec::VERTEX_BLOCK, vertexCount - first);
+				const size_t groups = (count + 15) / 16;
+				uint8_t* block = bytes + first * stride;
+
+				// Four lanes at a time, transposed back into the vertices
+				for (size_t k = 0; k < stride; k += 4)
+				{
+					const size_t laneCount = std::min<size_t>(4, stride - k);
+					for (size_t l = 0; l < laneCount; l++)
+					{
+						if (!DecodeLane(data, end, groups, last[k + l], lanes[l]))
+							return false;
+					}
+
+					size_t i = 0;
+	#if CROISSANT_CODEC_SSE2
+					if (laneCount == 4)
+					{
+						for (; i + 16 <= count; i += 16)
+						{
+							const __m128i l0 = _mm_load_si128(reinterpret_cast<const __m128i*>(lanes[0] + i));
+							const __m128i l1 = _mm_load_si128(reinterpret_cast<const __m128i*>(lanes[1] + i));
+							const __m128i l2 = _mm_load_si128(reinterpret_cast<const __m128i*>(lanes[2] + i));
+							const __m128i l3 = _mm_load_si128(reinterpret_cast<const __m128i*>(lanes[3] + i));
+							const __m128i low01 = _mm_unpacklo_epi8(l0, l1), high01 = _mm_unpackhi_epi8(l0, l1);
+							const __m128i low23 = _mm_unpacklo_epi8(l2, l3), high23 = _mm_unpackhi_epi8(l2, l3);
+
+							alignas(16) uint32_t words[16];
+							_mm_store_si128(reinterpret_cast<__m128i*>(words), _mm_unpacklo_epi16(low01, low23));
+							_mm_store_si128(reinterpret_cast<__m128i*>(words + 4), _mm_unpackhi_epi16(low01, low23));
+							_mm_store_si128(reinterpret_cast<__m128i*>(words + 8), _mm_unpacklo_epi16(high01, high23));
+							_mm_store_si128(reinterpret_cast<__m128i*>(words + 12), _mm_unpackhi_epi16(high01, high23));
+							for (size_t j = 0; j < 16; j++)
+								memcpy(block + (i + j) * stride + k, &words[j], 4);
+						}
+					}
+	#endif
+					for (; i < count; i++)
+					{
+						for (size_t l = 0; l < laneCount; l++)
+							block[i * stride + k + l] = lanes[l][i];
+					}
+				}
+			}
+			return data == end;
+		}
+
+		// Streams are a chunk count, the byte size of every chunk, then the chunks
+		void WriteChunks(const std::vector<std::vector<uint8_t>>& chunks, std::vector<uint8_t>& outData)
+		{
+			std::vector<uint32_t> table;
+			table.push_back(uint32_t(chunks.size()));
+			size_t total = 0;
+			for (const std::vector<uint8_t>& chunk : chunks)
+			{
+				table.push_back(uint32_t(chunk.size()));
+				total += chunk.size();
+			}
+
+			const size_t offset = outData.size();
+			outData.resize(offset + table.size() * sizeof(uint32_t));
+			memcpy(outData.data() + offset, table.data(), table.size() * sizeof(uint32_t));
+			outData.reserve(outData.size() + total);
+			for (const std::vector<uint8_t>& chunk : chunks)
+				outData.insert(outData.end(), chunk.begin(), chunk.end());
+		}
+
+		bool ReadChunks(const uint8_t* data, size_t size, size_t expectedChunks, std::vector<std::pair<const uint8_t*, size_t>>& outChunks)
+		{
+			uint32_t chunkCount;
+			if (size < sizeof(chunkCount))
+				return false;
+			memcpy(&chunkCount, data, sizeof(chunkCount));
+			if (chunkCount != expectedChunks || (size - sizeof(chunkCount)) / sizeof(uint32_t) < chunkCount)
+				return false;
+
+			size_t offset = sizeof(uint32_t) * (size_t(chunkCount) + 1);
+			for (uint32_t c = 0; c < chunkCount; c++)
+			{
+				uint32_t chunkBytes;
+				memcpy(&chunkBytes, data + sizeof(uint32_t) * (c + 1), sizeof(chunkBytes));
+				if (size - offset < chunkBytes)
+					return false;
+				outChunks.emplace_back(data + offset, chunkBytes);
+				offset += chunkBytes;
+			}
+			return offset == size;
+		}
+	}
+
+	void MeshCodec::EncodeIndices(const uint32_t* indices, size_t indexCount, std::vector<uint8_t>& outData)
+	{
+		const size_t triangleCount = indexCount / 3;
+		const size_t chunkCount = (triangleCount + TRIANGLE_CHUNK - 1) / TRIANGLE_CHUNK;
+
+		// Each chunk expects new indices to continue after the largest one of the chunks before it
+		std::vector<uint32_t> next(chunkCount + 1, 0);
+		threading::ParallelFor(chunkCount, 1, [&](size_t begin, size_t end)
+		{
+			for (size_t c = begin; c < end; c++)
+			{
+				const size_t first = c * TRIANGLE_CHUNK * 3;
+				const size_t last = std::min(first + TRIANGLE_CHUNK * 3, triangleCount * 3);
+				for (size_t i = first; i < last; i++)
+					next[c + 1] = std::max(next[c + 1], indices[i] + 1);
+			}
+		});
+		for (size_t c = 1; c <= chunkCount; c++)
+			next[c] = std::max(next[c], next[c - 1]);
+
+		std::vector<std::vector<uint8_t>> chunks(chunkCount);
+		threading::ParallelFor(chunkCount, 1, [&](size_t begin, size_t end)
+		{
+			for (size_t c = begin; c < end; c++)
+			{
+				const size_t first = c * TRIANGLE_CHUNK;
+				EncodeIndexChunk(indices + first * 3, std::min<size_t>(TRIANGLE_CHUNK, triangleCount - first) * 3, next[c], chunks[c]);
+			}
+		});
+		WriteChunks(chunks, outData);
+	}
+
+	bool MeshCodec::DecodeIndices(const uint8_t* data, size_t size, uint32_t* outIndices, size_t indexCount, uint32_t vertexCount)
+	{
+		const size_t triangleCount = indexCount / 3;
+		std::vector<std::pair<const uint8_t*, size_t>> chunks;
+		if (indexCount % 3 != 0 || !ReadChunks(data, size, (triangleCount + TRIANGLE_CHUNK - 1) / TRIANGLE_CHUNK, chunks))
+			return false;
+
+		std::atomic<bool> succeeded = true;
+		threading::ParallelFor(chunks.size(), 1, [&](size_t begin, size_t end)
+		{
+			for (size_t c = begin; c < end; c++)
+			{
+				const size_t first = c * TRIANGLE_CHUNK;
+				if (!DecodeIndexChunk(chunks[c].first, chunks[c].second, outIndices + first * 3, std::min<size_t>(TRIANGLE_CHUNK, triangleCount - first) * 3, vertexCount))
+					succeeded = false;
+			}
+		});
+		return succeeded;
+	}
+
+	void MeshCodec::EncodeVertices(const void* vertices, size_t vertexCount, size_t stride, std::vector<uint8_t>& outData)
+	{
+		std::vector<std::vector<uint8_t>> chunks((vertexCount + VERTEX_CHUNK - 1) / VERTEX_CHUNK);
+		threading::ParallelFor(chunks.size(), 1, [&](size_t begin, size_t end)
+		{
+			for (size_t c = begin; c < end; c++)
+			{
+				const size_t first = c * VERTEX_CHUNK;
+				EncodeVertexChunk(static_cast<const uint8_t*>(vertices) + first * stride, std::min<size_t>(VERTEX_CHUNK, vertexCount - first), stride, chunks[c]);
+			}
+		});
+		WriteChunks(chunks, outData);
+	}
+
+	bool MeshCodec::DecodeVertices(const uint8_t* data, size_t size, void* outVertices, size_t vertexCount, size_t stride)
+	{
+		std::vector<std::pair<const uint8_t*, size_t>> chunks;
+		if (!ReadChunks(data, size, (vertexCount + VERTEX_CHUNK - 1) / VERTEX_CHUNK, chunks))
+			return false;
+
+		std::atomic<bool> succeeded = true;
+		threading::ParallelFor(chunks.size(), 1, [&](size_t begin, size_t end)
+		{
+			for (size_t c = begin; c < end; c++)
+			{
+				const size_t first = c * VERTEX_CHUNK;
+				if (!DecodeVertexChunk(chunks[c].first, chunks[c].second, static_cast<uint8_t*>(outVertices) + first * stride, std::min<size_t>(VERTEX_CHUNK, vertexCount - first), stride))
+					succeeded = false;
+			}
+		});
+		return succeeded;
+	}
+
+	bool MeshCodec::Write(vfs::IFileSystem& fileSystem, const std::filesystem::path& path, const Mesh& mesh)
+	{
+		std::vector<uint8_t> data(sizeof(FileHeader));
+		EncodeVertices(mesh.vertices.data(), mesh.vertices.size(), sizeof(Vertex), data);
+		const size_t vertexBytes = data.size() - sizeof(FileHeader);
+		EncodeIndices(mesh.indices.data(), mesh.indices.size(), data);
+
+		FileHeader header = {};
+		header.magic = FILE_MAGIC;
+		header.version = FILE_VERSION;
+		header.vertexCount = uint32_t(mesh.vertices.size());
+		header.indexCount = uint32_t(mesh.indices.size());
+		header.vertexBytes = vertexBytes;
+		header.indexBytes = data.size() - sizeof(FileHeader) - vertexBytes;
+		for (int i = 0; i < 3; i++)
+		{
+			header.minBounds[i] = mesh.minBounds[i];
+			header.maxBounds[i] = mesh.maxBounds[i];
+		}
+		memcpy(data.data(), &header, sizeof(header));
+
+		if (!fileSystem.writeFile(path, data.data(), data.size()))
+		{
+			logger::warning("MeshCodec::Write: Failed to write %s.", path.generic_string().c_str());
+			return false;
+		}
+		return true;
+	}
+
+	bool MeshCodec::Read(vfs::IFileSystem& fileSystem, const std::filesystem::path& path, Mesh& outMesh)
+	{
+		std::shared_ptr<vfs::IBlob> blob = fileSystem.readFile(path);
+		if (vfs::IBlob::isEmpty(blob.get()) || blob->size() < sizeof(FileHeader))
+		{
+			logger::warning("MeshCodec::Read: Failed to read %s.", path.generic_string().c_str());
+			return false;
+		}
+
+		FileHeader header;
+		memcpy(&header, blob->data(), sizeof(header));
+		if (header.magic != FILE_MAGIC || header.version != FILE_VERSION || header.indexCount % 3 != 0 ||
+			blob->size() - sizeof(FileHeader) != header.vertexBytes + header.indexBytes)
+		{
+			logger::warning("MeshCodec::Read: %s is not a version %u mesh file.", path.generic_string().c_str(), FILE_VERSION);
+			return false;
+		}
+
+		// Every block of vertices codes at least one header byte per lane and every triangle at least one code byte,
+		// so counts the coded sizes cannot hold are corrupt and rejected before allocating for them
+		const uint64_t vertexBlocks = (uint64_t(header.vertexCount) + VERTEX_BLOCK - 1) / VERTEX_BLOCK;
+		if (header.vertexBytes < vertexBlocks * sizeof(Vertex) || header.indexBytes < header.indexCount / 3)
+		{
+			logger::warning("MeshCodec::Read: %s is corrupt.", path.generic_string().c_str());
+			return false;
+		}
+
+		const uint8_t* data = static_cast<const uint8_t*>(blob->data()) + sizeof(FileHeader);
+		outMesh = Mesh();
+		outMesh.vertices.resize(header.vertexCount);
+		outMesh.indices.resize(header.indexCount);
+		if (!DecodeVertices(data, header.vertexBytes, outMesh.vertices.data(), header.vertexCount, sizeof(Vertex)) ||
+			!DecodeIndices(data + header.vertexBytes, header.indexBytes, outMesh.indices.data(), header.indexCount, header.vertexCount))
+		{
+			logger::warning("MeshCodec::Read: %s is corrupt.", path.generic_string().c_str());
+			outMesh = Mesh();
+			return false;
+		}
+
+		outMesh.minBounds = glm::vec3(header.minBounds[0], header.minBounds[1], header.minBounds[2]);
+		outMesh.maxBounds = glm::vec3(header.maxBounds[0], header.maxBounds[1], header.maxBounds[2]);
+		return true;
+	}
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <core/VFS.h>
+#include <engine/MeshOperations.h>
+
+namespace croissant
+{
+	// Lossless compression of index and vertex streams, and the mesh file format built on it.
+	//
+	// Indices are coded per triangle against a FIFO of recently emitted edges and one of recent vertices, in the
+	// spirit of meshoptimizer's index codec: a triangle sharing a recent edge costs one byte when its third vertex is
+	// the next new one or a recent one. Triangle order and winding are kept, but a triangle may come back starting
+	// from another corner, so rebuild half-edge data after decoding.
+	//
+	// Vertices are split into blocks of VERTEX_BLOCK. Within a block every byte of the stride becomes a lane of deltas
+	// against the previous vertex, zigzag coded and bit-packed in groups of 16 at 0, 2, 4 or 8 bits. The decoder
+	// unpacks, integrates and transposes 16 vertices at a time with SSE2.
+	//
+	// Both streams restart their state every VERTEX_CHUNK vertices or TRIANGLE_CHUNK triangles, so chunks are coded
+	// and decoded in parallel on the shared workers; none of these may be called from inside a worker
+	class MeshCodec
+	{
+	public:
+		static constexpr uint32_t VERTEX_BLOCK = 256;
+		static constexpr uint32_t VERTEX_CHUNK = 1 << 16;		// Vertices per independently coded chunk
+		static constexpr uint32_t TRIANGLE_CHUNK = 1 << 16;		// Triangles per independently coded chunk
+		static constexpr uint32_t FILE_MAGIC = 0x534D5343;	// "CSMS"
+		static constexpr uint32_t FILE_VERSION = 1;
+
+		// Appends the coded indices to outData. indexCount must be a multiple of 3. Decoding fails on any index that is
+		// not below vertexCount
+		static void EncodeIndices(const uint32_t* indices, size_t indexCount, std::vector<uint8_t>& outData);
+		static bool DecodeIndices(const uint8_t* data, size_t size, uint32_t* outIndices, size_t indexCount, uint32_t vertexCount);
+
+		// Appends the coded vertices to outData. Any stride works; byte lanes that never change cost almost nothing
+		static void EncodeVertices(const void* vertices, size_t vertexCount, size_t stride, std::vector<uint8_t>& outData);
+		static bool DecodeVertices(const uint8_t* data, size_t size, void* outVertices, size_t vertexCount, size_t stride);
+
+		// Vertices, indices and bounds of a mesh, as .csmesh files that ModelLoader loads natively. Derived data
+		// (half-edges, adjacency, feature edges) is rebuilt after Read
+		static bool Write(vfs::IFileSystem& fileSystem, const std::filesystem::path& path, const Mesh& mesh);
+		static bool Read(vfs::IFileSystem& fileSystem, const std::filesystem::path& path, Mesh& outMesh);
+
+	private:
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t vertexCount;
+			uint32_t indexCount;
+			uint64_t vertexBytes;	// Coded sizes, vertices first
+			uint64_t indexBytes;
+			float    minBounds[3];
+			float    maxBounds[3];
+		};
+	};
+};
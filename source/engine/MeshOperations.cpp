@@ -1,5 +1,8 @@
 #include <engine/MeshOperations.h>
 #include <core/log.h>
+#include <core/Threading.h>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/packing.hpp>
 ;
 
 
@@ -19,6 +22,8 @@ namespace croissant
 		outMesh->halfEdges.reserve(outMesh->indices.size());
 		outMesh->faces.clear();
 		outMesh->faces.reserve(triangleCount);
+		outMesh->vertexHalfEdges.assign(outMesh->vertices.size(), INVALID);
+		outMesh->topologyVersion++;
 
 		// Map Edge to HalfEdgeInfo
 		std::unordered_map<EdgeKey, EdgeInfo, EdgeKeyHash> edgeMap;
@@ -67,6 +72,11 @@ namespace croissant
 			outMesh->halfEdges.push_back(he1);
 			outMesh->halfEdges.push_back(he2);
 
+			// Each half-edge leaves the vertex before it
+			outMesh->vertexHalfEdges[v0] = he0Idx;
+			outMesh->vertexHalfEdges[v1] = he1Idx;
+			outMesh->vertexHalfEdges[v2] = he2Idx;
+
 			//Register edges and find twins
 			ProcessEdge(outMesh, edgeMap, v0, v1, face.halfEdges[0]);
 			ProcessEdge(outMesh, edgeMap, v1, v2, face.halfEdges[1]);
@@ -74,6 +84,16 @@ namespace croissant
 
 		}
 
+		// Twins are only known now. Boundary vertices keep their open outgoing half-edge so ring walks start at the open side
+		for (uint32_t h = 0; h < uint32_t(outMesh->halfEdges.size()); h++)
+		{
+			if (outMesh->halfEdges[h].twin == INVALID)
+			{
+				const uint32_t prev = outMesh->halfEdges[outMesh->halfEdges[h].next].next;
+				outMesh->vertexHalfEdges[outMesh->halfEdges[prev].vert] = h;
+			}
+		}
+
 		return true;
 	}
 
@@ -124,6 +144,100 @@ namespace croissant
 		return true;
 	}
 
+	namespace
+	{
+		glm::vec3 FaceNormal(const Mesh* mesh, size_t face)
+		{
+			const glm::vec3& p0 = mesh->vertices[mesh->indices[face * 3 + 0]].position;
+			const glm::vec3& p1 = mesh->vertices[mesh->indices[face * 3 + 1]].position;
+			const glm::vec3& p2 = mesh->vertices[mesh->indices[face * 3 + 2]].position;
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float length = glm::length(normal);
+			return length > 0.0f ? normal / length : normal;
+		}
+	}
+
+	bool MeshOperations::GenerateFaceNeighbours(Mesh* mesh, float sharpAngleDegrees)
+	{
+		if (mesh->halfEdges.empty() || mesh->faces.empty())
+		{
+			logger::warning("MeshOperations::GenerateFaceNeighbours: Half-edge data not found. Please generate half-edge data first.");
+			return false;
+		}
+
+		if (mesh->faces.size() > NEIGHBOUR_FACE_MASK)
+		{
+			logger::warning("MeshOperations::GenerateFaceNeighbours: %zu faces exceed the packed face index range.", mesh->faces.size());
+			return false;
+		}
+
+		// Face normals are only needed to flag sharp edges
+		const bool flagSharp = sharpAngleDegrees < 180.0f;
+		const float sharpCosine = std::cos(glm::radians(sharpAngleDegrees));
+		std::vector<glm::vec3> faceNormals;
+		if (flagSharp)
+		{
+			faceNormals.resize(mesh->faces.size());
+			threading::ParallelFor(mesh->faces.size(), 1 << 14, [&](size_t begin, size_t end)
+			{
+				for (size_t f = begin; f < end; f++)
+					faceNormals[f] = FaceNormal(mesh, f);
+			});
+		}
+
+		mesh->faceNeighbours.resize(mesh->faces.size() * 3);
+		threading::ParallelFor(mesh->faces.size(), 1 << 14, [&](size_t begin, size_t end)
+		{
+			for (size_t f = begin; f < end; f++)
+			{
+				for (size_t k = 0; k < 3; k++)
+				{
+					const uint32_t twin = mesh->halfEdges[mesh->faces[f].halfEdges[k]].twin;
+					if (twin == INVALID)
+					{
+						mesh->faceNeighbours[f * 3 + k] = NEIGHBOUR_BOUNDARY | NEIGHBOUR_FACE_MASK;
+						continue;
+					}
+
+					const uint32_t neighbour = mesh->halfEdges[twin].face;
+					uint32_t packed = neighbour;
+					if (flagSharp && glm::dot(faceNormals[f], faceNormals[neighbour]) < sharpCosine)
+						packed |= NEIGHBOUR_SHARP;
+					mesh->faceNeighbours[f * 3 + k] = packed;
+				}
+			}
+		});
+
+		return true;
+	}
+
+	void MeshOperations::FindSilhouetteEdges(const Mesh* mesh, const glm::vec3& viewPosition, std::vector<uint32_t>& outEdges)
+	{
+		const size_t faceCount = mesh->faceNeighbours.size() / 3;
+		std::vector<uint8_t> facing(faceCount);
+		threading::ParallelFor(faceCount, 1 << 14, [&](size_t begin, size_t end)
+		{
+			for (size_t f = begin; f < end; f++)
+			{
+				const glm::vec3& p0 = mesh->vertices[mesh->indices[f * 3]].position;
+				facing[f] = glm::dot(FaceNormal(mesh, f), viewPosition - p0) > 0.0f;
+			}
+		});
+
+		for (size_t f = 0; f < faceCount; f++)
+		{
+			if (!facing[f])
+				continue;
+
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				const uint32_t packed = mesh->faceNeighbours[f * 3 + k];
+				if ((packed & NEIGHBOUR_BOUNDARY) || !facing[packed & NEIGHBOUR_FACE_MASK])
+					outEdges.push_back(uint32_t(f * 3 + k));
+			}
+		}
+	}
+
 	void MeshOperations::ProcessEdge(Mesh* outMesh, std::unordered_map<EdgeKey, EdgeInfo, EdgeKeyHash>& edgeMap, uint32_t fromVert, uint32_t toVert, uint32_t halfEdgeIdx)
 	{
 		EdgeKey key(fromVert, toVert);
@@ -192,6 +306,508 @@ namespace croissant
 		return newIdx;
 	}
 
+	void DirtyRanges::Add(uint32_t begin, uint32_t end)
+	{
+		if (begin >= end)
+			return;
+
+		// First range that touches or follows the new one, then absorb everything it overlaps
+		auto first = std::lower_bound(m_Ranges.begin(), m_Ranges.end(), begin, [](const Range& range, uint32_t value) { return range.end < value; });
+		auto last = first;
+		while (last != m_Ranges.end() && last->begin <= end)
+		{
+			begin = std::min(begin, last->begin);
+			end = std::max(end, last->end);
+			++last;
+		}
+
+		first = m_Ranges.erase(first, last);
+		m_Ranges.insert(first, Range{ begin, end });
+	}
+
+	void DirtyRanges::Coalesce(uint32_t gap)
+	{
+		if (m_Ranges.size() < 2)
+			return;
+
+		size_t out = 0;
+		for (size_t i = 1; i < m_Ranges.size(); i++)
+		{
+			if (m_Ranges[i].begin - m_Ranges[out].end <= gap)
+				m_Ranges[out].end = m_Ranges[i].end;
+			else
+				m_Ranges[++out] = m_Ranges[i];
+		}
+		m_Ranges.resize(out + 1);
+	}
+
+	void MeshOperations::ComputeBounds(Mesh* mesh)
+	{
+		if (mesh->vertices.empty())
+		{
+			mesh->minBounds = mesh->maxBounds = glm::vec3(0.0f);
+			return;
+		}
+
+		// Per-range bounds merged under a lock; min/max is order-independent so the result is deterministic
+		std::mutex boundsMutex;
+		mesh->minBounds = mesh->maxBounds = mesh->vertices[0].position;
+		threading::ParallelFor(mesh->vertices.size(), 1 << 16, [&](size_t begin, size_t end)
+		{
+			glm::vec3 minBounds = mesh->vertices[begin].position, maxBounds = minBounds;
+			for (size_t i = begin; i < end; i++)
+			{
+				minBounds = glm::min(minBounds, mesh->vertices[i].position);
+				maxBounds = glm::max(maxBounds, mesh->vertices[i].position);
+			}
+
+			std::lock_guard<std::mutex> lock(boundsMutex);
+			mesh->minBounds = glm::min(mesh->minBounds, minBounds);
+			mesh->maxBounds = glm::max(mesh->maxBounds, maxBounds);
+		});
+	}
+
+	namespace
+	{
+		constexpr size_t NORMAL_FACE_BLOCK = 256;
+
+		// Face normals of faces [begin, end) scaled by twice the face area, with the corner angles for angle weighting.
+		// Positions are gathered into SoA blocks so the cross products vectorise
+		void ComputeFaceNormals(const Mesh* mesh, size_t begin, size_t end, glm::vec3* faceNormals, float* cornerAngles)
+		{
+			float e1x[NORMAL_FACE_BLOCK], e1y[NORMAL_FACE_BLOCK], e1z[NORMAL_FACE_BLOCK];
+			float e2x[NORMAL_FACE_BLOCK], e2y[NORMAL_FACE_BLOCK], e2z[NORMAL_FACE_BLOCK];
+			float nx[NORMAL_FACE_BLOCK], ny[NORMAL_FACE_BLOCK], nz[NORMAL_FACE_BLOCK];
+
+			for (size_t first = begin; first < end; first += NORMAL_FACE_BLOCK)
+			{
+				const size_t count = std::min(NORMAL_FACE_BLOCK, end - first);
+				for (size_t i = 0; i < count; i++)
+				{
+					const uint32_t* corners = &mesh->indices[(first + i) * 3];
+					const glm::vec3& p0 = mesh->vertices[corners[0]].position;
+					const glm::vec3 e1 = mesh->vertices[corners[1]].position - p0;
+					const glm::vec3 e2 = mesh->vertices[corners[2]].position - p0;
+					e1x[i] = e1.x; e1y[i] = e1.y; e1z[i] = e1.z;
+					e2x[i] = e2.x; e2y[i] = e2.y; e2z[i] = e2.z;
+				}
+
+				for (size_t i = 0; i < count; i++)
+				{
+					nx[i] = e1y[i] * e2z[i] - e1z[i] * e2y[i];
+					ny[i] = e1z[i] * e2x[i] - e1x[i] * e2z[i];
+					nz[i] = e1x[i] * e2y[i] - e1y[i] * e2x[i];
+				}
+
+				for (size_t i = 0; i < count; i++)
+					faceNormals[first + i] = glm::vec3(nx[i], ny[i], nz[i]);
+
+				if (!cornerAngles)
+					continue;
+
+				for (size_t i = 0; i < count; i++)
+				{
+					const uint32_t* corners = &mesh->indices[(first + i) * 3];
+					for (int k = 0; k < 3; k++)
+					{
+						const glm::vec3& p = mesh->vertices[corners[k]].position;
+						const glm::vec3 a = mesh->vertices[corners[(k + 1) % 3]].position - p;
+						const glm::vec3 b = mesh->vertices[corners[(k + 2) % 3]].position - p;
+						const float lengths = std::sqrt(glm::dot(a, a) * glm::dot(b, b));
+						cornerAngles[(first + i) * 3 + k] = lengths > 0.0f ? std::acos(std::clamp(glm::dot(a, b) / lengths, -1.0f, 1.0f)) : 0.0f;
+					}
+				}
+			}
+		}
+
+		// Accumulates per-corner values into every vertex: add(sum, corner) for each face corner at the vertex, then
+		// store(vertex, sum). With half-edge data each vertex gathers its own one-ring in parallel, relying on
+		// GenerateHalfEdgeData creating half-edge 3f+k leaving corner k of face f. Otherwise a serial scatter.
+		// A ring only covers one fan, so when the rings miss corners (non-manifold, bowtie or inconsistently wound
+		// vertices) the vertices they missed are stored again from a serial scatter
+		template <typename Accumulator, typename Add, typename Store>
+		void GatherCorners(const Mesh* mesh, const Accumulator& zero, Add&& add, Store&& store)
+		{
+			const bool hasRings = mesh->vertexHalfEdges.size() == mesh->vertices.size() && mesh->halfEdges.size() == mesh->indices.size();
+			if (!hasRings)
+			{
+				std::vector<Accumulator> sums(mesh->vertices.size(), zero);
+				for (size_t corner = 0; corner < mesh->indices.size(); corner++)
+					add(sums[mesh->indices[corner]], uint32_t(corner));
+				for (size_t v = 0; v < sums.size(); v++)
+					store(v, sums[v]);
+				return;
+			}
+
+			// Corners gathered per vertex. A ring never visits a corner twice, so the rings cover every corner exactly
+			// when these add up to the index count
+			std::vector<uint32_t> ringCorners(mesh->vertices.size(), 0);
+			std::atomic<size_t> gathered = 0;
+			threading::ParallelFor(mesh->vertices.size(), 1 << 14, [&](size_t begin, size_t end)
+			{
+				size_t rangeGathered = 0;
+				for (size_t v = begin; v < end; v++)
+				{
+					if (mesh->vertexHalfEdges[v] == INVALID)
+						continue;
+
+					Accumulator sum = zero;
+					VertexRing ring(*mesh, uint32_t(v));
+					for (auto it = ring.begin(); it != ring.end(); ++it)
+					{
+						if (it.GetHalfEdge() != INVALID)
+						{
+							add(sum, it.GetHalfEdge());
+							ringCorners[v]++;
+						}
+					}
+					rangeGathered += ringCorners[v];
+					store(v, sum);
+				}
+				gathered += rangeGathered;
+			});
+
+			if (gathered == mesh->indices.size())
+				return;
+
+			// Count the corners of every vertex and scatter into the ones whose ring fell short
+			std::vector<uint32_t> valence(mesh->vertices.size(), 0);
+			for (uint32_t v : mesh->indices)
+				valence[v]++;
+
+			std::vector<Accumulator> sums(mesh->vertices.size(), zero);
+			for (size_t corner = 0; corner < mesh->indices.size(); corner++)
+			{
+				const uint32_t v = mesh->indices[corner];
+				if (ringCorners[v] != valence[v])
+					add(sums[v], uint32_t(corner));
+			}
+			for (size_t v = 0; v < sums.size(); v++)
+			{
+				if (ringCorners[v] != valence[v])
+					store(v, sums[v]);
+			}
+		}
+	}
+
+	void MeshOperations::ComputeNormals(Mesh* mesh, NormalWeighting weighting)
+	{
+		const size_t faceCount = mesh->indices.size() / 3;
+		if (faceCount == 0)
+			return;
+
+		// Unit face normals times the corner angle give angle weighting, the raw cross product gives area weighting
+		const bool angleWeighted = weighting == NormalWeighting::Angle;
+		std::vector<glm::vec3> faceNormals(faceCount);
+		std::vector<float> cornerAngles(angleWeighted ? faceCount * 3 : 0);
+		threading::ParallelFor(faceCount, 1 << 14, [&](size_t begin, size_t end)
+		{
+			ComputeFaceNormals(mesh, begin, end, faceNormals.data(), angleWeighted ? cornerAngles.data() : nullptr);
+			if (angleWeighted)
+			{
+				for (size_t f = begin; f < end; f++)
+				{
+					const float length = glm::length(faceNormals[f]);
+					faceNormals[f] = length > 0.0f ? faceNormals[f] / length : glm::vec3(0.0f);
+				}
+			}
+		});
+
+		GatherCorners(mesh, glm::vec3(0.0f),
+			[&](glm::vec3& sum, uint32_t corner) { sum += faceNormals[corner / 3] * (angleWeighted ? cornerAngles[corner] : 1.0f); },
+			[&](size_t v, const glm::vec3& sum)
+			{
+				const float length = glm::length(sum);
+				if (length > 0.0f)
+					mesh->vertices[v].normal = sum / length;
+			});
+	}
+
+	namespace
+	{
+		struct TangentSum
+		{
+			glm::vec3 tangent;
+			glm::vec3 bitangent;
+		};
+
+		// Packs an orthonormal tangent frame as a quaternion in 4 snorm8 components. The sign of w carries the
+		// bitangent handedness, so w is kept away from zero where its sign would not survive quantisation
+		uint32_t PackTangentFrame(const glm::vec3& normal, const glm::vec3& tangent, float handedness)
+		{
+			glm::quat q = glm::normalize(glm::quat_cast(glm::mat3(tangent, glm::cross(normal, tangent), normal)));
+			if (q.w < 0.0f)
+				q = glm::quat(-q.w, -q.x, -q.y, -q.z);
+
+			constexpr float bias = 1.0f / 127.0f;
+			if (q.w < bias)
+			{
+				const float scale = std::sqrt(1.0f - bias * bias);
+				q = glm::quat(bias, q.x * scale, q.y * scale, q.z * scale);
+			}
+
+			if (handedness < 0.0f)
+				q = glm::quat(-q.w, -q.x, -q.y, -q.z);
+
+			return glm::packSnorm4x8(glm::vec4(q.x, q.y, q.z, q.w));
+		}
+	}
+
+	void MeshOperations::ComputeTangentFrames(Mesh* mesh)
+	{
+		const size_t faceCount = mesh->indices.size() / 3;
+		if (faceCount == 0)
+			return;
+
+		// Per-face UV gradients, normalised and weighted by face area so the UV scale does not bias the average
+		std::vector<TangentSum> faceTangents(faceCount);
+		threading::ParallelFor(faceCount, 1 << 14, [&](size_t begin, size_t end)
+		{
+			for (size_t f = begin; f < end; f++)
+			{
+				const Vertex& v0 = mesh->vertices[mesh->indices[f * 3 + 0]];
+				const Vertex& v1 = mesh->vertices[mesh->indices[f * 3 + 1]];
+				const Vertex& v2 = mesh->vertices[mesh->indices[f * 3 + 2]];
+				const glm::vec3 e1 = v1.position - v0.position;
+				const glm::vec3 e2 = v2.position - v0.position;
+				const glm::vec2 d1 = v1.uv - v0.uv;
+				const glm::vec2 d2 = v2.uv - v0.uv;
+
+				const float determinant = d1.x * d2.y - d2.x * d1.y;
+				const glm::vec3 tangent = (e1 * d2.y - e2 * d1.y) * (determinant < 0.0f ? -1.0f : 1.0f);
+				const glm::vec3 bitangent = (e2 * d1.x - e1 * d2.x) * (determinant < 0.0f ? -1.0f : 1.0f);
+				const float tangentLength = glm::length(tangent), bitangentLength = glm::length(bitangent);
+				const float area = glm::length(glm::cross(e1, e2));
+
+				// Faces with degenerate UVs do not contribute
+				if (determinant == 0.0f || tangentLength == 0.0f || bitangentLength == 0.0f)
+					faceTangents[f] = TangentSum{ glm::vec3(0.0f), glm::vec3(0.0f) };
+				else
+					faceTangents[f] = TangentSum{ tangent * (area / tangentLength), bitangent * (area / bitangentLength) };
+			}
+		});
+
+		mesh->tangentFrames.resize(mesh->vertices.size());
+		std::fill(mesh->tangentFrames.begin(), mesh->tangentFrames.end(), PackTangentFrame(glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f), 1.0f));
+
+		GatherCorners(mesh, TangentSum{ glm::vec3(0.0f), glm::vec3(0.0f) },
+			[&](TangentSum& sum, uint32_t corner)
+			{
+				sum.tangent += faceTangents[corner / 3].tangent;
+				sum.bitangent += faceTangents[corner / 3].bitangent;
+			},
+			[&](size_t v, const TangentSum& sum)
+			{
+				// Gram-Schmidt against the vertex normal, with any perpendicular axis when the UVs give no direction
+				const glm::vec3 normal = mesh->vertices[v].normal;
+				glm::vec3 tangent = sum.tangent - normal * glm::dot(normal, sum.tangent);
+				if (glm::dot(tangent, tangent) < 1e-20f)
+					tangent = std::abs(normal.x) < 0.9f ? glm::cross(normal, glm::vec3(1.0f, 0.0f, 0.0f)) : glm::cross(normal, glm::vec3(0.0f, 1.0f, 0.0f));
+				if (glm::dot(tangent, tangent) < 1e-20f)
+					return;
+
+				tangent = glm::normalize(tangent);
+				const float handedness = glm::dot(glm::cross(normal, tangent), sum.bitangent) < 0.0f ? -1.0f : 1.0f;
+				mesh->tangentFrames[v] = PackTangentFrame(normal, tangent, handedness);
+			});
+	}
+
+	namespace
+	{
+		constexpr size_t FEATURE_EDGE_BLOCK = 256;
+		constexpr size_t FEATURE_EDGE_CHUNK = 1 << 14;	// Faces per task, each task fills its own lists
+
+		// Tests a block of interior edges at once: the face normals on both sides are gathered into SoA arrays and
+		// compared without normalising, dot(n0, n1) < cos(angle) * |n0| * |n1|. Edges next to degenerate faces never crease
+		void FlagCreases(const uint32_t* edges, size_t count, const float (&n0)[3][FEATURE_EDGE_BLOCK], const float (&n1)[3][FEATURE_EDGE_BLOCK],
+			float creaseCosine, std::vector<uint32_t>& outCreases)
+		{
+			float dots[FEATURE_EDGE_BLOCK], limits[FEATURE_EDGE_BLOCK];
+			for (size_t i = 0; i < count; i++)
+			{
+				dots[i] = n0[0][i] * n1[0][i] + n0[1][i] * n1[1][i] + n0[2][i] * n1[2][i];
+				const float lengths = (n0[0][i] * n0[0][i] + n0[1][i] * n0[1][i] + n0[2][i] * n0[2][i]) *
+					(n1[0][i] * n1[0][i] + n1[1][i] * n1[1][i] + n1[2][i] * n1[2][i]);
+				limits[i] = lengths > 0.0f ? creaseCosine * std::sqrt(lengths) : -std::numeric_limits<float>::infinity();
+			}
+
+			for (size_t i = 0; i < count; i++)
+			{
+				if (dots[i] < limits[i])
+					outCreases.push_back(edges[i]);
+			}
+		}
+	}
+
+	bool MeshOperations::UpdateFeatureEdges(Mesh* mesh, float creaseAngleDegrees)
+	{
+		FeatureEdges& features = mesh->featureEdges;
+		if (features.topologyVersion == mesh->topologyVersion && features.creaseAngleDegrees == creaseAngleDegrees)
+			return true;
+
+		if (mesh->halfEdges.empty() || mesh->faces.empty())
+		{
+			logger::warning("MeshOperations::UpdateFeatureEdges: Half-edge data not found. Please generate half-edge data first.");
+			return false;
+		}
+
+		const size_t faceCount = mesh->faces.size();
+		std::vector<glm::vec3> faceNormals(faceCount);
+		threading::ParallelFor(faceCount, 1 << 14, [&](size_t begin, size_t end)
+		{
+			ComputeFaceNormals(mesh, begin, end, faceNormals.data(), nullptr);
+		});
+
+		// Interior edges are visited from their lower half-edge only, so every edge is listed once
+		const float creaseCosine = std::cos(glm::radians(creaseAngleDegrees));
+		const size_t chunkCount = (faceCount + FEATURE_EDGE_CHUNK - 1) / FEATURE_EDGE_CHUNK;
+		std::vector<std::vector<uint32_t>> chunkCreases(chunkCount), chunkBoundaries(chunkCount);
+		threading::ParallelFor(chunkCount, 1, [&](size_t beginChunk, size_t endChunk)
+		{
+			uint32_t edges[FEATURE_EDGE_BLOCK];
+			float n0[3][FEATURE_EDGE_BLOCK], n1[3][FEATURE_EDGE_BLOCK];
+			for (size_t chunk = beginChunk; chunk < endChunk; chunk++)
+			{
+				size_t count = 0;
+				const size_t endFace = std::min(faceCount, (chunk + 1) * FEATURE_EDGE_CHUNK);
+				for (size_t f = chunk * FEATURE_EDGE_CHUNK; f < endFace; f++)
+				{
+					for (uint32_t halfEdge : mesh->faces[f].halfEdges)
+					{
+						const uint32_t twin = mesh->halfEdges[halfEdge].twin;
+						if (twin == INVALID)
+						{
+							chunkBoundaries[chunk].push_back(halfEdge);
+							continue;
+						}
+						if (twin < halfEdge)
+							continue;
+
+						const glm::vec3& a = faceNormals[f];
+						const glm::vec3& b = faceNormals[mesh->halfEdges[twin].face];
+						edges[count] = halfEdge;
+						n0[0][count] = a.x; n0[1][count] = a.y; n0[2][count] = a.z;
+						n1[0][count] = b.x; n1[1][count] = b.y; n1[2][count] = b.z;
+						if (++count == FEATURE_EDGE_BLOCK)
+						{
+							FlagCreases(edges, count, n0, n1, creaseCosine, chunkCreases[chunk]);
+							count = 0;
+						}
+					}
+				}
+				FlagCreases(edges, count, n0, n1, creaseCosine, chunkCreases[chunk]);
+			}
+		});
+
+		features.creases.clear();
+		features.boundaries.clear();
+		for (size_t chunk = 0; chunk < chunkCount; chunk++)
+		{
+			features.creases.insert(features.creases.end(), chunkCreases[chunk].begin(), chunkCreases[chunk].end());
+			features.boundaries.insert(features.boundaries.end(), chunkBoundaries[chunk].begin(), chunkBoundaries[chunk].end());
+		}
+		features.creases.shrink_to_fit();
+		features.boundaries.shrink_to_fit();
+		features.creaseAngleDegrees = creaseAngleDegrees;
+		features.topologyVersion = mesh->topologyVersion;
+		return true;
+	}
+
+	void MeshOperations::GetFeatureEdgeLines(const Mesh* mesh, std::vector<uint32_t>& outIndices)
+	{
+		const FeatureEdges& features = mesh->featureEdges;
+		outIndices.reserve(outIndices.size() + (features.creases.size() + features.boundaries.size()) * 2);
+		for (const std::vector<uint32_t>* edges : { &features.creases, &features.boundaries })
+		{
+			for (uint32_t halfEdge : *edges)
+			{
+				// The half-edge points at the end vertex, its prev (next of next) at the start vertex
+				const HalfEdge& edge = mesh->halfEdges[halfEdge];
+				outIndices.push_back(mesh->halfEdges[mesh->halfEdges[edge.next].next].vert);
+				outIndices.push_back(edge.vert);
+			}
+		}
+	}
+
+	namespace
+	{
+		constexpr uint32_t STRIP_COMMITTED = 0xFFFFFFFF;
+
+		// Walks a strip starting with the corners (k, k + 1, k + 2) of face, marking the faces it covers with stamp, and
+		// returns how many it covered. Appends the strip's vertices to outIndices when given
+		uint32_t WalkStrip(const Mesh* mesh, uint32_t face, uint32_t corner, std::vector<uint32_t>& stamps, uint32_t stamp, std::vector<uint32_t>* outIndices)
+		{
+			const std::vector<HalfEdge>& halfEdges = mesh->halfEdges;
+			if (outIndices)
+			{
+				const uint32_t* corners = &mesh->indices[size_t(face) * 3];
+				outIndices->insert(outIndices->end(), { corners[corner], corners[(corner + 1) % 3], corners[(corner + 2) % 3] });
+			}
+			stamps[face] = stamp;
+
+			// The half-edge between the last two strip vertices, in the last triangle. Even triangles keep the face
+			// winding and hold it from the second last to the last vertex, odd ones are flipped and hold it backwards
+			uint32_t edge = face * 3 + (corner + 1) % 3;
+			uint32_t length = 1;
+			for (bool odd = false; ; odd = !odd)
+			{
+				const uint32_t twin = halfEdges[edge].twin;
+				if (twin == INVALID)
+					break;
+
+				const uint32_t next = halfEdges[twin].face;
+				const uint32_t edgeStart = halfEdges[halfEdges[halfEdges[edge].next].next].vert;
+				if (stamps[next] == stamp || stamps[next] == STRIP_COMMITTED || halfEdges[twin].vert != edgeStart)
+					break;
+
+				const uint32_t twinNext = halfEdges[twin].next;
+				if (outIndices)
+					outIndices->push_back(halfEdges[twinNext].vert);
+				stamps[next] = stamp;
+				length++;
+				edge = odd ? twinNext : halfEdges[twinNext].next;
+			}
+			return length;
+		}
+	}
+
+	bool MeshOperations::GenerateTriangleStrips(Mesh* mesh)
+	{
+		mesh->stripIndices.clear();
+		if (mesh->indices.empty() || mesh->halfEdges.size() != mesh->indices.size())
+		{
+			logger::warning("MeshOperations::GenerateTriangleStrips: Mesh has no half-edge data.");
+			return false;
+		}
+
+		const uint32_t faceCount = uint32_t(mesh->indices.size() / 3);
+		std::vector<uint32_t> stamps(faceCount, 0);
+		uint32_t stamp = 0;
+		mesh->stripIndices.reserve(mesh->indices.size() / 2);
+		for (uint32_t face = 0; face < faceCount; face++)
+		{
+			if (stamps[face] == STRIP_COMMITTED)
+				continue;
+
+			uint32_t bestCorner = 0, bestLength = 0;
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				const uint32_t length = WalkStrip(mesh, face, corner, stamps, ++stamp, nullptr);
+				if (length > bestLength)
+				{
+					bestLength = length;
+					bestCorner = corner;
+				}
+			}
+
+			if (!mesh->stripIndices.empty())
+				mesh->stripIndices.push_back(STRIP_RESTART_INDEX);
+			WalkStrip(mesh, face, bestCorner, stamps, STRIP_COMMITTED, &mesh->stripIndices);
+		}
+		mesh->stripIndices.shrink_to_fit();
+		return true;
+	}
+
 	bool MeshOperations::PlanarSubdivide(const Mesh* inMesh, Mesh* outMesh)
 	{
 		if (!inMesh || !outMesh) return false;
@@ -256,6 +872,307 @@ namespace croissant
 		outMesh->minBounds = inMesh->minBounds;
 		outMesh->maxBounds = inMesh->maxBounds;
 
+		// Subdivided levels are drawn at the same scene nodes
+		outMesh->instanceTransforms = inMesh->instanceTransforms;
+
+		return true;
+	}
+
+	namespace
+	{
+		// Lattice of a base triangle cut into segments^2 triangles. Point (a, b) sits at barycentrics
+		// ((n - a - b) / n, a / n, b / n), so (0, 0), (n, 0) and (0, n) are the corners, and rows of constant b are stored in turn
+		struct PNTessellationTable
+		{
+			static constexpr uint32_t SLOT_CORNER = 0u << 30;
+			static constexpr uint32_t SLOT_EDGE = 1u << 30;		// Edge k * segments + position from corner k
+			static constexpr uint32_t SLOT_INTERIOR = 2u << 30;	// Interior point index
+			static constexpr uint32_t SLOT_MASK = 3u << 30;
+
+			uint32_t segments = 0;
+			uint32_t interiorCount = 0;
+
+			// Per interior point, one array per control point so evaluation runs down the points: cubic Bernstein weights
+			// of b300, b030, b003, b210, b120, b201, b021, b102, b012, b111, quadratic ones of n200, n020, n002, n110,
+			// n011, n101, and the barycentrics for the uvs
+			std::vector<float> positionWeights[10];
+			std::vector<float> normalWeights[6];
+			std::vector<float> barycentrics[3];
+
+			std::vector<uint32_t> pointSlots;	// SLOT_* | index, per lattice point
+			std::vector<uint32_t> triangles;	// Lattice point ids, three per triangle, winding of the base triangle
+
+			uint32_t PointId(uint32_t a, uint32_t b) const { return b * (segments + 1) - b * (b - 1) / 2 + a; }
+		};
+
+		void BuildPNTessellationTable(uint32_t segments, PNTessellationTable& table)
+		{
+			const uint32_t n = segments;
+			table.segments = n;
+			table.interiorCount = n > 1 ? (n - 1) * (n - 2) / 2 : 0;
+			table.pointSlots.resize((n + 1) * (n + 2) / 2);
+			for (uint32_t b = 0; b <= n; b++)
+			{
+				for (uint32_t a = 0; a + b <= n; a++)
+				{
+					uint32_t slot;
+					if (b == 0)
+						slot = a == 0 ? PNTessellationTable::SLOT_CORNER | 0 : a == n ? PNTessellationTable::SLOT_CORNER | 1 : PNTessellationTable::SLOT_EDGE | a;
+					else if (a + b == n)
+						slot = b == n ? PNTessellationTable::SLOT_CORNER | 2 : PNTessellationTable::SLOT_EDGE | (n + b);
+					else if (a == 0)
+						slot = PNTessellationTable::SLOT_EDGE | (2 * n + n - b);
+					else
+					{
+						slot = PNTessellationTable::SLOT_INTERIOR | uint32_t(table.barycentrics[0].size());
+						const float w0 = float(n - a - b) / float(n), w1 = float(a) / float(n), w2 = float(b) / float(n);
+						const float position[10] = {
+							w0 * w0 * w0, w1 * w1 * w1, w2 * w2 * w2,
+							3.0f * w0 * w0 * w1, 3.0f * w0 * w1 * w1, 3.0f * w0 * w0 * w2,
+							3.0f * w1 * w1 * w2, 3.0f * w0 * w2 * w2, 3.0f * w1 * w2 * w2,
+							6.0f * w0 * w1 * w2 };
+						const float normal[6] = { w0 * w0, w1 * w1, w2 * w2, w0 * w1, w1 * w2, w0 * w2 };
+						for (int c = 0; c < 10; c++)
+							table.positionWeights[c].push_back(position[c]);
+						for (int c = 0; c < 6; c++)
+							table.normalWeights[c].push_back(normal[c]);
+						table.barycentrics[0].push_back(w0);
+						table.barycentrics[1].push_back(w1);
+						table.barycentrics[2].push_back(w2);
+					}
+					table.pointSlots[table.PointId(a, b)] = slot;
+				}
+			}
+
+			table.triangles.reserve(size_t(n) * n * 3);
+			for (uint32_t b = 0; b < n; b++)
+			{
+				for (uint32_t a = 0; a + b < n; a++)
+				{
+					table.triangles.insert(table.triangles.end(), { table.PointId(a, b), table.PointId(a + 1, b), table.PointId(a, b + 1) });
+					if (a + b + 1 < n)
+						table.triangles.insert(table.triangles.end(), { table.PointId(a + 1, b), table.PointId(a + 1, b + 1), table.PointId(a, b + 1) });
+				}
+			}
+		}
+
+		glm::vec3 SafeNormalize(const glm::vec3& v)
+		{
+			const float length = glm::length(v);
+			return length > 0.0f ? v / length : v;
+		}
+
+		// Inner control point of the cubic edge curve next to p, a third of the way to q projected onto the tangent plane of p
+		glm::vec3 PNEdgeControl(const glm::vec3& p, const glm::vec3& n, const glm::vec3& q)
+		{
+			return (2.0f * p + q - glm::dot(q - p, n) * n) / 3.0f;
+		}
+
+		// Middle normal of an edge, the average of its end normals reflected across the plane bisecting the edge
+		glm::vec3 PNEdgeNormal(const glm::vec3& p0, const glm::vec3& n0, const glm::vec3& p1, const glm::vec3& n1)
+		{
+			const glm::vec3 d = p1 - p0;
+			const float lengthSq = glm::dot(d, d);
+			const float reflection = lengthSq > 0.0f ? 2.0f * glm::dot(d, n0 + n1) / lengthSq : 0.0f;
+			return SafeNormalize(n0 + n1 - reflection * d);
+		}
+	}
+
+	bool MeshOperations::PNTriangleSubdivide(const Mesh* inMesh, Mesh* outMesh, uint32_t level)
+	{
+		if (!inMesh || !outMesh) return false;
+		if (inMesh->vertices.empty() || inMesh->indices.empty()) return false;
+		if (level == 0 || level > MAX_PN_TRIANGLE_LEVEL) return false;
+		if (inMesh->halfEdges.size() != inMesh->indices.size())
+		{
+			logger::warning("PN triangle subdivision needs half-edge data.");
+			return false;
+		}
+
+		const uint32_t n = 1u << level;
+		PNTessellationTable table;
+		BuildPNTessellationTable(n, table);
+
+		// One id per edge, owned by its first half-edge
+		const std::vector<HalfEdge>& halfEdges = inMesh->halfEdges;
+		std::vector<uint32_t> edgeIds(halfEdges.size());
+		std::vector<uint32_t> edgeOwners;
+		edgeOwners.reserve(halfEdges.size() / 2 + 1);
+		for (uint32_t h = 0; h < halfEdges.size(); h++)
+		{
+			if (halfEdges[h].twin == INVALID || h < halfEdges[h].twin)
+			{
+				edgeIds[h] = uint32_t(edgeOwners.size());
+				edgeOwners.push_back(h);
+			}
+		}
+		for (uint32_t h = 0; h < halfEdges.size(); h++)
+			if (halfEdges[h].twin != INVALID && h > halfEdges[h].twin)
+				edgeIds[h] = edgeIds[halfEdges[h].twin];
+
+		// Base vertices, then n - 1 points per edge from its owner's start, then the interior points face by face
+		const size_t faceCount = inMesh->indices.size() / 3;
+		const size_t edgeBase = inMesh->vertices.size();
+		const size_t interiorBase = edgeBase + edgeOwners.size() * (n - 1);
+		const size_t vertexCount = interiorBase + faceCount * table.interiorCount;
+		if (vertexCount >= INVALID)
+		{
+			logger::warning("PN triangle subdivision level %u needs %zu vertices, more than 32-bit indices can address.", level, vertexCount);
+			return false;
+		}
+
+		outMesh->vertices.clear();
+		outMesh->indices.clear();
+		outMesh->halfEdges.clear();
+		outMesh->faces.clear();
+		outMesh->vertices.resize(vertexCount);
+		outMesh->indices.resize(faceCount * table.triangles.size());
+		std::copy(inMesh->vertices.begin(), inMesh->vertices.end(), outMesh->vertices.begin());
+
+		const Vertex* baseVertices = inMesh->vertices.data();
+		const uint32_t* baseIndices = inMesh->indices.data();
+		Vertex* outVertices = outMesh->vertices.data();
+
+		// Edge points depend on the two end vertices only, so both faces of an edge agree on them
+		threading::ParallelFor(edgeOwners.size(), 1 << 12, [&](size_t begin, size_t end)
+		{
+			for (size_t e = begin; e < end; e++)
+			{
+				const uint32_t h = edgeOwners[e];
+				const Vertex& v0 = baseVertices[baseIndices[h]];
+				const Vertex& v1 = baseVertices[baseIndices[h - h % 3 + (h + 1) % 3]];
+				const glm::vec3 n0 = SafeNormalize(v0.normal), n1 = SafeNormalize(v1.normal);
+				const glm::vec3 c0 = PNEdgeControl(v0.position, n0, v1.position);
+				const glm::vec3 c1 = PNEdgeControl(v1.position, n1, v0.position);
+				const glm::vec3 middleNormal = PNEdgeNormal(v0.position, n0, v1.position, n1);
+
+				Vertex* out = outVertices + edgeBase + e * (n - 1);
+				for (uint32_t s = 1; s < n; s++)
+				{
+					const float t = float(s) / float(n), r = 1.0f - t;
+					out[s - 1].position = r * r * r * v0.position + 3.0f * r * r * t * c0 + 3.0f * r * t * t * c1 + t * t * t * v1.position;
+					out[s - 1].uv = r * v0.uv + t * v1.uv;
+					out[s - 1].normal = SafeNormalize(r * r * n0 + r * t * middleNormal + t * t * n1);
+				}
+			}
+		});
+
+		threading::ParallelFor(faceCount, 1 << 8, [&](size_t begin, size_t end)
+		{
+			const uint32_t interiorCount = table.interiorCount;
+			std::vector<float> scratch(size_t(interiorCount) * 8);
+			std::vector<uint32_t> pointVertices(table.pointSlots.size());
+
+			for (size_t f = begin; f < end; f++)
+			{
+				const uint32_t* corners = baseIndices + f * 3;
+				const glm::vec3 p[3] = { baseVertices[corners[0]].position, baseVertices[corners[1]].position, baseVertices[corners[2]].position };
+				const glm::vec3 nrm[3] = { SafeNormalize(baseVertices[corners[0]].normal), SafeNormalize(baseVertices[corners[1]].normal), SafeNormalize(baseVertices[corners[2]].normal) };
+				const glm::vec2 uv[3] = { baseVertices[corners[0]].uv, baseVertices[corners[1]].uv, baseVertices[corners[2]].uv };
+
+				if (interiorCount > 0)
+				{
+					glm::vec3 control[10] = { p[0], p[1], p[2],
+						PNEdgeControl(p[0], nrm[0], p[1]), PNEdgeControl(p[1], nrm[1], p[0]),
+						PNEdgeControl(p[0], nrm[0], p[2]), PNEdgeControl(p[1], nrm[1], p[2]),
+						PNEdgeControl(p[2], nrm[2], p[0]), PNEdgeControl(p[2], nrm[2], p[1]),
+						glm::vec3(0.0f) };
+					const glm::vec3 edgeAverage = (control[3] + control[4] + control[5] + control[6] + control[7] + control[8]) / 6.0f;
+					const glm::vec3 centre = (p[0] + p[1] + p[2]) / 3.0f;
+					control[9] = edgeAverage + (edgeAverage - centre) * 0.5f;
+					const glm::vec3 normalControl[6] = { nrm[0], nrm[1], nrm[2],
+						PNEdgeNormal(p[0], nrm[0], p[1], nrm[1]), PNEdgeNormal(p[1], nrm[1], p[2], nrm[2]), PNEdgeNormal(p[2], nrm[2], p[0], nrm[0]) };
+
+					// Accumulated one control point at a time so the inner loops run straight down the table
+					float* px = scratch.data();
+					float* py = px + interiorCount;
+					float* pz = py + interiorCount;
+					float* nx = pz + interiorCount;
+					float* ny = nx + interiorCount;
+					float* nz = ny + interiorCount;
+					float* tu = nz + interiorCount;
+					float* tv = tu + interiorCount;
+					std::fill(scratch.begin(), scratch.end(), 0.0f);
+					for (int c = 0; c < 10; c++)
+					{
+						const float* w = table.positionWeights[c].data();
+						const glm::vec3 cp = control[c];
+						for (uint32_t k = 0; k < interiorCount; k++)
+						{
+							px[k] += w[k] * cp.x;
+							py[k] += w[k] * cp.y;
+							pz[k] += w[k] * cp.z;
+						}
+					}
+					for (int c = 0; c < 6; c++)
+					{
+						const float* w = table.normalWeights[c].data();
+						const glm::vec3 cn = normalControl[c];
+						for (uint32_t k = 0; k < interiorCount; k++)
+						{
+							nx[k] += w[k] * cn.x;
+							ny[k] += w[k] * cn.y;
+							nz[k] += w[k] * cn.z;
+						}
+					}
+					for (int c = 0; c < 3; c++)
+					{
+						const float* w = table.barycentrics[c].data();
+						const glm::vec2 cuv = uv[c];
+						for (uint32_t k = 0; k < interiorCount; k++)
+						{
+							tu[k] += w[k] * cuv.x;
+							tv[k] += w[k] * cuv.y;
+						}
+					}
+
+					Vertex* out = outVertices + interiorBase + f * interiorCount;
+					for (uint32_t k = 0; k < interiorCount; k++)
+					{
+						out[k].position = glm::vec3(px[k], py[k], pz[k]);
+						out[k].uv = glm::vec2(tu[k], tv[k]);
+						out[k].normal = SafeNormalize(glm::vec3(nx[k], ny[k], nz[k]));
+					}
+				}
+
+				for (size_t point = 0; point < table.pointSlots.size(); point++)
+				{
+					const uint32_t slot = table.pointSlots[point];
+					const uint32_t index = slot & ~PNTessellationTable::SLOT_MASK;
+					switch (slot & PNTessellationTable::SLOT_MASK)
+					{
+					case PNTessellationTable::SLOT_CORNER:
+						pointVertices[point] = corners[index];
+						break;
+					case PNTessellationTable::SLOT_EDGE:
+					{
+						// Edge k of the face runs from corner k, its owner half-edge may run the other way
+						const uint32_t h = uint32_t(f * 3 + index / n);
+						const uint32_t along = edgeOwners[edgeIds[h]] == h ? index % n : n - index % n;
+						pointVertices[point] = uint32_t(edgeBase + size_t(edgeIds[h]) * (n - 1) + along - 1);
+						break;
+					}
+					default:
+						pointVertices[point] = uint32_t(interiorBase + f * interiorCount + index);
+						break;
+					}
+				}
+
+				uint32_t* outIndices = outMesh->indices.data() + f * table.triangles.size();
+				for (size_t i = 0; i < table.triangles.size(); i++)
+					outIndices[i] = pointVertices[table.triangles[i]];
+			}
+		});
+
+		GenerateHalfEdgeData(outMesh);
+		GenerateAdjacencyIndices(outMesh);
+
+		// The patches bulge past the flat triangles
+		ComputeBounds(outMesh);
+
+		// Subdivided levels are drawn at the same scene nodes
+		outMesh->instanceTransforms = inMesh->instanceTransforms;
+
 		return true;
 	}
 
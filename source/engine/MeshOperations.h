@@ -20,6 +20,41 @@ namespace croissant
 		glm::vec3 normal;
 	};
 
+	// Up to four bone influences per vertex, weights quantised to 8 bits and summing to 255
+	struct VertexSkin
+	{
+		uint16_t bones[4];
+		uint8_t  weights[4];
+	};
+
+	struct Bone
+	{
+		std::string name;
+		glm::mat4   offsetMatrix;	// Mesh space to bone space (inverse bind pose)
+	};
+
+	// Element ranges edited on the CPU since the last upload, kept sorted and merged
+	class DirtyRanges
+	{
+	public:
+		struct Range
+		{
+			uint32_t begin, end;
+		};
+
+		void Add(uint32_t begin, uint32_t end);
+
+		// Merges ranges separated by at most gap elements, trading a few redundant bytes for fewer copies
+		void Coalesce(uint32_t gap);
+
+		bool Empty() const { return m_Ranges.empty(); }
+		void Clear() { m_Ranges.clear(); }
+		const std::vector<Range>& GetRanges() const { return m_Ranges; }
+
+	private:
+		std::vector<Range> m_Ranges;
+	};
+
 	struct HalfEdge; // Forward declaration
 
 	struct Face
@@ -87,13 +122,49 @@ namespace croissant
 	};
 
 
+	// Entries of Mesh::faceNeighbours: the face across a triangle edge in the low bits, edge flags in the top two
+	constexpr uint32_t NEIGHBOUR_FACE_MASK = 0x3FFFFFFF;	// All set when there is no neighbour
+	constexpr uint32_t NEIGHBOUR_SHARP = 1u << 30;			// Faces meet at more than the sharp angle
+	constexpr uint32_t NEIGHBOUR_BOUNDARY = 1u << 31;		// Open or non-manifold edge
+
+	// Separates the strips of Mesh::stripIndices, the D3D12 strip cut value for 32-bit indices
+	constexpr uint32_t STRIP_RESTART_INDEX = 0xFFFFFFFF;
+
+	// Static feature edges of a mesh for line rendering, as half-edge indices (face * 3 + k, the edge from corner k
+	// to corner k + 1 of face f), one half-edge per edge. See MeshOperations::UpdateFeatureEdges
+	struct FeatureEdges
+	{
+		std::vector<uint32_t> creases;		// Dihedral angle above creaseAngleDegrees
+		std::vector<uint32_t> boundaries;	// Open or non-manifold edges
+		float creaseAngleDegrees = 0.0f;
+		uint32_t topologyVersion = INVALID;	// Mesh::topologyVersion these were built from, INVALID until built
+	};
+
 	struct Mesh
 	{
 		std::vector<Vertex>       vertices;
 		std::vector<uint32_t>     indices;
 		std::vector<uint32_t>	  adjacencyIndices;
+		std::vector<uint32_t>	  faceNeighbours;	// Optional, 3 per face, see MeshOperations::GenerateFaceNeighbours
+		std::vector<uint32_t>	  stripIndices;		// Optional, the triangles as strips, see MeshOperations::GenerateTriangleStrips
+		std::vector<uint32_t>	  tangentFrames;	// Optional, one packed quaternion per vertex, see MeshOperations::ComputeTangentFrames
+		std::vector<uint8_t>	  ambientOcclusion;	// Optional, unorm8 per vertex with 255 unoccluded, see AOBaker
 		std::vector<HalfEdge>     halfEdges;
 		std::vector<Face>         faces;
+		std::vector<uint32_t>     vertexHalfEdges;	// One outgoing half-edge per vertex, a boundary one if it has any. INVALID when unreferenced
+		uint32_t                  topologyVersion = 0;	// Bumped by GenerateHalfEdgeData, caches derived from the connectivity compare against it
+		FeatureEdges              featureEdges;		// Optional, see MeshOperations::UpdateFeatureEdges
+
+		// World transforms of every scene node referencing this mesh, one instance each
+		std::vector<glm::mat4>    instanceTransforms;
+
+		// CPU edits not yet uploaded, consumed by Geometry::Update
+		DirtyRanges dirtyVertices;
+		DirtyRanges dirtyIndices;
+
+		// Skinning data, empty for static meshes. One VertexSkin per vertex
+		std::vector<VertexSkin>   skin;
+		std::vector<Bone>         bones;
 
 		glm::vec3 minBounds = glm::vec3(0.0f);
 		glm::vec3 maxBounds = glm::vec3(0.0f);
@@ -104,6 +175,80 @@ namespace croissant
 		}
 	};
 
+	// Range over the one-ring of a vertex, built on Mesh::vertexHalfEdges and triangle faces.
+	// Neighbours are visited by rotating through the fan. A boundary vertex starts at its open edge, so the walk
+	// covers its whole fan and ends with the neighbour across the other open edge. Non-manifold vertices only
+	// yield the fan containing their stored half-edge
+	class VertexRing
+	{
+	public:
+		class Iterator
+		{
+		public:
+			Iterator(const std::vector<HalfEdge>* halfEdges, uint32_t start) : m_HalfEdges(halfEdges), m_Start(start), m_Current(start) {}
+
+			uint32_t operator*() const { return m_Current != INVALID ? (*m_HalfEdges)[m_Current].vert : m_Tail; }
+
+			// Outgoing half-edge towards the current neighbour, INVALID for the last neighbour of a boundary vertex
+			uint32_t GetHalfEdge() const { return m_Current; }
+
+			Iterator& operator++()
+			{
+				if (m_Current == INVALID)
+				{
+					m_Tail = INVALID;
+					return *this;
+				}
+
+				// Triangles: prev is next of next. The twin of the incoming prev is the next outgoing half-edge
+				const HalfEdge& current = (*m_HalfEdges)[m_Current];
+				const uint32_t prev = (*m_HalfEdges)[current.next].next;
+				const uint32_t twin = (*m_HalfEdges)[prev].twin;
+				if (twin == INVALID)
+				{
+					m_Tail = (*m_HalfEdges)[current.next].vert;
+					m_Current = INVALID;
+				}
+				else
+				{
+					m_Current = twin == m_Start ? INVALID : twin;
+				}
+				return *this;
+			}
+
+			bool operator!=(const Iterator& other) const { return m_Current != other.m_Current || m_Tail != other.m_Tail; }
+
+		private:
+			const std::vector<HalfEdge>* m_HalfEdges;
+			uint32_t m_Start;
+			uint32_t m_Current;
+			uint32_t m_Tail = INVALID;	// Last neighbour of a boundary vertex, reached after the fan
+		};
+
+		VertexRing(const Mesh& mesh, uint32_t vertex) : m_HalfEdges(&mesh.halfEdges), m_Start(mesh.vertexHalfEdges[vertex]) {}
+
+		Iterator begin() const { return Iterator(m_HalfEdges, m_Start); }
+		Iterator end() const { return Iterator(m_HalfEdges, INVALID); }
+
+	private:
+		const std::vector<HalfEdge>* m_HalfEdges;
+		uint32_t m_Start;
+	};
+
+	// How face normals are weighted when accumulated into vertex normals
+	enum class NormalWeighting
+	{
+		Area,	// By face area, favours large faces
+		Angle,	// By the corner angle at the vertex, independent of how the surface is triangulated
+	};
+
+	// How subdivision levels refine the base mesh
+	enum class SubdivisionScheme
+	{
+		Planar,		// Midpoints on the flat triangles, the shape never changes
+		PNTriangle,	// Points on the curved point-normal patch of each base triangle
+	};
+
 	class MeshOperations
 	{
 	public:
@@ -115,6 +260,52 @@ namespace croissant
 		static void ProcessEdge(Mesh* outMesh, std::unordered_map<EdgeKey, EdgeInfo, EdgeKeyHash>& edgeMap, uint32_t fromVert, uint32_t toVert, uint32_t halfEdgeIdx);
 		static bool PlanarSubdivide(const Mesh* inMesh, Mesh* outMesh);
 
+		// Curved alternative to PlanarSubdivide after Vlachos et al., "Curved PN Triangles": every triangle of inMesh
+		// becomes the 4^level triangles of its cubic Bezier patch, built from the corner positions and normals, with
+		// quadratically interpolated normals. Levels are evaluated from inMesh directly through a table of Bernstein
+		// weights over the lattice, so they do not compound. Points on an edge depend only on its two vertices and are
+		// shared, so the result is as watertight as inMesh. Needs half-edge data
+		static constexpr uint32_t MAX_PN_TRIANGLE_LEVEL = 12;
+		static bool PNTriangleSubdivide(const Mesh* inMesh, Mesh* outMesh, uint32_t level);
+
+		// Compact alternative to the adjacency index buffer for compute passes, half its size. Entry k of a face is the
+		// face across its edge (v_k, v_k+1), read from the half-edge twins and packed with the NEIGHBOUR_* flags.
+		// Edges whose face normals differ by more than sharpAngleDegrees are flagged sharp. Needs half-edge data
+		static bool GenerateFaceNeighbours(Mesh* mesh, float sharpAngleDegrees = 180.0f);
+
+		// CPU reference for consumers of faceNeighbours: appends the silhouette edges (face * 3 + k) seen from
+		// viewPosition, those between a face facing the viewer and a neighbour facing away or missing
+		static void FindSilhouetteEdges(const Mesh* mesh, const glm::vec3& viewPosition, std::vector<uint32_t>& outEdges);
+
+		// Extracts the crease and boundary edges into featureEdges, once per topology: nothing is done while
+		// topologyVersion and the angle match the last build, so it is cheap to call every time a level is used.
+		// Dihedral angles come from the current positions; reset featureEdges.topologyVersion to pick up moved
+		// vertices. Needs half-edge data
+		static bool UpdateFeatureEdges(Mesh* mesh, float creaseAngleDegrees = 30.0f);
+
+		// Appends the feature edges as vertex index pairs for a line list, creases first then boundaries
+		static void GetFeatureEdgeLines(const Mesh* mesh, std::vector<uint32_t>& outIndices);
+
+		// Fills stripIndices with the triangles as strips separated by STRIP_RESTART_INDEX, an alternative to the
+		// triangle list for PrimitiveType::TriangleStrip. Strips grow greedily across half-edge twins from every face not
+		// yet covered, trying its three edges and keeping the longest. Winding is kept, so strips only cross edges of
+		// consistently oriented faces. Needs half-edge data
+		static bool GenerateTriangleStrips(Mesh* mesh);
+
+		// Recomputes minBounds/maxBounds from the vertex positions, in parallel for large meshes
+		static void ComputeBounds(Mesh* mesh);
+
+		// Recomputes vertex normals from the triangles, in parallel. Face normals are computed first, then every vertex
+		// gathers the faces of its one-ring, so no two threads write the same vertex. Needs half-edge data; meshes
+		// without it fall back to a single-threaded scatter, as do vertices whose ring misses some of their faces
+		// (non-manifold or inconsistently wound). Vertices with no area keep their previous normal
+		static void ComputeNormals(Mesh* mesh, NormalWeighting weighting = NormalWeighting::Area);
+
+		// Fills tangentFrames from the UV gradients, in parallel the same way as ComputeNormals. Each vertex gets its
+		// normal, tangent and bitangent as one quaternion in 4 snorm8 components, handedness in the sign of w
+		// (decode with shaders/common/qtangent.hlsli). Uses the current normals, so run it after ComputeNormals
+		static void ComputeTangentFrames(Mesh* mesh);
+
 		/// <summary>
 		/// Generates a perfect squared number of triangles by subdividing each triangle based on LOD level squared.
 		/// level 1 = 1 triangle
@@ -4,6 +4,13 @@
 #include <map>
 #include <set>
 #include <render/Application.h>
+#include <engine/GLTFLoader.h>
+#include <engine/OBJLoader.h>
+#include <engine/PLYLoader.h>
+#include <engine/MeshCodec.h>
+#include <engine/Skinning.h>
+#include <engine/Animation.h>
+#include <utils/string_utils.h>
 
 
 namespace croissant
@@ -12,6 +19,17 @@ namespace croissant
 	{
 		LoadModel(filename);
 	}
+	ModelLoader::ModelLoader(const char* filename, glm::mat4 modelTransform, std::shared_ptr<vfs::IFileSystem> fs) : m_MatModel(modelTransform)
+	{
+		if (fs)
+		{
+			m_FileSystem = fs;
+			m_IOSystem = new VFSIOSystem(std::move(fs));
+			m_Importer.SetIOHandler(m_IOSystem);
+		}
+
+		LoadModel(filename);
+	}
 	ModelLoader::~ModelLoader()
 	{
 		// Cleanup if necessary
@@ -19,30 +37,139 @@ namespace croissant
 
 	void ModelLoader::LoadModel(const char* filename)
 	{
-		m_Scene = m_Importer.ReadFile(filename,
-			aiProcess_ConvertToLeftHanded	|
-			aiProcess_CalcTangentSpace		|
-			aiProcess_JoinIdenticalVertices |
-			aiProcess_OptimizeMeshes		| 
-			aiProcess_OptimizeGraph			|
-			aiProcess_Triangulate			|
-			aiProcess_GenBoundingBoxes );
+		auto startTime = std::chrono::high_resolution_clock::now();
+		const char* loaderName = "Assimp";
+		m_Filename = filename;
+
+		// Binary glTF, OBJ, PLY and compressed meshes have native loaders, only fall back to Assimp for features they do not handle
+		std::string extension = std::filesystem::path(filename).extension().string();
+		string_utils::tolower(extension);
+
+		if ((extension == ".glb" || extension == ".obj" || extension == ".ply" || extension == ".csmesh") && LoadModelNative(filename, extension))
+		{
+			loaderName = extension == ".glb" ? "glTF fast path" : extension == ".obj" ? "parallel OBJ" : extension == ".ply" ? "mapped PLY" : "compressed mesh";
+		}
+		else if (!LoadModelAssimp(filename))
+		{
+			isLoaded = false;
+			return;
+		}
+
+		if (!defaultMesh)
+		{
+			logger::error("%s has no triangles; point clouds and line sets are not supported.", filename);
+			isLoaded = false;
+			return;
+		}
+
+		double loadTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+		logger::info("Loaded %s in %.2f ms (%s): %d unique meshes drawn as %d instances.", filename, loadTimeMs, loaderName,
+			defaultMesh ? int(instancedMeshes.size()) + 1 : 0, m_InstanceCount);
+
+		isLoaded = true;
+
+		GenerateSubdividedMeshes(MAX_SUBDIVISION_LEVELS);
+
+	//	Mesh0 = subdividedMeshes.empty() ? defaultMesh.get() : subdividedMeshes[4].get();
+	}
+
+	bool ModelLoader::LoadModelAssimp(const char* filename)
+	{
+		m_Scene = m_Importer.ReadFile(filename, AssimpImportFlags);
 	
 		if (!m_Scene || m_Scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !m_Scene->mRootNode)
 		{
 			logger::error("Assimp error: %s", m_Importer.GetErrorString());
-			isLoaded = false;
+			return false;
 		}
 
-		isLoaded = true;
+		if (m_IOSystem)
+		{
+			logger::info("Read %zu bytes from %u files through the VFS.", m_IOSystem->GetBytesRead(), m_IOSystem->GetFilesOpened());
+		}
 
 		LoadTextures(m_Scene);
 		LoadMeshes(m_Scene);
 		LoadMaterials(m_Scene);
-		
-		GenerateSubdividedMeshes(MAX_SUBDIVISION_LEVELS);
+		LoadAnimations(m_Scene);
 
-	//	Mesh0 = subdividedMeshes.empty() ? defaultMesh.get() : subdividedMeshes[4].get();
+		return true;
+	}
+
+	bool ModelLoader::LoadModelNative(const char* filename, const std::string& extension)
+	{
+		std::shared_ptr<vfs::IFileSystem> fs = m_FileSystem ? m_FileSystem : std::make_shared<vfs::NativeFileSystem>();
+
+		std::vector<std::unique_ptr<Mesh>> meshes;
+		bool loaded = false;
+		if (extension == ".glb")
+			loaded = GLTFLoader::LoadGLB(*fs, filename, meshes);
+		else if (extension == ".obj")
+			loaded = OBJLoader::LoadOBJ(*fs, filename, meshes);
+		else if (extension == ".ply")
+			loaded = PLYLoader::LoadPLY(*fs, filename, meshes);
+		else if (extension == ".csmesh")
+		{
+			auto mesh = std::make_unique<Mesh>();
+			loaded = MeshCodec::Read(*fs, filename, *mesh);
+			if (loaded)
+			{
+				mesh->instanceTransforms.push_back(glm::mat4(1.0f));
+				meshes.push_back(std::move(mesh));
+			}
+		}
+
+		if (!loaded)
+		{
+			logger::info("%s is not supported by the native %s loader, falling back to Assimp.", filename, extension.c_str());
+			return false;
+		}
+
+		for (auto& mesh : meshes)
+		{
+			AddUniqueMesh(std::move(mesh));
+		}
+
+		Mesh0 = defaultMesh.get();
+		return true;
+	}
+
+	void ModelLoader::AddUniqueMesh(std::unique_ptr<Mesh> theMesh)
+	{
+		// Points and lines have nothing to draw or subdivide, and would reach the GPU as empty index buffers
+		if (theMesh->indices.empty())
+		{
+			logger::warning("Skipping a mesh without triangles (%zu vertices).", theMesh->vertices.size());
+			return;
+		}
+
+		GenerateTopology(theMesh.get());
+
+		// Accumulate world bounds from the transformed corners of the local box
+		for (const glm::mat4& transform : theMesh->instanceTransforms)
+		{
+			for (int corner = 0; corner < 8; corner++)
+			{
+				glm::vec3 local(
+					(corner & 1) ? theMesh->maxBounds.x : theMesh->minBounds.x,
+					(corner & 2) ? theMesh->maxBounds.y : theMesh->minBounds.y,
+					(corner & 4) ? theMesh->maxBounds.z : theMesh->minBounds.z);
+				glm::vec3 world = glm::vec3(transform * glm::vec4(local, 1.0f));
+
+				sceneMinBounds = m_InstanceCount == 0 ? world : glm::min(sceneMinBounds, world);
+				sceneMaxBounds = m_InstanceCount == 0 ? world : glm::max(sceneMaxBounds, world);
+			}
+			m_InstanceCount++;
+		}
+
+		if (!defaultMesh)
+		{
+			defaultMesh = std::move(theMesh);
+		}
+		else
+		{
+			instancedMeshes.push_back(std::move(theMesh));
+		}
 	}
 	void ModelLoader::LoadTextures(const aiScene* scene)
 	{
@@ -65,79 +192,156 @@ namespace croissant
 			}
 		}
 	}
-	void ModelLoader::LoadMeshes(const aiScene* scene)
+	static glm::mat4 ToGlmMatrix(const aiMatrix4x4& m)
+	{
+		// Assimp matrices are row-major, glm is column-major
+		return glm::mat4(
+			glm::vec4(m.a1, m.b1, m.c1, m.d1),
+			glm::vec4(m.a2, m.b2, m.c2, m.d2),
+			glm::vec4(m.a3, m.b3, m.c3, m.d3),
+			glm::vec4(m.a4, m.b4, m.c4, m.d4));
+	}
+
+	void ModelLoader::CollectMeshInstances(const aiNode* node, const glm::mat4& parentTransform, std::vector<std::vector<glm::mat4>>& meshInstances)
+	{
+		glm::mat4 nodeTransform = parentTransform * ToGlmMatrix(node->mTransformation);
+
+		for (unsigned int i = 0; i < node->mNumMeshes; i++)
+		{
+			meshInstances[node->mMeshes[i]].push_back(nodeTransform);
+		}
+
+		for (unsigned int i = 0; i < node->mNumChildren; i++)
+		{
+			CollectMeshInstances(node->mChildren[i], nodeTransform, meshInstances);
+		}
+	}
+
+	std::unique_ptr<Mesh> ModelLoader::ConvertMesh(const aiMesh* mesh)
 	{
 		std::unique_ptr<Mesh> theMesh = std::make_unique<Mesh>();
+		theMesh->vertices.reserve(mesh->mNumVertices);
+		theMesh->indices.reserve(size_t(mesh->mNumFaces) * 3);
 
-		// Iterate through all meshes in the scene
-		for (unsigned int i = 0; i < 1; i++)
+		// Process vertices, indices, and other mesh data
+		for (unsigned int j = 0; j < mesh->mNumVertices; j++)
 		{
-			aiMesh* mesh = scene->mMeshes[i];
-		
-			// Process vertices, indices, and other mesh data
-			for (unsigned int j = 0; j < mesh->mNumVertices; j++)
+			glm::vec3  positions	= glm::vec3(0.0f);
+			glm::vec2  uvs			= glm::vec2(0.0f);
+			glm::vec3  normals		= glm::vec3(0.0f);
+
+			//Check if vertex positions are available then extract
+			if (mesh->HasPositions())
 			{
-				glm::vec3  positions	= glm::vec3(0.0f);
-				glm::vec2  uvs			= glm::vec2(0.0f);
-				glm::vec3  normals		= glm::vec3(0.0f);
+				positions.x = (float)mesh->mVertices[j].x;
+				positions.y = (float)mesh->mVertices[j].y;
+				positions.z = (float)mesh->mVertices[j].z;
 
-				//Check if vertex positions are available then extract
-				if (mesh->HasPositions())
-				{
-					positions.x = (float)mesh->mVertices[j].x;
-					positions.y = (float)mesh->mVertices[j].y;
-					positions.z = (float)mesh->mVertices[j].z;
+			}
 
-				}
+			//Check if texture coordinates are available then extract
+			if (mesh->HasTextureCoords(0))
+			{
+				uvs = glm::vec2(mesh->mTextureCoords[0][j].x, mesh->mTextureCoords[0][j].y);
+			}
 
-				//Check if texture coordinates are available then extract
-				if (mesh->HasTextureCoords(0))
-				{
-					uvs = glm::vec2(mesh->mTextureCoords[0][j].x, mesh->mTextureCoords[0][j].y);
-				}
+			//Check if normals are available then extract
+			if (mesh->HasNormals())
+			{
+				normals.x = (float)mesh->mNormals[j].x;
+				normals.y = (float)mesh->mNormals[j].y;
+				normals.z = (float)mesh->mNormals[j].z;
+			}
 
-				//Check if normals are available then extract
-				if (mesh->HasNormals())
-				{
-					normals.x = (float)mesh->mNormals[j].x;
-					normals.y = (float)mesh->mNormals[j].y;
-					normals.z = (float)mesh->mNormals[j].z;
-				}
+			theMesh->vertices.emplace_back(Vertex{ positions, uvs, normals });
+		}
 
-				theMesh->vertices.emplace_back(Vertex{ positions, uvs, normals });
+		for (unsigned int j = 0; j < mesh->mNumFaces; j++)
+		{
+			const aiFace& face = mesh->mFaces[j];
+			if (face.mNumIndices != 3)
+			{
+				continue; // Points and lines are left as they are by aiProcess_Triangulate
 			}
 
-			for (unsigned int j = 0; j < mesh->mNumFaces; j++)
+			for (int k = 0; k < face.mNumIndices; k++)
 			{
-				const aiFace& face = mesh->mFaces[j];
-				assert(face.mNumIndices == 3); // Ensure the face is a triangle
+				theMesh->indices.push_back(face.mIndices[k]);
+			}
+		}
 
-				for (int k = 0; k < face.mNumIndices; k++)
-				{
-					theMesh->indices.push_back(face.mIndices[k]);
-				}
+		if (mesh->HasBones())
+		{
+			ConvertBones(mesh, theMesh.get());
+		}
+
+		theMesh->maxBounds = glm::vec3(mesh->mAABB.mMax.x, mesh->mAABB.mMax.y, mesh->mAABB.mMax.z);
+		theMesh->minBounds = glm::vec3(mesh->mAABB.mMin.x, mesh->mAABB.mMin.y, mesh->mAABB.mMin.z);
+
+		return theMesh;
+	}
+
+	void ModelLoader::ConvertBones(const aiMesh* mesh, Mesh* theMesh)
+	{
+		if (mesh->mNumBones >= 0xFFFF)
+		{
+			logger::warning("Mesh %s has %u bones, skinning supports at most 65534.", mesh->mName.C_Str(), mesh->mNumBones);
+			return;
+		}
+
+		// Gather every influence per vertex before packing, Assimp stores them per bone
+		std::vector<std::vector<std::pair<uint32_t, float>>> influences(mesh->mNumVertices);
+		theMesh->bones.reserve(mesh->mNumBones);
+
+		for (unsigned int b = 0; b < mesh->mNumBones; b++)
+		{
+			const aiBone* bone = mesh->mBones[b];
+			theMesh->bones.push_back(Bone{ bone->mName.C_Str(), ToGlmMatrix(bone->mOffsetMatrix) });
+
+			for (unsigned int w = 0; w < bone->mNumWeights; w++)
+			{
+				const aiVertexWeight& weight = bone->mWeights[w];
+				if (weight.mVertexId < mesh->mNumVertices)
+					influences[weight.mVertexId].emplace_back(b, weight.mWeight);
 			}
+		}
 
-			theMesh->maxBounds = glm::vec3(mesh->mAABB.mMax.x, mesh->mAABB.mMax.y, mesh->mAABB.mMax.z);
-			theMesh->minBounds = glm::vec3(mesh->mAABB.mMin.x, mesh->mAABB.mMin.y, mesh->mAABB.mMin.z);
+		theMesh->skin.resize(mesh->mNumVertices);
+		std::vector<uint32_t> bones;
+		std::vector<float> weights;
+		for (unsigned int v = 0; v < mesh->mNumVertices; v++)
+		{
+			bones.clear();
+			weights.clear();
+			for (const auto& [bone, weight] : influences[v])
+			{
+				bones.push_back(bone);
+				weights.push_back(weight);
+			}
+			theMesh->skin[v] = SkinningEngine::PackInfluences(bones.data(), weights.data(), uint32_t(bones.size()), uint16_t(mesh->mNumBones));
 		}
 
-		if (MeshOperations::GenerateHalfEdgeData(theMesh.get()))
+		logger::info("Imported %u bones for mesh %s.", mesh->mNumBones, mesh->mName.C_Str());
+	}
+
+	void ModelLoader::GenerateTopology(Mesh* mesh)
+	{
+		if (MeshOperations::GenerateHalfEdgeData(mesh))
 		{
 			logger::info("half-edge data generated successfully.");
-			logger::info("expected half-edges: %d", theMesh->indices.size());
-			logger::info("generated half-edges: %d", theMesh->halfEdges.size());
-			logger::info("generated faces: %d", theMesh->faces.size());
+			logger::info("expected half-edges: %d", mesh->indices.size());
+			logger::info("generated half-edges: %d", mesh->halfEdges.size());
+			logger::info("generated faces: %d", mesh->faces.size());
 
 			// Verify first face
-			if(!theMesh->faces.empty())
+			if(!mesh->faces.empty())
 			{
-				const Face& firstFace = theMesh->faces[0];
+				const Face& firstFace = mesh->faces[0];
 				logger::info("First face half-edges:");
 				for (size_t h = 0; h < firstFace.halfEdges.size(); ++h)
 				{
 					uint32_t heIdx = firstFace.halfEdges[h];
-					const HalfEdge& he = theMesh->halfEdges[heIdx];
+					const HalfEdge& he = mesh->halfEdges[heIdx];
 					logger::info("  Half-edge %d: vert=%d, twin=%d, next=%d, face=%d", heIdx, he.vert, he.twin, he.next, he.face);
 				}
 			}
@@ -147,7 +351,7 @@ namespace croissant
 			logger::warning("Failed to generate half-edge data.");
 		}
 
-		if (MeshOperations::GenerateAdjacencyIndices(theMesh.get()))
+		if (MeshOperations::GenerateAdjacencyIndices(mesh))
 		{
 			logger::info("Adjacency indices generated successfully.");
 		}
@@ -156,7 +360,33 @@ namespace croissant
 			logger::warning("Failed to generate adjacency indices.");
 		}
 
-		defaultMesh = std::move(theMesh);
+		if (MeshOperations::UpdateFeatureEdges(mesh))
+		{
+			logger::info("Feature edges: %zu creases, %zu boundary edges.", mesh->featureEdges.creases.size(), mesh->featureEdges.boundaries.size());
+		}
+
+		// Replaces Assimp's CalcTangentSpace, from the imported normals
+		MeshOperations::ComputeTangentFrames(mesh);
+	}
+
+	void ModelLoader::LoadMeshes(const aiScene* scene)
+	{
+		// Gather every node reference per aiMesh, so repeated meshes are converted once and drawn instanced
+		std::vector<std::vector<glm::mat4>> meshInstances(scene->mNumMeshes);
+		CollectMeshInstances(scene->mRootNode, glm::mat4(1.0f), meshInstances);
+
+		for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+		{
+			if (meshInstances[i].empty())
+			{
+				continue; // Not referenced by any node
+			}
+
+			std::unique_ptr<Mesh> theMesh = ConvertMesh(scene->mMeshes[i]);
+			theMesh->instanceTransforms = std::move(meshInstances[i]);
+			AddUniqueMesh(std::move(theMesh));
+		}
+
 		Mesh0 = defaultMesh.get();
 	}
 	void ModelLoader::LoadMaterials(const aiScene* scene)
@@ -168,21 +398,113 @@ namespace croissant
 			// Process material properties, textures, etc.
 		}
 	}
-	bool ModelLoader::GenerateSubdividedMeshes(int levels)
+	void ModelLoader::LoadAnimations(const aiScene* scene)
+	{
+		for (unsigned int i = 0; i < scene->mNumAnimations; i++)
+		{
+			std::unique_ptr<AnimationClip> clip = AnimationClip::FromAssimp(scene->mAnimations[i], AnimationClip::Tolerances());
+			logger::info("Animation %s: %u tracks, %u keys, %.2fs, compressed %zu -> %zu bytes (%.1fx).", clip->GetName().c_str(),
+				clip->GetTrackCount(), clip->GetKeyCount(), clip->GetDuration(), clip->GetSourceSize(), clip->GetCompressedSize(),
+				double(clip->GetSourceSize()) / double(std::max<size_t>(clip->GetCompressedSize(), 1)));
+			animations.push_back(std::move(clip));
+		}
+	}
+	bool ModelLoader::BakeAmbientOcclusion(const AOBakeSettings& settings)
+	{
+		std::shared_ptr<vfs::IFileSystem> fs = m_FileSystem ? m_FileSystem : std::make_shared<vfs::NativeFileSystem>();
+
+		// Each mesh and subdivision level has its own cache file, so levels do not overwrite each other's bakes
+		std::vector<std::pair<Mesh*, std::string>> meshes;
+		if (defaultMesh)
+			meshes.emplace_back(defaultMesh.get(), m_Filename + ".0.ao");
+		for (size_t i = 0; i < instancedMeshes.size(); i++)
+			meshes.emplace_back(instancedMeshes[i].get(), m_Filename + "." + std::to_string(i + 1) + ".ao");
+		for (size_t i = 0; i < subdividedMeshes.size(); i++)
+			meshes.emplace_back(subdividedMeshes[i].get(), m_Filename + ".level" + std::to_string(i + 1) + ".ao");
+
+		AOBaker baker;
+		uint32_t cached = 0;
+		uint64_t rays = 0;
+		double seconds = 0.0;
+		bool succeeded = true;
+		for (const auto& [mesh, path] : meshes)
+		{
+			if (!baker.LoadOrBake(*fs, path, mesh, settings))
+			{
+				succeeded = false;
+				continue;
+			}
+
+			const AOBaker::Stats& stats = baker.GetLastStats();
+			cached += stats.fromCache ? 1 : 0;
+			rays += stats.rays;
+			seconds += stats.bakeSeconds;
+		}
+
+		logger::info("Ambient occlusion for %zu meshes, %u from the cache: %llu rays at %.2f Mrays/s.", meshes.size(), cached,
+			(unsigned long long)rays, seconds > 0.0 ? double(rays) / seconds / 1e6 : 0.0);
+		return succeeded;
+	}
+
+	bool ModelLoader::GenerateTriangleStrips()
+	{
+		std::vector<std::pair<Mesh*, std::string>> meshes;
+		if (defaultMesh)
+			meshes.emplace_back(defaultMesh.get(), "Default mesh");
+		for (size_t i = 0; i < instancedMeshes.size(); i++)
+			meshes.emplace_back(instancedMeshes[i].get(), "Mesh " + std::to_string(i + 1));
+		for (size_t i = 0; i < subdividedMeshes.size(); i++)
+			meshes.emplace_back(subdividedMeshes[i].get(), "Subdivision level " + std::to_string(i + 1));
+
+		bool succeeded = true;
+		for (const auto& [mesh, name] : meshes)
+		{
+			auto startTime = std::chrono::high_resolution_clock::now();
+			if (!MeshOperations::GenerateTriangleStrips(mesh))
+			{
+				succeeded = false;
+				continue;
+			}
+			const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+			logger::info("%s strips: %zu indices for %zu triangles, %.1f%% of the list, in %.2f ms.", name.c_str(), mesh->stripIndices.size(),
+				mesh->indices.size() / 3, 100.0 * double(mesh->stripIndices.size()) / double(mesh->indices.size()), seconds * 1000.0);
+		}
+		return succeeded;
+	}
+
+	bool ModelLoader::GenerateSubdividedMeshes(int levels, SubdivisionScheme scheme)
 	{
 		if(!Mesh0)
 		{
 			logger::warning("No base mesh available for subdivision.");
 			return false;
 		}
+		for (const std::unique_ptr<Mesh>& level : subdividedMeshes)
+		{
+			if (level.get() == Mesh0)
+			{
+				logger::warning("Cannot subdivide from a subdivision level.");
+				return false;
+			}
+		}
+		subdividedMeshes.clear();
 
 		Mesh* firstLevel = Mesh0;
 		for (int i = 0; i < levels; i++)
 		{
 			std::unique_ptr<Mesh> subdividedMesh = std::make_unique<Mesh>();
-			if (MeshOperations::PlanarSubdivide(firstLevel, subdividedMesh.get()))
+			const bool subdivided = scheme == SubdivisionScheme::PNTriangle
+				? MeshOperations::PNTriangleSubdivide(Mesh0, subdividedMesh.get(), uint32_t(i + 1))
+				: MeshOperations::PlanarSubdivide(firstLevel, subdividedMesh.get());
+			if (subdivided)
 			{
 				logger::info("Subdivision level %d generated successfully.", i + 1);
+				// PN levels already carry the quadratic normals of their patches, recomputing would facet them again
+				if (scheme != SubdivisionScheme::PNTriangle)
+					MeshOperations::ComputeNormals(subdividedMesh.get());
+				MeshOperations::UpdateFeatureEdges(subdividedMesh.get());
+				MeshOperations::ComputeTangentFrames(subdividedMesh.get());
 				subdividedMeshes.push_back(std::move(subdividedMesh));
 			}
 			else
@@ -13,6 +13,10 @@
 #include <unordered_map>
 #include <algorithm>
 #include <engine/MeshOperations.h>
+#include <engine/AssimpIOSystem.h>
+#include <engine/Animation.h>
+#include <engine/AOBaker.h>
+#include <core/VFS.h>
 
 
 constexpr int MAX_SUBDIVISION_LEVELS = 5;
@@ -24,25 +28,67 @@ namespace croissant
 	{
 	public:
 		ModelLoader(const char* filename, glm::mat4 modelTranform);
+
+		// Loads the model and every file it references through the given file system instead of the OS
+		ModelLoader(const char* filename, glm::mat4 modelTranform, std::shared_ptr<vfs::IFileSystem> fs);
 		~ModelLoader();
 
 		glm::mat4 m_MatModel = glm::mat4(1.0f); // Model matrix for transformations
 
+		// Fills ambientOcclusion of defaultMesh, every instanced mesh and every subdivision level, each occluded by itself
+		// only. Results are cached next to the model as <model>.<mesh>.ao and <model>.level<n>.ao and rebaked when the
+		// mesh or the settings change. GenerateSubdividedMeshes drops the levels' AO, call this again after it
+		bool BakeAmbientOcclusion(const AOBakeSettings& settings = AOBakeSettings());
+
+		// Fills stripIndices of defaultMesh, every instanced mesh and every subdivision level, for memory-constrained
+		// targets that draw strips instead of lists. Logs the index count against the list for each
+		bool GenerateTriangleStrips();
+
+		// Replaces subdividedMeshes with levels refinements of Mesh0, which must not be one of them. Loading builds
+		// MAX_SUBDIVISION_LEVELS planar levels; call again to switch scheme
+		bool GenerateSubdividedMeshes(int levels, SubdivisionScheme scheme = SubdivisionScheme::Planar);
+
+		static constexpr unsigned int AssimpImportFlags =
+			aiProcess_ConvertToLeftHanded	|
+			aiProcess_JoinIdenticalVertices |
+			aiProcess_OptimizeMeshes		|
+			aiProcess_Triangulate			|
+			aiProcess_LimitBoneWeights		|
+			aiProcess_GenBoundingBoxes;
+
 	private:
 		Assimp::Importer m_Importer;
 		const aiScene* m_Scene = nullptr;
+		VFSIOSystem* m_IOSystem = nullptr; // Owned by m_Importer
+		std::shared_ptr<vfs::IFileSystem> m_FileSystem;
+		std::string m_Filename;
+		uint32_t m_InstanceCount = 0;
 		void LoadModel(const char* filename);
+		bool LoadModelAssimp(const char* filename);
+		bool LoadModelNative(const char* filename, const std::string& extension);
 		void LoadTextures(const aiScene* scene);
 		void LoadMeshes(const aiScene* scene);
 		void LoadMaterials(const aiScene* scene);
-		bool GenerateSubdividedMeshes(int levels);
+		void LoadAnimations(const aiScene* scene);
+
+		void CollectMeshInstances(const aiNode* node, const glm::mat4& parentTransform, std::vector<std::vector<glm::mat4>>& meshInstances);
+		std::unique_ptr<Mesh> ConvertMesh(const aiMesh* mesh);
+		void ConvertBones(const aiMesh* mesh, Mesh* theMesh);
+		void GenerateTopology(Mesh* mesh);
+		void AddUniqueMesh(std::unique_ptr<Mesh> theMesh);
 
 	public:
 
 		Mesh* Mesh0 = nullptr; // Current mesh
 		std::unique_ptr<Mesh> defaultMesh;
 		std::vector<std::unique_ptr<Mesh>> subdividedMeshes;
+		std::vector<std::unique_ptr<Mesh>> instancedMeshes; // Unique meshes other than defaultMesh, each with its own instance list
+		std::vector<std::unique_ptr<AnimationClip>> animations;
 		bool isLoaded = false;
+
+		// Bounds of all instances in world space
+		glm::vec3 sceneMinBounds = glm::vec3(0.0f);
+		glm::vec3 sceneMaxBounds = glm::vec3(0.0f);
 	};
 };
 
@@ -0,0 +1,387 @@
+#include <engine/OBJLoader.h>
+#include <core/Threading.h>
+#include <core/log.h>
+#include <charconv>
+
+namespace croissant
+{
+	namespace
+	{
+		constexpr size_t MIN_CHUNK_BYTES = 1 << 20;
+
+		struct Corner
+		{
+			uint32_t position, uv, normal;
+
+			bool operator==(const Corner& o) const { return position == o.position && uv == o.uv && normal == o.normal; }
+		};
+
+		struct CornerHash
+		{
+			size_t operator()(const Corner& c) const
+			{
+				return size_t((uint64_t(c.position) * 0x9E3779B97F4A7C15ull) ^ (uint64_t(c.uv) * 0xC2B2AE3D27D4EB4Full) ^ (uint64_t(c.normal) << 1));
+			}
+		};
+
+		struct Chunk
+		{
+			const char* begin = nullptr;
+			const char* end = nullptr;
+
+			// Statement counts from the counting pass
+			size_t positions = 0, uvs = 0, normals = 0, triangles = 0;
+
+			// Where this chunk's elements start in the merged arrays (prefix sums of the counts)
+			size_t positionBase = 0, uvBase = 0, normalBase = 0, triangleBase = 0;
+
+			bool valid = true;
+			bool cornersShareIndex = true; // Every corner uses the same index for v, vt and vn
+		};
+
+		struct Totals
+		{
+			size_t positions = 0, uvs = 0, normals = 0, triangles = 0;
+		};
+
+		inline bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+		inline const char* SkipBlanks(const char* p, const char* end)
+		{
+			while (p < end && IsBlank(*p))
+				p++;
+			return p;
+		}
+
+		inline const char* FindLineEnd(const char* p, const char* end)
+		{
+			const char* newline = static_cast<const char*>(memchr(p, '\n', size_t(end - p)));
+			return newline ? newline : end;
+		}
+
+		// Identifies the statement at the start of a line and moves p past its keyword.
+		// Returns 'v', 't' (vt), 'n' (vn), 'f', or 0 for everything this loader skips.
+		inline char Classify(const char*& p, const char* lineEnd)
+		{
+			p = SkipBlanks(p, lineEnd);
+			if (lineEnd - p < 2)
+				return 0;
+
+			if (p[0] == 'v')
+			{
+				if (IsBlank(p[1]))
+				{
+					p += 2;
+					return 'v';
+				}
+				if ((p[1] == 't' || p[1] == 'n') && lineEnd - p >= 3 && IsBlank(p[2]))
+				{
+					char kind = p[1];
+					p += 3;
+					return kind;
+				}
+				return 0;
+			}
+
+			if (p[0] == 'f' && IsBlank(p[1]))
+			{
+				p += 2;
+				return 'f';
+			}
+			return 0;
+		}
+
+		// Parses up to count floats and returns how many were read
+		inline int ParseFloats(const char* p, const char* lineEnd, float* out, int count)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				p = SkipBlanks(p, lineEnd);
+				if (p < lineEnd && *p == '+')
+					p++;
+
+				auto result = std::from_chars(p, lineEnd, out[i]);
+				if (result.ec != std::errc())
+					return i;
+				p = result.ptr;
+			}
+			return count;
+		}
+
+		// Parses one "v", "v/vt", "v//vn" or "v/vt/vn" token; missing fields stay 0
+		inline const char* ParseCorner(const char* p, const char* lineEnd, int64_t (&fields)[3], bool& ok)
+		{
+			fields[0] = fields[1] = fields[2] = 0;
+			for (int f = 0; f < 3 && p < lineEnd && !IsBlank(*p); f++)
+			{
+				if (*p != '/')
+				{
+					auto result = std::from_chars(p, lineEnd, fields[f]);
+					if (result.ec != std::errc())
+					{
+						ok = false;
+						return lineEnd;
+					}
+					p = result.ptr;
+				}
+
+				if (p < lineEnd && *p == '/')
+					p++;
+				else
+					break;
+			}
+
+			while (p < lineEnd && !IsBlank(*p))
+				p++;
+			return p;
+		}
+
+		// OBJ indices are 1-based, negative ones count back from the last element defined so far
+		inline uint32_t ResolveIndex(int64_t index, size_t definedSoFar, size_t total)
+		{
+			int64_t resolved = index > 0 ? index - 1 : int64_t(definedSoFar) + index;
+			return (index != 0 && resolved >= 0 && resolved < int64_t(total)) ? uint32_t(resolved) : INVALID;
+		}
+
+		void CountChunk(Chunk& chunk)
+		{
+			for (const char* p = chunk.begin; p < chunk.end;)
+			{
+				const char* lineEnd = FindLineEnd(p, chunk.end);
+				switch (Classify(p, lineEnd))
+				{
+				case 'v': chunk.positions++; break;
+				case 't': chunk.uvs++; break;
+				case 'n': chunk.normals++; break;
+				case 'f':
+				{
+					size_t corners = 0;
+					for (bool inToken = false; p < lineEnd; p++)
+					{
+						bool blank = IsBlank(*p);
+						corners += (!blank && !inToken);
+						inToken = !blank;
+					}
+					chunk.triangles += corners >= 3 ? corners - 2 : 0;
+					break;
+				}
+				default: break;
+				}
+				p = lineEnd + 1;
+			}
+		}
+
+		// Must visit statements exactly like CountChunk, so each chunk fills precisely the slots it counted
+		void ParseChunk(Chunk& chunk, const Totals& totals, glm::vec3* positions, glm::vec2* uvs, glm::vec3* normals, Corner* corners)
+		{
+			size_t position = chunk.positionBase, uv = chunk.uvBase, normal = chunk.normalBase, corner = chunk.triangleBase * 3;
+			std::vector<Corner> polygon;
+
+			for (const char* p = chunk.begin; p < chunk.end;)
+			{
+				const char* lineEnd = FindLineEnd(p, chunk.end);
+				switch (Classify(p, lineEnd))
+				{
+				case 'v':
+				{
+					// Extra components (w or vertex colours) are ignored
+					float v[3];
+					if (ParseFloats(p, lineEnd, v, 3) != 3)
+					{
+						chunk.valid = false;
+						return;
+					}
+					positions[position++] = glm::vec3(v[0], v[1], -v[2]);
+					break;
+				}
+				case 't':
+				{
+					float t[2] = { 0.0f, 0.0f };
+					if (ParseFloats(p, lineEnd, t, 2) < 1)
+					{
+						chunk.valid = false;
+						return;
+					}
+					// Assimp's ConvertToLeftHanded flips V
+					uvs[uv++] = glm::vec2(t[0], 1.0f - t[1]);
+					break;
+				}
+				case 'n':
+				{
+					float n[3];
+					if (ParseFloats(p, lineEnd, n, 3) != 3)
+					{
+						chunk.valid = false;
+						return;
+					}
+					normals[normal++] = glm::vec3(n[0], n[1], -n[2]);
+					break;
+				}
+				case 'f':
+				{
+					polygon.clear();
+					while ((p = SkipBlanks(p, lineEnd)) < lineEnd)
+					{
+						int64_t fields[3];
+						bool ok = true;
+						p = ParseCorner(p, lineEnd, fields, ok);
+
+						Corner c;
+						c.position = ResolveIndex(fields[0], position, totals.positions);
+						c.uv = fields[1] ? ResolveIndex(fields[1], uv, totals.uvs) : INVALID;
+						c.normal = fields[2] ? ResolveIndex(fields[2], normal, totals.normals) : INVALID;
+
+						if (!ok || c.position == INVALID || (fields[1] && c.uv == INVALID) || (fields[2] && c.normal == INVALID))
+						{
+							chunk.valid = false;
+							return;
+						}
+
+						chunk.cornersShareIndex &= c.uv == (totals.uvs ? c.position : INVALID) && c.normal == (totals.normals ? c.position : INVALID);
+						polygon.push_back(c);
+					}
+
+					// Fan triangulation, emitted with flipped winding for the left-handed convention
+					for (size_t i = 2; i < polygon.size(); i++)
+					{
+						corners[corner++] = polygon[0];
+						corners[corner++] = polygon[i];
+						corners[corner++] = polygon[i - 1];
+					}
+					break;
+				}
+				default: break;
+				}
+				p = lineEnd + 1;
+			}
+		}
+	}
+
+	bool OBJLoader::LoadOBJ(vfs::IFileSystem& fs, const std::filesystem::path& path, std::vector<std::unique_ptr<Mesh>>& outMeshes)
+	{
+		std::shared_ptr<vfs::IBlob> blob = fs.mapFile(path);
+		if (vfs::IBlob::isEmpty(blob.get()))
+		{
+			logger::warning("OBJLoader: cannot read %s", path.generic_string().c_str());
+			return false;
+		}
+
+		const char* text = static_cast<const char*>(blob->data());
+		const char* textEnd = text + blob->size();
+
+		// Split at line boundaries so no statement straddles two chunks
+		const size_t chunkCount = std::clamp<size_t>(blob->size() / MIN_CHUNK_BYTES, 1, threading::GetWorkerCount() * 8);
+		std::vector<Chunk> chunks(chunkCount);
+		const char* chunkBegin = text;
+		for (size_t c = 0; c < chunkCount; c++)
+		{
+			const char* chunkEnd = textEnd;
+			if (c + 1 < chunkCount)
+			{
+				const char* target = std::max(chunkBegin, text + blob->size() * (c + 1) / chunkCount);
+				chunkEnd = std::min(FindLineEnd(target, textEnd) + 1, textEnd);
+			}
+
+			chunks[c].begin = chunkBegin;
+			chunks[c].end = chunkEnd;
+			chunkBegin = chunkEnd;
+		}
+
+		threading::ParallelFor(chunkCount, 1, [&](size_t begin, size_t end)
+		{
+			for (size_t c = begin; c < end; c++)
+				CountChunk(chunks[c]);
+		});
+
+		Totals totals;
+		for (Chunk& chunk : chunks)
+		{
+			chunk.positionBase = totals.positions;
+			chunk.uvBase = totals.uvs;
+			chunk.normalBase = totals.normals;
+			chunk.triangleBase = totals.triangles;
+			totals.positions += chunk.positions;
+			totals.uvs += chunk.uvs;
+			totals.normals += chunk.normals;
+			totals.triangles += chunk.triangles;
+		}
+
+		if (totals.positions == 0 || totals.triangles == 0 || totals.positions >= size_t(INVALID) || totals.triangles * 3 >= size_t(INVALID))
+			return false;
+
+		std::vector<glm::vec3> positions(totals.positions);
+		std::vector<glm::vec2> uvs(totals.uvs);
+		std::vector<glm::vec3> normals(totals.normals);
+		std::vector<Corner> corners(totals.triangles * 3);
+
+		threading::ParallelFor(chunkCount, 1, [&](size_t begin, size_t end)
+		{
+			for (size_t c = begin; c < end; c++)
+				ParseChunk(chunks[c], totals, positions.data(), uvs.data(), normals.data(), corners.data());
+		});
+
+		bool cornersShareIndex = true;
+		for (const Chunk& chunk : chunks)
+		{
+			if (!chunk.valid)
+			{
+				logger::warning("OBJLoader: malformed statement in %s", path.generic_string().c_str());
+				return false;
+			}
+			cornersShareIndex &= chunk.cornersShareIndex;
+		}
+
+		std::unique_ptr<Mesh> mesh = std::make_unique<Mesh>();
+		const bool uvsPerPosition = uvs.empty() || uvs.size() == positions.size();
+		const bool normalsPerPosition = normals.empty() || normals.size() == positions.size();
+
+		if (cornersShareIndex && uvsPerPosition && normalsPerPosition)
+		{
+			// Scanner exports index every attribute alike, so positions map one-to-one onto vertices
+			mesh->vertices.resize(positions.size());
+			threading::ParallelFor(positions.size(), 1 << 16, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					mesh->vertices[i] = Vertex{ positions[i], uvs.empty() ? glm::vec2(0.0f) : uvs[i], normals.empty() ? glm::vec3(0.0f) : normals[i] };
+				}
+			});
+
+			mesh->indices.resize(corners.size());
+			threading::ParallelFor(corners.size(), 1 << 16, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+					mesh->indices[i] = corners[i].position;
+			});
+		}
+		else
+		{
+			// Mixed v/vt/vn indices: one vertex per distinct corner, numbered in order of first use
+			std::unordered_map<Corner, uint32_t, CornerHash> vertexIds;
+			vertexIds.reserve(positions.size());
+			mesh->indices.resize(corners.size());
+
+			for (size_t i = 0; i < corners.size(); i++)
+			{
+				const Corner& c = corners[i];
+				auto [it, inserted] = vertexIds.try_emplace(c, uint32_t(mesh->vertices.size()));
+				if (inserted)
+				{
+					mesh->vertices.emplace_back(Vertex{ positions[c.position],
+						c.uv != INVALID ? uvs[c.uv] : glm::vec2(0.0f),
+						c.normal != INVALID ? normals[c.normal] : glm::vec3(0.0f) });
+				}
+				mesh->indices[i] = it->second;
+			}
+		}
+
+		MeshOperations::ComputeBounds(mesh.get());
+
+		logger::info("OBJLoader: %zu chunks, %zu positions, %zu triangles (%s vertices).", chunkCount, totals.positions, totals.triangles,
+			cornersShareIndex ? "shared-index" : "deduplicated");
+
+		mesh->instanceTransforms.push_back(glm::mat4(1.0f));
+		outMeshes.push_back(std::move(mesh));
+		return true;
+	}
+};
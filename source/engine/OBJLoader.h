@@ -0,0 +1,20 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <core/VFS.h>
+#include <engine/MeshOperations.h>
+
+namespace croissant
+{
+	// Parallel Wavefront OBJ loader for very large scanned meshes.
+	// The file is mapped through the VFS, split at line boundaries and the chunks are parsed on the shared executor.
+	// A counting pass sizes the output first, so every chunk writes straight into its final place and the result is
+	// identical to a sequential parse. All objects and groups are merged into one Mesh, converted to the same
+	// left-handed convention as ModelLoader's Assimp import.
+	class OBJLoader
+	{
+	public:
+		// Returns false on malformed input (unparsable numbers, out-of-range indices); callers should fall back to Assimp.
+		static bool LoadOBJ(vfs::IFileSystem& fs, const std::filesystem::path& path, std::vector<std::unique_ptr<Mesh>>& outMeshes);
+	};
+};
@@ -0,0 +1,524 @@
+#include <engine/PLYLoader.h>
+#include <core/Threading.h>
+#include <core/log.h>
+#include <charconv>
+
+namespace croissant
+{
+	namespace
+	{
+		constexpr size_t BLOCK_ELEMENTS = 1 << 14; // Output block that stays in cache across the per-property passes
+
+		enum class ScalarType : uint8_t { Invalid, Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+		struct Property
+		{
+			std::string name;
+			ScalarType type = ScalarType::Invalid;		// Item type for lists
+			ScalarType countType = ScalarType::Invalid;	// Only set for lists
+			size_t offset = 0;							// Byte offset in the element, valid up to the first list
+		};
+
+		struct Element
+		{
+			std::string name;
+			size_t count = 0;
+			std::vector<Property> properties;
+			size_t stride = 0;	// Size of one element, 0 when it contains lists
+		};
+
+		ScalarType ParseType(std::string_view name)
+		{
+			if (name == "char" || name == "int8") return ScalarType::Int8;
+			if (name == "uchar" || name == "uint8") return ScalarType::UInt8;
+			if (name == "short" || name == "int16") return ScalarType::Int16;
+			if (name == "ushort" || name == "uint16") return ScalarType::UInt16;
+			if (name == "int" || name == "int32") return ScalarType::Int32;
+			if (name == "uint" || name == "uint32") return ScalarType::UInt32;
+			if (name == "float" || name == "float32") return ScalarType::Float32;
+			if (name == "double" || name == "float64") return ScalarType::Float64;
+			return ScalarType::Invalid;
+		}
+
+		size_t TypeSize(ScalarType type)
+		{
+			switch (type)
+			{
+			case ScalarType::Int8: case ScalarType::UInt8: return 1;
+			case ScalarType::Int16: case ScalarType::UInt16: return 2;
+			case ScalarType::Int32: case ScalarType::UInt32: case ScalarType::Float32: return 4;
+			case ScalarType::Float64: return 8;
+			default: return 0;
+			}
+		}
+
+		bool IsInteger(ScalarType type)
+		{
+			return type != ScalarType::Invalid && type != ScalarType::Float32 && type != ScalarType::Float64;
+		}
+
+		// Parses the ASCII header up to end_header and returns the offset of the binary payload, or 0 on failure
+		size_t ParseHeader(const char* text, size_t size, std::vector<Element>& elements)
+		{
+			size_t pos = 0;
+			bool first = true, binaryLittleEndian = false;
+
+			while (pos < size)
+			{
+				const char* lineStart = text + pos;
+				const char* newline = static_cast<const char*>(memchr(lineStart, '\n', size - pos));
+				if (!newline)
+					return 0;
+				pos = size_t(newline - text) + 1;
+
+				// Tokenise the line
+				std::string_view line(lineStart, size_t(newline - lineStart));
+				std::vector<std::string_view> tokens;
+				for (size_t i = 0; i < line.size();)
+				{
+					while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) i++;
+					size_t start = i;
+					while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r') i++;
+					if (i > start)
+						tokens.push_back(line.substr(start, i - start));
+				}
+
+				if (first)
+				{
+					if (tokens.size() != 1 || tokens[0] != "ply")
+						return 0;
+					first = false;
+					continue;
+				}
+
+				if (tokens.empty() || tokens[0] == "comment" || tokens[0] == "obj_info")
+					continue;
+
+				if (tokens[0] == "end_header")
+					return binaryLittleEndian ? pos : 0;
+
+				if (tokens[0] == "format" && tokens.size() >= 2)
+				{
+					binaryLittleEndian = tokens[1] == "binary_little_endian";
+				}
+				else if (tokens[0] == "element" && tokens.size() == 3)
+				{
+					Element element;
+					element.name = std::string(tokens[1]);
+					if (std::from_chars(tokens[2].data(), tokens[2].data() + tokens[2].size(), element.count).ec != std::errc())
+						return 0;
+					elements.push_back(std::move(element));
+				}
+				else if (tokens[0] == "property" && !elements.empty())
+				{
+					Property property;
+					if (tokens.size() == 5 && tokens[1] == "list")
+					{
+						property.countType = ParseType(tokens[2]);
+						property.type = ParseType(tokens[3]);
+						property.name = std::string(tokens[4]);
+						if (!IsInteger(property.countType))
+							return 0;
+					}
+					else if (tokens.size() == 3)
+					{
+						property.type = ParseType(tokens[1]);
+						property.name = std::string(tokens[2]);
+					}
+
+					if (property.type == ScalarType::Invalid)
+						return 0;
+					elements.back().properties.push_back(std::move(property));
+				}
+				else
+				{
+					return 0;
+				}
+			}
+			return 0;
+		}
+
+		// Fills property offsets and the fixed stride of each element
+		void ComputeLayout(Element& element)
+		{
+			size_t offset = 0;
+			bool fixed = true;
+			for (Property& property : element.properties)
+			{
+				property.offset = offset;
+				if (property.countType != ScalarType::Invalid)
+				{
+					fixed = false;
+					offset += TypeSize(property.countType);
+				}
+				else
+				{
+					offset += TypeSize(property.type);
+				}
+			}
+			element.stride = fixed ? offset : 0;
+		}
+
+		template <typename T>
+		inline T Load(const uint8_t* p)
+		{
+			T value;
+			memcpy(&value, p, sizeof(T));
+			return value;
+		}
+
+		// Reads an unsigned list count of 1, 2 or 4 bytes
+		inline uint32_t LoadCount(const uint8_t* p, size_t countSize)
+		{
+			uint32_t count = 0;
+			memcpy(&count, p, countSize);
+			return count;
+		}
+
+		// Walks a variable-size element and returns its byte size, or 0 if it runs past end
+		size_t VariableElementSize(const Element& element, const uint8_t* p, const uint8_t* end)
+		{
+			const uint8_t* start = p;
+			for (const Property& property : element.properties)
+			{
+				if (property.countType != ScalarType::Invalid)
+				{
+					const size_t countSize = TypeSize(property.countType);
+					if (size_t(end - p) < countSize)
+						return 0;
+					p += countSize + size_t(LoadCount(p, countSize)) * TypeSize(property.type);
+				}
+				else
+				{
+					p += TypeSize(property.type);
+				}
+
+				if (p > end)
+					return 0;
+			}
+			return size_t(p - start);
+		}
+
+		// One strided pass converting a single property into one float of every Vertex: dst = value * scale + bias
+		template <typename T>
+		void CopyComponent(const uint8_t* src, size_t stride, size_t begin, size_t end, float scale, float bias, uint8_t* dst)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				float value = float(Load<T>(src + i * stride)) * scale + bias;
+				memcpy(dst + i * sizeof(Vertex), &value, sizeof(float));
+			}
+		}
+
+		struct ComponentSource
+		{
+			const Property* property = nullptr;
+			size_t vertexOffset = 0;	// Byte offset of the destination float in Vertex
+			float scale = 1.0f;
+			float bias = 0.0f;
+		};
+
+		void CopyComponent(const ComponentSource& source, const uint8_t* table, size_t stride, size_t begin, size_t end, Vertex* vertices)
+		{
+			const uint8_t* src = table + source.property->offset;
+			uint8_t* dst = reinterpret_cast<uint8_t*>(vertices) + source.vertexOffset;
+
+			// Integer attributes (colour-style normals or UVs) are normalised to [0, 1] or [-1, 1]
+			float scale = source.scale;
+			switch (source.property->type)
+			{
+			case ScalarType::Int8:		CopyComponent<int8_t>(src, stride, begin, end, scale / 127.0f, source.bias, dst); break;
+			case ScalarType::UInt8:		CopyComponent<uint8_t>(src, stride, begin, end, scale / 255.0f, source.bias, dst); break;
+			case ScalarType::Int16:		CopyComponent<int16_t>(src, stride, begin, end, scale / 32767.0f, source.bias, dst); break;
+			case ScalarType::UInt16:	CopyComponent<uint16_t>(src, stride, begin, end, scale / 65535.0f, source.bias, dst); break;
+			case ScalarType::Int32:		CopyComponent<int32_t>(src, stride, begin, end, scale, source.bias, dst); break;
+			case ScalarType::UInt32:	CopyComponent<uint32_t>(src, stride, begin, end, scale, source.bias, dst); break;
+			case ScalarType::Float32:	CopyComponent<float>(src, stride, begin, end, scale, source.bias, dst); break;
+			case ScalarType::Float64:	CopyComponent<double>(src, stride, begin, end, scale, source.bias, dst); break;
+			default: break;
+			}
+		}
+
+		// Fixed-stride triangle table: copies with flipped winding and folds count and range checks into
+		// accumulators instead of branching per face. Returns false if any face is not a triangle or out of range.
+		template <typename T>
+		bool CopyTriangles(const uint8_t* table, size_t stride, size_t listOffset, size_t countSize, size_t begin, size_t end, uint32_t vertexCount, uint32_t* dst)
+		{
+			uint32_t notTriangle = 0, maxIndex = 0;
+			for (size_t f = begin; f < end; f++)
+			{
+				const uint8_t* face = table + f * stride + listOffset;
+				const uint8_t* items = face + countSize;
+				uint32_t i0 = uint32_t(Load<T>(items)), i1 = uint32_t(Load<T>(items + sizeof(T))), i2 = uint32_t(Load<T>(items + 2 * sizeof(T)));
+
+				notTriangle |= LoadCount(face, countSize) ^ 3u;
+				maxIndex = std::max(maxIndex, std::max(i0, std::max(i1, i2)));
+
+				dst[f * 3 + 0] = i0;
+				dst[f * 3 + 1] = i2;
+				dst[f * 3 + 2] = i1;
+			}
+			return notTriangle == 0 && (begin == end || maxIndex < vertexCount);
+		}
+
+		uint32_t LoadIndex(const uint8_t* p, ScalarType type)
+		{
+			switch (type)
+			{
+			case ScalarType::Int8: return uint32_t(Load<int8_t>(p));
+			case ScalarType::UInt8: return uint32_t(Load<uint8_t>(p));
+			case ScalarType::Int16: return uint32_t(Load<int16_t>(p));
+			case ScalarType::UInt16: return uint32_t(Load<uint16_t>(p));
+			default: return Load<uint32_t>(p);
+			}
+		}
+
+		void Evict(const vfs::IBlob* blob, const uint8_t* begin, const uint8_t* end)
+		{
+			if (const vfs::MappedBlob* mapped = dynamic_cast<const vfs::MappedBlob*>(blob))
+				mapped->evict(size_t(begin - static_cast<const uint8_t*>(blob->data())), size_t(end - begin));
+		}
+
+		const Property* FindProperty(const Element& element, std::initializer_list<std::string_view> names)
+		{
+			for (const Property& property : element.properties)
+			{
+				if (property.countType != ScalarType::Invalid)
+					continue;
+				for (std::string_view name : names)
+				{
+					if (property.name == name)
+						return &property;
+				}
+			}
+			return nullptr;
+		}
+
+		bool LoadVertices(const Element& element, const uint8_t* table, const vfs::IBlob* blob, Mesh* mesh)
+		{
+			// Destination floats and the Assimp ConvertToLeftHanded conversion: z mirrored, V flipped
+			struct Mapping { std::initializer_list<std::string_view> names; size_t vertexOffset; float scale; float bias; };
+			const Mapping mappings[] = {
+				{ { "x" },								offsetof(Vertex, position) + 0,	 1.0f, 0.0f },
+				{ { "y" },								offsetof(Vertex, position) + 4,	 1.0f, 0.0f },
+				{ { "z" },								offsetof(Vertex, position) + 8,	-1.0f, 0.0f },
+				{ { "u", "s", "texture_u", "texture_s" },	offsetof(Vertex, uv) + 0,		 1.0f, 0.0f },
+				{ { "v", "t", "texture_v", "texture_t" },	offsetof(Vertex, uv) + 4,		-1.0f, 1.0f },
+				{ { "nx" },								offsetof(Vertex, normal) + 0,	 1.0f, 0.0f },
+				{ { "ny" },								offsetof(Vertex, normal) + 4,	 1.0f, 0.0f },
+				{ { "nz" },								offsetof(Vertex, normal) + 8,	-1.0f, 0.0f },
+			};
+
+			std::vector<ComponentSource> sources;
+			for (const Mapping& mapping : mappings)
+			{
+				if (const Property* property = FindProperty(element, mapping.names))
+					sources.push_back(ComponentSource{ property, mapping.vertexOffset, mapping.scale, mapping.bias });
+				else if (mapping.vertexOffset < offsetof(Vertex, uv))
+					return false; // Positions are mandatory
+			}
+
+			// Absent attributes stay zero, like the Assimp path
+			mesh->vertices.resize(element.count, Vertex{ glm::vec3(0.0f), glm::vec2(0.0f), glm::vec3(0.0f) });
+
+			threading::ParallelFor(element.count, BLOCK_ELEMENTS, [&](size_t rangeBegin, size_t rangeEnd)
+			{
+				for (size_t begin = rangeBegin; begin < rangeEnd; begin += BLOCK_ELEMENTS)
+				{
+					size_t end = std::min(begin + BLOCK_ELEMENTS, rangeEnd);
+					for (const ComponentSource& source : sources)
+						CopyComponent(source, table, element.stride, begin, end, mesh->vertices.data());
+
+					Evict(blob, table + begin * element.stride, table + end * element.stride);
+				}
+			});
+
+			return true;
+		}
+
+		bool LoadFaces(const Element& element, const uint8_t* table, const uint8_t* fileEnd, const vfs::IBlob* blob, Mesh* mesh)
+		{
+			const Property* list = nullptr;
+			for (const Property& property : element.properties)
+			{
+				if (property.countType != ScalarType::Invalid && (property.name == "vertex_indices" || property.name == "vertex_index"))
+					list = &property;
+			}
+
+			if (!list || !IsInteger(list->type))
+				return false;
+
+			const uint32_t vertexCount = uint32_t(mesh->vertices.size());
+			const size_t countSize = TypeSize(list->countType);
+			const size_t itemSize = TypeSize(list->type);
+
+			// Fast path: the face table only holds triangle lists, so every face has the same size
+			const bool onlyList = element.properties.size() == 1;
+			const size_t triangleStride = countSize + 3 * itemSize;
+			if (onlyList && element.count * triangleStride <= size_t(fileEnd - table))
+			{
+				mesh->indices.resize(element.count * 3);
+				std::atomic<bool> valid = true;
+
+				threading::ParallelFor(element.count, BLOCK_ELEMENTS, [&](size_t begin, size_t end)
+				{
+					bool rangeValid = false;
+					switch (list->type)
+					{
+					case ScalarType::Int8:		rangeValid = CopyTriangles<int8_t>(table, triangleStride, 0, countSize, begin, end, vertexCount, mesh->indices.data()); break;
+					case ScalarType::UInt8:		rangeValid = CopyTriangles<uint8_t>(table, triangleStride, 0, countSize, begin, end, vertexCount, mesh->indices.data()); break;
+					case ScalarType::Int16:		rangeValid = CopyTriangles<int16_t>(table, triangleStride, 0, countSize, begin, end, vertexCount, mesh->indices.data()); break;
+					case ScalarType::UInt16:	rangeValid = CopyTriangles<uint16_t>(table, triangleStride, 0, countSize, begin, end, vertexCount, mesh->indices.data()); break;
+					case ScalarType::Int32:		rangeValid = CopyTriangles<int32_t>(table, triangleStride, 0, countSize, begin, end, vertexCount, mesh->indices.data()); break;
+					case ScalarType::UInt32:	rangeValid = CopyTriangles<uint32_t>(table, triangleStride, 0, countSize, begin, end, vertexCount, mesh->indices.data()); break;
+					default: break;
+					}
+
+					if (!rangeValid)
+						valid = false;
+					Evict(blob, table + begin * triangleStride, table + end * triangleStride);
+				});
+
+				if (valid)
+					return true;
+			}
+
+			// General path: polygons and extra face properties need a sequential walk to find each face.
+			// Count first so the index array is allocated once at its final size.
+			size_t triangleCount = 0;
+			const uint8_t* p = table;
+			for (size_t f = 0; f < element.count; f++)
+			{
+				size_t size = VariableElementSize(element, p, fileEnd);
+				if (size == 0)
+					return false;
+
+				uint32_t corners = LoadCount(p + list->offset, countSize);
+				triangleCount += corners >= 3 ? corners - 2 : 0;
+				p += size;
+			}
+
+			mesh->indices.clear();
+			mesh->indices.shrink_to_fit();
+			mesh->indices.resize(triangleCount * 3);
+
+			// List offsets are only fixed up to the first list, so locate the one we need per face
+			size_t listIndex = size_t(list - element.properties.data());
+			uint32_t* dst = mesh->indices.data();
+			p = table;
+			for (size_t f = 0; f < element.count; f++)
+			{
+				const uint8_t* q = p;
+				for (size_t i = 0; i < listIndex; i++)
+				{
+					const Property& property = element.properties[i];
+					q += property.countType != ScalarType::Invalid ?
+						TypeSize(property.countType) + size_t(LoadCount(q, TypeSize(property.countType))) * TypeSize(property.type) :
+						TypeSize(property.type);
+				}
+
+				// Points and lines produce no triangles, and may not even hold a first index
+				uint32_t corners = LoadCount(q, countSize);
+				const uint8_t* items = q + countSize;
+				uint32_t first = corners >= 3 ? LoadIndex(items, list->type) : 0;
+
+				// Fan triangulation with flipped winding
+				for (uint32_t c = 2; c < corners; c++)
+				{
+					uint32_t previous = LoadIndex(items + (c - 1) * itemSize, list->type);
+					uint32_t current = LoadIndex(items + c * itemSize, list->type);
+					if (first >= vertexCount || previous >= vertexCount || current >= vertexCount)
+						return false;
+
+					*dst++ = first;
+					*dst++ = current;
+					*dst++ = previous;
+				}
+
+				p += VariableElementSize(element, p, fileEnd);
+			}
+
+			return true;
+		}
+	}
+
+	bool PLYLoader::LoadPLY(vfs::IFileSystem& fs, const std::filesystem::path& path, std::vector<std::unique_ptr<Mesh>>& outMeshes)
+	{
+		std::shared_ptr<vfs::IBlob> blob = fs.mapFile(path);
+		if (vfs::IBlob::isEmpty(blob.get()))
+		{
+			logger::warning("PLYLoader: cannot read %s", path.generic_string().c_str());
+			return false;
+		}
+
+		const uint8_t* file = static_cast<const uint8_t*>(blob->data());
+		const uint8_t* fileEnd = file + blob->size();
+
+		std::vector<Element> elements;
+		size_t payload = ParseHeader(reinterpret_cast<const char*>(file), blob->size(), elements);
+		if (payload == 0)
+		{
+			logger::info("PLYLoader: %s is not a binary little-endian PLY file", path.generic_string().c_str());
+			return false;
+		}
+
+		std::unique_ptr<Mesh> mesh = std::make_unique<Mesh>();
+		bool hasVertices = false;
+		const uint8_t* table = file + payload;
+
+		for (Element& element : elements)
+		{
+			ComputeLayout(element);
+
+			if (element.name == "vertex")
+			{
+				if (element.stride == 0 || element.count >= size_t(INVALID) || element.count * element.stride > size_t(fileEnd - table) ||
+					!LoadVertices(element, table, blob.get(), mesh.get()))
+				{
+					logger::warning("PLYLoader: unsupported vertex table in %s", path.generic_string().c_str());
+					return false;
+				}
+				hasVertices = true;
+			}
+			else if (element.name == "face" && element.count > 0)
+			{
+				if (!hasVertices || element.count * 3 >= size_t(INVALID) || !LoadFaces(element, table, fileEnd, blob.get(), mesh.get()))
+				{
+					logger::warning("PLYLoader: unsupported face table in %s", path.generic_string().c_str());
+					return false;
+				}
+			}
+
+			// Skip to the next table
+			if (element.stride != 0)
+			{
+				if (element.count * element.stride > size_t(fileEnd - table))
+					return false;
+				table += element.count * element.stride;
+			}
+			else
+			{
+				for (size_t i = 0; i < element.count; i++)
+				{
+					size_t size = VariableElementSize(element, table, fileEnd);
+					if (size == 0)
+						return false;
+					table += size;
+				}
+			}
+		}
+
+		if (!hasVertices || mesh->vertices.empty())
+			return false;
+
+		MeshOperations::ComputeBounds(mesh.get());
+
+		// Point clouds load with empty indices, consumers that need triangles skip them
+		logger::info("PLYLoader: %zu vertices, %zu triangles%s.", mesh->vertices.size(), mesh->indices.size() / 3,
+			mesh->indices.empty() ? " (point cloud)" : "");
+
+		mesh->instanceTransforms.push_back(glm::mat4(1.0f));
+		outMeshes.push_back(std::move(mesh));
+		return true;
+	}
+};
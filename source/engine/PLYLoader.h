@@ -0,0 +1,20 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <core/VFS.h>
+#include <engine/MeshOperations.h>
+
+namespace croissant
+{
+	// Loader for binary little-endian PLY scans.
+	// The file is mapped through the VFS and the vertex and face tables are copied straight into Mesh arrays
+	// with one strided pass per used property, so unused properties cost nothing but their stride.
+	// Output arrays are sized from the header up front and consumed file pages are evicted as blocks complete,
+	// keeping peak memory close to the final mesh size. Point clouds load with empty indices.
+	class PLYLoader
+	{
+	public:
+		// Returns false for ASCII or big-endian files and malformed tables; callers should fall back to Assimp.
+		static bool LoadPLY(vfs::IFileSystem& fs, const std::filesystem::path& path, std::vector<std::unique_ptr<Mesh>>& outMeshes);
+	};
+};
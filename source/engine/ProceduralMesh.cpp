@@ -0,0 +1,351 @@
+#include <engine/ProceduralMesh.h>
+#include <core/Threading.h>
+#include <core/log.h>
+#include <glm/gtc/constants.hpp>
+
+namespace croissant
+{
+	namespace
+	{
+		constexpr size_t ROW_GRAIN = 16;
+
+		uint32_t Hash(uint32_t x, uint32_t y, uint32_t seed)
+		{
+			uint32_t state = x * 0x8DA6B343u ^ y * 0xD8163841u ^ seed * 0xCB1AB31Fu;
+			state = state * 747796405u + 2891336453u;
+			const uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+			return (word >> 22u) ^ word;
+		}
+
+		float LatticeValue(int32_t x, int32_t y, uint32_t seed)
+		{
+			return float(Hash(uint32_t(x), uint32_t(y), seed) >> 8) * (2.0f / 16777216.0f) - 1.0f;
+		}
+
+		// Smoothly interpolated value noise, in [-1, 1]
+		float ValueNoise(float x, float y, uint32_t seed)
+		{
+			const float fx = std::floor(x), fy = std::floor(y);
+			const int32_t ix = int32_t(fx), iy = int32_t(fy);
+			const float tx = x - fx, ty = y - fy;
+			const float sx = tx * tx * (3.0f - 2.0f * tx), sy = ty * ty * (3.0f - 2.0f * ty);
+			const float top = glm::mix(LatticeValue(ix, iy, seed), LatticeValue(ix + 1, iy, seed), sx);
+			const float bottom = glm::mix(LatticeValue(ix, iy + 1, seed), LatticeValue(ix + 1, iy + 1, seed), sx);
+			return glm::mix(top, bottom, sy);
+		}
+
+		// Six octaves over the unit square, amplitudes halving as frequencies double
+		float TerrainHeight(float u, float v, uint32_t seed)
+		{
+			float height = 0.0f, amplitude = 0.5f, frequency = 4.0f;
+			for (uint32_t octave = 0; octave < 6; octave++)
+			{
+				height += amplitude * ValueNoise(u * frequency, v * frequency, seed + octave);
+				amplitude *= 0.5f;
+				frequency *= 2.0f;
+			}
+			return height;
+		}
+
+		// Square grid of cells * cells quads in XZ, two triangles per quad. Terrain heights are sampled first,
+		// normals taken from the neighbouring heights after
+		void GenerateGrid(const ProceduralMeshSettings& settings, uint32_t cells, bool terrain, Mesh& outMesh)
+		{
+			const uint32_t side = cells + 1;
+			const float spacing = settings.size / float(cells);
+			const float amplitude = settings.size * 0.1f;
+			outMesh.vertices.resize(size_t(side) * side);
+			outMesh.indices.resize(size_t(cells) * cells * 6);
+
+			threading::ParallelFor(side, ROW_GRAIN, [&](size_t begin, size_t end)
+			{
+				for (size_t y = begin; y < end; y++)
+				{
+					for (uint32_t x = 0; x < side; x++)
+					{
+						const glm::vec2 uv(float(x) / float(cells), float(y) / float(cells));
+						const float height = terrain ? amplitude * TerrainHeight(uv.x, uv.y, settings.seed) : 0.0f;
+						outMesh.vertices[y * side + x] = Vertex{ glm::vec3(uv.x * settings.size, height, uv.y * settings.size), uv, glm::vec3(0.0f, 1.0f, 0.0f) };
+					}
+					if (y == cells)
+						continue;
+					uint32_t* indices = outMesh.indices.data() + y * cells * 6;
+					for (uint32_t x = 0; x < cells; x++, indices += 6)
+					{
+						const uint32_t a = uint32_t(y) * side + x;
+						const uint32_t b = a + side;
+						indices[0] = a;		indices[1] = b;	indices[2] = a + 1;
+						indices[3] = a + 1;	indices[4] = b;	indices[5] = b + 1;
+					}
+				}
+			});
+
+			if (!terrain)
+				return;
+			threading::ParallelFor(side, ROW_GRAIN, [&](size_t begin, size_t end)
+			{
+				for (size_t y = begin; y < end; y++)
+				{
+					for (uint32_t x = 0; x < side; x++)
+					{
+						const float left = outMesh.vertices[y * side + (x > 0 ? x - 1 : x)].position.y;
+						const float right = outMesh.vertices[y * side + (x < cells ? x + 1 : x)].position.y;
+						const float back = outMesh.vertices[(y > 0 ? y - 1 : y) * side + x].position.y;
+						const float front = outMesh.vertices[(y < cells ? y + 1 : y) * side + x].position.y;
+						const float dx = float((x < cells ? x + 1 : x) - (x > 0 ? x - 1 : x)) * spacing;
+						const float dz = float((y < cells ? y + 1 : y) - (y > 0 ? y - 1 : y)) * spacing;
+						outMesh.vertices[y * side + x].normal = glm::normalize(glm::vec3(-(right - left) / dx, 1.0f, -(front - back) / dz));
+					}
+				}
+			});
+		}
+
+		// Rings of segments vertices between the poles, fans at the poles and quad bands between rings
+		void GenerateSphere(const ProceduralMeshSettings& settings, uint32_t rings, Mesh& outMesh)
+		{
+			const uint32_t segments = rings * 2;
+			const uint32_t bottom = 1 + (rings - 1) * segments;
+			outMesh.vertices.resize(size_t(bottom) + 1);
+			outMesh.indices.resize(size_t(segments) * (rings - 1) * 6);
+			outMesh.vertices[0] = Vertex{ glm::vec3(0.0f, settings.size, 0.0f), glm::vec2(0.5f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) };
+			outMesh.vertices[bottom] = Vertex{ glm::vec3(0.0f, -settings.size, 0.0f), glm::vec2(0.5f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f) };
+
+			auto ringVertex = [&](uint32_t ring, uint32_t segment) { return 1 + (ring - 1) * segments + segment % segments; };
+
+			// Row 0 is the top fan, row k the band below ring k, the last row the bottom fan
+			threading::ParallelFor(rings, ROW_GRAIN, [&](size_t begin, size_t end)
+			{
+				for (size_t row = begin; row < end; row++)
+				{
+					const uint32_t ring = uint32_t(row) + 1;
+					if (ring < rings)
+					{
+						const float theta = glm::pi<float>() * float(ring) / float(rings);
+						for (uint32_t s = 0; s < segments; s++)
+						{
+							const float phi = glm::two_pi<float>() * float(s) / float(segments);
+							const glm::vec3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+							outMesh.vertices[ringVertex(ring, s)] = Vertex{ normal * settings.size, glm::vec2(float(s) / float(segments), float(ring) / float(rings)), normal };
+						}
+					}
+
+					uint32_t* indices = outMesh.indices.data() + (row == 0 ? 0 : size_t(segments) * (3 + (row - 1) * 6));
+					for (uint32_t s = 0; s < segments; s++)
+					{
+						if (row == 0)
+						{
+							indices[0] = 0;	indices[1] = ringVertex(1, s + 1);	indices[2] = ringVertex(1, s);
+							indices += 3;
+						}
+						else if (row == rings - 1)
+						{
+							indices[0] = ringVertex(uint32_t(row), s);	indices[1] = ringVertex(uint32_t(row), s + 1);	indices[2] = bottom;
+							indices += 3;
+						}
+						else
+						{
+							const uint32_t a = ringVertex(uint32_t(row), s), b = ringVertex(uint32_t(row), s + 1);
+							const uint32_t c = ringVertex(uint32_t(row) + 1, s), d = ringVertex(uint32_t(row) + 1, s + 1);
+							indices[0] = a;	indices[1] = b;	indices[2] = c;
+							indices[3] = b;	indices[4] = d;	indices[5] = c;
+							indices += 6;
+						}
+					}
+				}
+			});
+		}
+
+		// Tube of minorSegments around a ring of majorSegments = 2 * minorSegments, wrapping both ways
+		void GenerateTorus(const ProceduralMeshSettings& settings, uint32_t minorSegments, Mesh& outMesh)
+		{
+			const uint32_t majorSegments = minorSegments * 2;
+			const float minorRadius = settings.size * 0.35f;
+			outMesh.vertices.resize(size_t(majorSegments) * minorSegments);
+			outMesh.indices.resize(size_t(majorSegments) * minorSegments * 6);
+
+			threading::ParallelFor(majorSegments, ROW_GRAIN, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					const float u = glm::two_pi<float>() * float(i) / float(majorSegments);
+					for (uint32_t j = 0; j < minorSegments; j++)
+					{
+						const float v = glm::two_pi<float>() * float(j) / float(minorSegments);
+						const glm::vec3 normal(std::cos(v) * std::cos(u), std::sin(v), std::cos(v) * std::sin(u));
+						const glm::vec3 centre(settings.size * std::cos(u), 0.0f, settings.size * std::sin(u));
+						outMesh.vertices[i * minorSegments + j] = Vertex{ centre + normal * minorRadius,
+							glm::vec2(float(i) / float(majorSegments), float(j) / float(minorSegments)), normal };
+					}
+
+					const uint32_t next = uint32_t(i + 1) % majorSegments;
+					uint32_t* indices = outMesh.indices.data() + i * minorSegments * 6;
+					for (uint32_t j = 0; j < minorSegments; j++, indices += 6)
+					{
+						const uint32_t k = (j + 1) % minorSegments;
+						const uint32_t a = uint32_t(i) * minorSegments + j, b = uint32_t(i) * minorSegments + k;
+						const uint32_t c = next * minorSegments + j, d = next * minorSegments + k;
+						indices[0] = a;	indices[1] = b;	indices[2] = c;
+						indices[3] = b;	indices[4] = d;	indices[5] = c;
+					}
+				}
+			});
+		}
+
+		enum class Defect : uint32_t
+		{
+			None,
+			Fin,		// Extra triangle standing on the cell diagonal, three faces on one edge
+			Flipped,	// Second triangle wound backwards against its neighbours
+			Duplicate,	// First triangle emitted twice
+			Bowtie,		// Cell and its diagonal neighbour dropped, their shared corner joins two fans at a point
+		};
+
+		Defect GetDefect(uint32_t x, uint32_t y, uint32_t cells, const ProceduralMeshSettings& settings)
+		{
+			if (x >= cells || y >= cells)
+				return Defect::None;
+			const uint32_t hash = Hash(x, y, settings.seed);
+			if (float(hash & 0xFFFFFF) >= settings.defectFraction * 16777216.0f)
+				return Defect::None;
+			return Defect(1 + (hash >> 24) % 4);
+		}
+
+		// Flat grid with defects. Cells emit different triangle counts, so rows are counted, offset and then filled
+		void GenerateNonManifold(const ProceduralMeshSettings& settings, uint32_t cells, Mesh& outMesh)
+		{
+			const uint32_t side = cells + 1;
+			std::vector<size_t> rowTriangles(size_t(cells) + 1, 0), rowFins(size_t(cells) + 1, 0);
+			auto isDropped = [&](uint32_t x, uint32_t y)
+			{
+				return GetDefect(x, y, cells, settings) == Defect::Bowtie || (x > 0 && y > 0 && GetDefect(x - 1, y - 1, cells, settings) == Defect::Bowtie);
+			};
+
+			threading::ParallelFor(cells, ROW_GRAIN, [&](size_t begin, size_t end)
+			{
+				for (size_t y = begin; y < end; y++)
+				{
+					for (uint32_t x = 0; x < cells; x++)
+					{
+						if (isDropped(x, uint32_t(y)))
+							continue;
+						const Defect defect = GetDefect(x, uint32_t(y), cells, settings);
+						rowTriangles[y + 1] += defect == Defect::Fin || defect == Defect::Duplicate ? 3 : 2;
+						rowFins[y + 1] += defect == Defect::Fin ? 1 : 0;
+					}
+				}
+			});
+			for (uint32_t y = 0; y < cells; y++)
+			{
+				rowTriangles[y + 1] += rowTriangles[y];
+				rowFins[y + 1] += rowFins[y];
+			}
+
+			const size_t gridVertices = size_t(side) * side;
+			outMesh.vertices.resize(gridVertices + rowFins[cells]);
+			outMesh.indices.resize(rowTriangles[cells] * 3);
+			const float spacing = settings.size / float(cells);
+
+			threading::ParallelFor(side, ROW_GRAIN, [&](size_t begin, size_t end)
+			{
+				for (size_t y = begin; y < end; y++)
+				{
+					for (uint32_t x = 0; x < side; x++)
+					{
+						const glm::vec2 uv(float(x) / float(cells), float(y) / float(cells));
+						outMesh.vertices[y * side + x] = Vertex{ glm::vec3(uv.x * settings.size, 0.0f, uv.y * settings.size), uv, glm::vec3(0.0f, 1.0f, 0.0f) };
+					}
+					if (y == cells)
+						continue;
+
+					uint32_t* indices = outMesh.indices.data() + rowTriangles[y] * 3;
+					uint32_t fin = uint32_t(gridVertices + rowFins[y]);
+					for (uint32_t x = 0; x < cells; x++)
+					{
+						if (isDropped(x, uint32_t(y)))
+							continue;
+						const Defect defect = GetDefect(x, uint32_t(y), cells, settings);
+						const uint32_t a = uint32_t(y) * side + x;
+						const uint32_t b = a + side;
+						indices[0] = a;	indices[1] = b;	indices[2] = a + 1;
+						if (defect == Defect::Flipped)
+						{
+							indices[3] = a + 1;	indices[4] = b + 1;	indices[5] = b;
+						}
+						else
+						{
+							indices[3] = a + 1;	indices[4] = b;	indices[5] = b + 1;
+						}
+						indices += 6;
+
+						if (defect == Defect::Duplicate)
+						{
+							indices[0] = a;	indices[1] = b;	indices[2] = a + 1;
+							indices += 3;
+						}
+						else if (defect == Defect::Fin)
+						{
+							const glm::vec2 uv((float(x) + 0.5f) / float(cells), (float(y) + 0.5f) / float(cells));
+							outMesh.vertices[fin] = Vertex{ glm::vec3(uv.x * settings.size, spacing, uv.y * settings.size), uv, glm::normalize(glm::vec3(1.0f, 0.0f, 1.0f)) };
+							indices[0] = b;	indices[1] = a + 1;	indices[2] = fin++;
+							indices += 3;
+						}
+					}
+				}
+			});
+		}
+	}
+
+	bool ProceduralMesh::Generate(const ProceduralMeshSettings& settings, Mesh& outMesh)
+	{
+		if (settings.triangleCount == 0 || !(settings.size > 0.0f))
+		{
+			logger::warning("Procedural %s needs a positive size and triangle count.", GetShapeName(settings.shape));
+			return false;
+		}
+
+		// Vertex counts grow like the triangle counts, 32-bit indices run out just past 8G triangles
+		if (settings.triangleCount > (1ull << 33))
+		{
+			logger::warning("Procedural %s of %llu triangles is too large for 32-bit indices.", GetShapeName(settings.shape), (unsigned long long)settings.triangleCount);
+			return false;
+		}
+
+		outMesh = Mesh();
+		const double target = double(settings.triangleCount);
+		switch (settings.shape)
+		{
+		case ProceduralShape::Sphere:
+			// 2 * segments * (rings - 1) triangles with segments = 2 * rings
+			GenerateSphere(settings, std::max(2u, uint32_t(std::lround((1.0 + std::sqrt(1.0 + target)) * 0.5))), outMesh);
+			break;
+		case ProceduralShape::Torus:
+			GenerateTorus(settings, std::max(3u, uint32_t(std::lround(std::sqrt(target / 4.0)))), outMesh);
+			break;
+		case ProceduralShape::Grid:
+		case ProceduralShape::Terrain:
+			GenerateGrid(settings, std::max(1u, uint32_t(std::lround(std::sqrt(target / 2.0)))), settings.shape == ProceduralShape::Terrain, outMesh);
+			break;
+		case ProceduralShape::NonManifold:
+			GenerateNonManifold(settings, std::max(2u, uint32_t(std::lround(std::sqrt(target / 2.0)))), outMesh);
+			break;
+		default:
+			return false;
+		}
+
+		MeshOperations::ComputeBounds(&outMesh);
+		return true;
+	}
+
+	const char* ProceduralMesh::GetShapeName(ProceduralShape shape)
+	{
+		switch (shape)
+		{
+		case ProceduralShape::Sphere: return "Sphere";
+		case ProceduralShape::Torus: return "Torus";
+		case ProceduralShape::Grid: return "Grid";
+		case ProceduralShape::Terrain: return "Terrain";
+		case ProceduralShape::NonManifold: return "NonManifold";
+		default: return "Unknown";
+		}
+	}
+};
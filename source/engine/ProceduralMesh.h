@@ -0,0 +1,37 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <engine/MeshOperations.h>
+
+namespace croissant
+{
+	enum class ProceduralShape
+	{
+		Sphere,			// Closed UV sphere with one vertex per pole; the uv seam is not split, so u wraps
+		Torus,			// Closed, every vertex of valence 6
+		Grid,			// Flat open square in XZ
+		Terrain,		// Grid displaced by fractal value noise
+		NonManifold,	// Grid with fins, flipped and duplicated triangles and bowtie vertices scattered over it
+	};
+
+	struct ProceduralMeshSettings
+	{
+		ProceduralShape shape = ProceduralShape::Grid;
+		uint64_t triangleCount = 1 << 20;	// Target, met as closely as the shape's tessellation allows
+		float    size = 1.0f;				// Sphere radius, torus major radius, side of the grids
+		uint32_t seed = 1;					// Terrain noise and NonManifold defect placement
+		float    defectFraction = 0.01f;	// NonManifold: fraction of grid cells given a defect
+	};
+
+	// Meshes of any size from 1K to beyond 100M triangles without assets or Assimp, so every mesh pass can be timed
+	// on inputs of known shape and scale. Rows of the tessellation are generated in parallel on the shared workers,
+	// so it must not be called from inside a worker. Fills vertices, indices and bounds only: derived data such as
+	// half-edges is left for the caller to build, or to time
+	class ProceduralMesh
+	{
+	public:
+		static bool Generate(const ProceduralMeshSettings& settings, Mesh& outMesh);
+
+		static const char* GetShapeName(ProceduralShape shape);
+	};
+};
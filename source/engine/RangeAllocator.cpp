@@ -0,0 +1,121 @@
+#include <engine/RangeAllocator.h>
+
+namespace croissant
+{
+	RangeAllocator::RangeAllocator(uint64_t size)
+	{
+		Reset(size);
+	}
+
+	void RangeAllocator::Reset(uint64_t size)
+	{
+		m_Size = size;
+		m_Used = 0;
+		m_FreeByOffset.clear();
+		m_FreeBySize.clear();
+		m_Allocations.clear();
+
+		if (size > 0)
+			InsertFree(0, size);
+	}
+
+	void RangeAllocator::InsertFree(uint64_t offset, uint64_t size)
+	{
+		m_FreeByOffset.emplace(offset, size);
+		m_FreeBySize.emplace(size, offset);
+	}
+
+	void RangeAllocator::EraseFree(std::map<uint64_t, uint64_t>::iterator block)
+	{
+		auto [first, last] = m_FreeBySize.equal_range(block->second);
+		for (auto it = first; it != last; ++it)
+		{
+			if (it->second == block->first)
+			{
+				m_FreeBySize.erase(it);
+				break;
+			}
+		}
+		m_FreeByOffset.erase(block);
+	}
+
+	uint64_t RangeAllocator::Allocate(uint64_t size, uint64_t alignment)
+	{
+		if (size == 0 || alignment == 0)
+			return INVALID_OFFSET;
+
+		// Best fit: the smallest block that still fits once its start is aligned
+		for (auto it = m_FreeBySize.lower_bound(size); it != m_FreeBySize.end(); ++it)
+		{
+			const uint64_t blockOffset = it->second;
+			const uint64_t blockSize = it->first;
+			const uint64_t aligned = (blockOffset + alignment - 1) / alignment * alignment;
+			if (aligned + size > blockOffset + blockSize)
+				continue;
+
+			EraseFree(m_FreeByOffset.find(blockOffset));
+
+			// Padding stays with the allocation, the tail goes back to the free list
+			const uint64_t reserved = aligned - blockOffset + size;
+			if (blockSize > reserved)
+				InsertFree(blockOffset + reserved, blockSize - reserved);
+
+			m_Allocations.emplace(aligned, Block{ blockOffset, reserved });
+			m_Used += reserved;
+			return aligned;
+		}
+
+		return INVALID_OFFSET;
+	}
+
+	void RangeAllocator::Free(uint64_t offset)
+	{
+		if (offset == INVALID_OFFSET)
+			return;
+
+		auto allocation = m_Allocations.find(offset);
+		if (allocation == m_Allocations.end())
+		{
+			assert(!"RangeAllocator::Free called with an offset that was not allocated");
+			return;
+		}
+
+		uint64_t start = allocation->second.start;
+		uint64_t size = allocation->second.size;
+		m_Used -= size;
+		m_Allocations.erase(allocation);
+
+		// Merge with the free neighbours on both sides
+		auto next = m_FreeByOffset.lower_bound(start);
+		if (next != m_FreeByOffset.end() && next->first == start + size)
+		{
+			size += next->second;
+			EraseFree(next);
+		}
+
+		auto previous = m_FreeByOffset.lower_bound(start);
+		if (previous != m_FreeByOffset.begin())
+		{
+			--previous;
+			if (previous->first + previous->second == start)
+			{
+				start = previous->first;
+				size += previous->second;
+				EraseFree(previous);
+			}
+		}
+
+		InsertFree(start, size);
+	}
+
+	RangeAllocator::Stats RangeAllocator::GetStats() const
+	{
+		Stats stats;
+		stats.totalSize = m_Size;
+		stats.usedSize = m_Used;
+		stats.largestFreeBlock = m_FreeBySize.empty() ? 0 : m_FreeBySize.rbegin()->first;
+		stats.freeBlocks = uint32_t(m_FreeByOffset.size());
+		stats.allocations = uint32_t(m_Allocations.size());
+		return stats;
+	}
+};
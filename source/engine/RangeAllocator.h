@@ -0,0 +1,59 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <map>
+
+namespace croissant
+{
+	// Sub-allocates offsets from a fixed-size range, with no GPU dependency.
+	// Free blocks are indexed by offset, to merge neighbours on free, and by size, for best-fit allocation.
+	class RangeAllocator
+	{
+	public:
+		static constexpr uint64_t INVALID_OFFSET = ~0ull;
+
+		struct Stats
+		{
+			uint64_t totalSize = 0;
+			uint64_t usedSize = 0;			// Including alignment padding
+			uint64_t largestFreeBlock = 0;
+			uint32_t freeBlocks = 0;
+			uint32_t allocations = 0;
+
+			// 0 when all free space is one block, approaching 1 as it splinters
+			float GetFragmentation() const
+			{
+				const uint64_t freeSize = totalSize - usedSize;
+				return freeSize == 0 ? 0.0f : 1.0f - float(double(largestFreeBlock) / double(freeSize));
+			}
+		};
+
+		explicit RangeAllocator(uint64_t size = 0);
+
+		void Reset(uint64_t size);
+
+		// Returns the aligned offset of a new block, or INVALID_OFFSET if no free block fits
+		uint64_t Allocate(uint64_t size, uint64_t alignment = 1);
+
+		// Frees a block by the offset Allocate returned, INVALID_OFFSET is ignored
+		void Free(uint64_t offset);
+
+		Stats GetStats() const;
+
+	private:
+		struct Block
+		{
+			uint64_t start;		// Start of the reserved span, before alignment padding
+			uint64_t size;		// Size of the reserved span
+		};
+
+		void InsertFree(uint64_t offset, uint64_t size);
+		void EraseFree(std::map<uint64_t, uint64_t>::iterator block);
+
+		uint64_t m_Size = 0;
+		uint64_t m_Used = 0;
+		std::map<uint64_t, uint64_t> m_FreeByOffset;			// Offset -> size
+		std::multimap<uint64_t, uint64_t> m_FreeBySize;			// Size -> offset
+		std::unordered_map<uint64_t, Block> m_Allocations;		// Aligned offset -> reserved span
+	};
+};
@@ -0,0 +1,169 @@
+#include <engine/SDFBaker.h>
+#include <core/Threading.h>
+#include <core/log.h>
+
+namespace croissant
+{
+	namespace
+	{
+		int16_t EncodeDistance(float distance, float maxDistance)
+		{
+			return int16_t(std::lround(std::clamp(distance / maxDistance, -1.0f, 1.0f) * 32767.0f));
+		}
+	}
+
+	bool SDFBaker::Bake(const Mesh& mesh, const SDFBakeSettings& settings, SDFVolume& outVolume)
+	{
+		auto startTime = std::chrono::high_resolution_clock::now();
+		TriangleBVH bvh;
+		if (!bvh.Build(mesh))
+		{
+			logger::warning("SDFBaker::Bake: Could not build the triangle BVH.");
+			return false;
+		}
+		const double buildSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		if (!Bake(bvh, settings, outVolume))
+			return false;
+
+		m_Stats.buildSeconds = buildSeconds;
+		return true;
+	}
+
+	bool SDFBaker::Bake(const TriangleBVH& bvh, const SDFBakeSettings& settings, SDFVolume& outVolume)
+	{
+		m_Stats = Stats();
+		if (bvh.Empty() || settings.resolution == 0)
+		{
+			logger::warning("SDFBaker::Bake: Nothing to bake.");
+			return false;
+		}
+
+		auto startTime = std::chrono::high_resolution_clock::now();
+
+		// Padded bounds, cut into cubic voxels
+		const glm::vec3 extent = bvh.GetMaxBounds() - bvh.GetMinBounds();
+		const float largestExtent = std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-6f));
+		const glm::vec3 minBounds = bvh.GetMinBounds() - glm::vec3(largestExtent * settings.padding);
+		const glm::vec3 size = extent + glm::vec3(2.0f * largestExtent * settings.padding);
+		const float voxelSize = (largestExtent * (1.0f + 2.0f * settings.padding)) / float(settings.resolution);
+
+		outVolume.dimensions = glm::max(glm::uvec3(glm::ceil(size / voxelSize - 1e-3f)), glm::uvec3(1));
+		outVolume.origin = minBounds + glm::vec3(0.5f * voxelSize);
+		outVolume.voxelSize = voxelSize;
+		outVolume.maxDistance = settings.narrowBand > 0.0f ? settings.narrowBand : glm::length(glm::vec3(outVolume.dimensions) * voxelSize);
+		outVolume.voxels.resize(size_t(outVolume.dimensions.x) * outVolume.dimensions.y * outVolume.dimensions.z);
+
+		const glm::uvec3 dimensions = outVolume.dimensions;
+		const glm::uvec3 tiles = (dimensions + glm::uvec3(TILE_SIZE - 1)) / TILE_SIZE;
+		const size_t tileCount = size_t(tiles.x) * tiles.y * tiles.z;
+		const float maxDistance = outVolume.maxDistance;
+
+		std::atomic<uint64_t> evaluatedVoxels = 0;
+		std::atomic<uint32_t> skippedTiles = 0;
+		threading::ParallelFor(tileCount, 1, [&](size_t beginTile, size_t endTile)
+		{
+			uint64_t evaluated = 0;
+			uint32_t skipped = 0;
+			for (size_t tile = beginTile; tile < endTile; tile++)
+			{
+				const glm::uvec3 tileCoord(uint32_t(tile % tiles.x), uint32_t(tile / tiles.x % tiles.y), uint32_t(tile / (size_t(tiles.x) * tiles.y)));
+				const glm::uvec3 begin = tileCoord * TILE_SIZE;
+				const glm::uvec3 end = glm::min(begin + glm::uvec3(TILE_SIZE), dimensions);
+
+				// The distance at the tile centre plus the offset of a voxel bounds the distance of that voxel
+				const glm::vec3 centre = outVolume.origin + glm::vec3(begin + end - glm::uvec3(1)) * (0.5f * voxelSize);
+				const float halfDiagonal = glm::length(glm::vec3(end - begin - glm::uvec3(1))) * (0.5f * voxelSize);
+				TriangleBVH::ClosestPoint centreHit;
+				bvh.FindClosestPoint(centre, centreHit);
+				const float centreDistance = std::sqrt(centreHit.distanceSquared);
+
+				// No surface within the band anywhere in the tile, so every voxel is on the side of the centre
+				if (settings.narrowBand > 0.0f && centreDistance - halfDiagonal > settings.narrowBand)
+				{
+					const int16_t value = centreHit.inside ? -32767 : 32767;
+					for (uint32_t z = begin.z; z < end.z; z++)
+						for (uint32_t y = begin.y; y < end.y; y++)
+							std::fill_n(&outVolume.voxels[(size_t(z) * dimensions.y + y) * dimensions.x + begin.x], end.x - begin.x, value);
+					skipped++;
+					continue;
+				}
+
+				// Each voxel starts from the last evaluated one: its closest point bounds the search from above, at most
+				// one voxel step further than the answer, and its distance minus the step bounds it from below, which
+				// clamps voxels outside the band without a query
+				glm::vec3 previousPosition = centre;
+				glm::vec3 previousPoint = centreHit.point;
+				float previousDistance = centreDistance;
+				bool previousInside = centreHit.inside;
+				for (uint32_t z = begin.z; z < end.z; z++)
+				{
+					for (uint32_t y = begin.y; y < end.y; y++)
+					{
+						for (uint32_t x = begin.x; x < end.x; x++)
+						{
+							const glm::vec3 position = outVolume.origin + glm::vec3(x, y, z) * voxelSize;
+							const size_t voxel = (size_t(z) * dimensions.y + y) * dimensions.x + x;
+							if (settings.narrowBand > 0.0f && previousDistance - glm::length(position - previousPosition) > settings.narrowBand)
+							{
+								outVolume.voxels[voxel] = previousInside ? -32767 : 32767;
+								continue;
+							}
+
+							const glm::vec3 offset = position - previousPoint;
+							TriangleBVH::ClosestPoint hit;
+							if (!bvh.FindClosestPoint(position, hit, glm::dot(offset, offset) * 1.0001f + 1e-12f))
+								bvh.FindClosestPoint(position, hit);
+							evaluated++;
+
+							previousPosition = position;
+							previousPoint = hit.point;
+							previousDistance = std::sqrt(hit.distanceSquared);
+							previousInside = hit.inside;
+							outVolume.voxels[voxel] = EncodeDistance(hit.inside ? -previousDistance : previousDistance, maxDistance);
+						}
+					}
+				}
+			}
+			evaluatedVoxels += evaluated;
+			skippedTiles += skipped;
+		});
+
+		m_Stats.voxels = outVolume.voxels.size();
+		m_Stats.evaluatedVoxels = evaluatedVoxels;
+		m_Stats.tiles = uint32_t(tileCount);
+		m_Stats.skippedTiles = skippedTiles;
+		m_Stats.bakeSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		logger::info("Baked %ux%ux%u SDF from %u triangles in %.2f ms: %.2f Mvoxels/s, %llu voxels evaluated, %u of %u tiles outside the band.",
+			dimensions.x, dimensions.y, dimensions.z, bvh.GetTriangleCount(), m_Stats.bakeSeconds * 1000.0, m_Stats.GetVoxelsPerSecond() / 1e6,
+			(unsigned long long)m_Stats.evaluatedVoxels, m_Stats.skippedTiles, m_Stats.tiles);
+		return true;
+	}
+
+	bool SDFBaker::Write(vfs::IFileSystem& fileSystem, const std::filesystem::path& path, const SDFVolume& volume)
+	{
+		FileHeader header = {};
+		header.magic = FILE_MAGIC;
+		header.version = FILE_VERSION;
+		for (int i = 0; i < 3; i++)
+		{
+			header.dimensions[i] = volume.dimensions[i];
+			header.origin[i] = volume.origin[i];
+		}
+		header.voxelSize = volume.voxelSize;
+		header.maxDistance = volume.maxDistance;
+
+		const size_t voxelBytes = volume.voxels.size() * sizeof(int16_t);
+		std::vector<uint8_t> data(sizeof(header) + voxelBytes);
+		memcpy(data.data(), &header, sizeof(header));
+		memcpy(data.data() + sizeof(header), volume.voxels.data(), voxelBytes);
+
+		if (!fileSystem.writeFile(path, data.data(), data.size()))
+		{
+			logger::warning("SDFBaker::Write: Failed to write %s.", path.generic_string().c_str());
+			return false;
+		}
+		return true;
+	}
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <core/VFS.h>
+#include <engine/TriangleBVH.h>
+
+namespace croissant
+{
+	struct SDFBakeSettings
+	{
+		uint32_t resolution = 64;	// Voxels along the longest axis of the padded bounds
+		float    padding = 0.05f;	// Added around the mesh bounds on every side, as a fraction of the largest extent
+		float    narrowBand = 0.0f;	// World units. Tiles further than this from the surface are filled with +-narrowBand
+									// without evaluating their voxels, and the volume only encodes the band. 0 bakes it all
+	};
+
+	// Signed distance volume, x varying fastest. Distances are stored as snorm16 of distance / maxDistance and are
+	// negative inside, so the voxels upload as-is to an R16_SNORM 3D texture
+	struct SDFVolume
+	{
+		glm::uvec3 dimensions = glm::uvec3(0);
+		glm::vec3  origin = glm::vec3(0.0f);	// Centre of voxel (0, 0, 0)
+		float      voxelSize = 0.0f;
+		float      maxDistance = 0.0f;			// Distance encoded by +-32767
+		std::vector<int16_t> voxels;
+
+		float GetDistance(uint32_t x, uint32_t y, uint32_t z) const
+		{
+			return float(voxels[(size_t(z) * dimensions.y + y) * dimensions.x + x]) / 32767.0f * maxDistance;
+		}
+	};
+
+	// Bakes signed distance volumes from meshes on the CPU. The grid is split into TILE_SIZE^3 tiles evaluated in
+	// parallel; each tile queries the distance at its centre first, which bounds the search of every voxel inside it
+	// and, in narrow-band mode, skips whole tiles away from the surface. Signs come from the pseudonormals of
+	// TriangleBVH, so the mesh should be closed
+	class SDFBaker
+	{
+	public:
+		static constexpr uint32_t TILE_SIZE = 8;
+		static constexpr uint32_t FILE_MAGIC = 0x46445343;	// "CSDF"
+		static constexpr uint32_t FILE_VERSION = 1;
+
+		struct Stats
+		{
+			uint64_t voxels = 0;
+			uint64_t evaluatedVoxels = 0;	// Voxels that ran a closest point query
+			uint32_t tiles = 0;
+			uint32_t skippedTiles = 0;		// Narrow band only
+			double   buildSeconds = 0.0;	// BVH build, 0 when baking from a prebuilt one
+			double   bakeSeconds = 0.0;
+
+			double GetVoxelsPerSecond() const { return bakeSeconds > 0.0 ? double(voxels) / bakeSeconds : 0.0; }
+		};
+
+		bool Bake(const Mesh& mesh, const SDFBakeSettings& settings, SDFVolume& outVolume);
+		bool Bake(const TriangleBVH& bvh, const SDFBakeSettings& settings, SDFVolume& outVolume);
+
+		// Writes the volume as a small header followed by the raw voxels
+		static bool Write(vfs::IFileSystem& fileSystem, const std::filesystem::path& path, const SDFVolume& volume);
+
+		const Stats& GetLastStats() const { return m_Stats; }
+
+	private:
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t dimensions[3];
+			float    origin[3];
+			float    voxelSize;
+			float    maxDistance;
+		};
+
+		Stats m_Stats;
+	};
+};
@@ -0,0 +1,230 @@
+#include <engine/Skinning.h>
+#include <core/Threading.h>
+
+namespace croissant
+{
+	SkinningEngine::SkinningEngine(const Mesh& mesh)
+		: m_VertexCount(uint32_t(mesh.vertices.size()))
+		, m_BoneCount(uint32_t(mesh.bones.size()))
+	{
+		assert(mesh.skin.size() == mesh.vertices.size());
+
+		m_PositionX.resize(m_VertexCount);
+		m_PositionY.resize(m_VertexCount);
+		m_PositionZ.resize(m_VertexCount);
+		m_NormalX.resize(m_VertexCount);
+		m_NormalY.resize(m_VertexCount);
+		m_NormalZ.resize(m_VertexCount);
+		m_UVs.resize(m_VertexCount);
+		for (int k = 0; k < 4; k++)
+		{
+			m_Bones[k].resize(m_VertexCount);
+			m_Weights[k].resize(m_VertexCount);
+		}
+
+		const uint32_t blockCount = (m_VertexCount + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		m_BoneBlocks.resize(m_BoneCount + 1);
+
+		for (uint32_t i = 0; i < m_VertexCount; i++)
+		{
+			const Vertex& v = mesh.vertices[i];
+			m_PositionX[i] = v.position.x;
+			m_PositionY[i] = v.position.y;
+			m_PositionZ[i] = v.position.z;
+			m_NormalX[i] = v.normal.x;
+			m_NormalY[i] = v.normal.y;
+			m_NormalZ[i] = v.normal.z;
+			m_UVs[i] = v.uv;
+
+			for (int k = 0; k < 4; k++)
+			{
+				// Out-of-range bones fall back to the identity entry
+				uint16_t bone = std::min<uint16_t>(mesh.skin[i].bones[k], uint16_t(m_BoneCount));
+				m_Bones[k][i] = bone;
+				m_Weights[k][i] = mesh.skin[i].weights[k];
+
+				std::vector<uint32_t>& blocks = m_BoneBlocks[bone];
+				if (mesh.skin[i].weights[k] != 0 && (blocks.empty() || blocks.back() != i / BLOCK_SIZE))
+					blocks.push_back(i / BLOCK_SIZE);
+			}
+		}
+
+		// Start from the bind pose with every block pending
+		m_Palette.assign(size_t(m_BoneCount + 1) * 12, 0.0f);
+		for (uint32_t b = 0; b <= m_BoneCount; b++)
+		{
+			m_Palette[b * 12 + 0] = m_Palette[b * 12 + 5] = m_Palette[b * 12 + 10] = 1.0f;
+		}
+
+		m_DirtyBlocks.assign(blockCount, 1);
+		m_DirtyBlockCount = blockCount;
+	}
+
+	VertexSkin SkinningEngine::PackInfluences(const uint32_t* bones, const float* weights, uint32_t count, uint16_t identityBone)
+	{
+		// Four largest influences, insertion sorted
+		uint32_t topBones[4] = { 0, 0, 0, 0 };
+		float topWeights[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (!(weights[i] > 0.0f) || bones[i] >= identityBone)
+				continue;
+
+			for (int k = 0; k < 4; k++)
+			{
+				if (weights[i] > topWeights[k])
+				{
+					for (int j = 3; j > k; j--)
+					{
+						topWeights[j] = topWeights[j - 1];
+						topBones[j] = topBones[j - 1];
+					}
+					topWeights[k] = weights[i];
+					topBones[k] = bones[i];
+					break;
+				}
+			}
+		}
+
+		VertexSkin skin = {};
+		const float total = topWeights[0] + topWeights[1] + topWeights[2] + topWeights[3];
+		if (total <= 0.0f)
+		{
+			skin.bones[0] = identityBone;
+			skin.weights[0] = 255;
+			return skin;
+		}
+
+		// Round each weight, then give the rounding error to the largest so the sum is exact
+		int sum = 0;
+		for (int k = 0; k < 4; k++)
+		{
+			skin.bones[k] = uint16_t(topBones[k]);
+			skin.weights[k] = uint8_t(std::lround(topWeights[k] / total * 255.0f));
+			sum += skin.weights[k];
+		}
+		skin.weights[0] = uint8_t(int(skin.weights[0]) + 255 - sum);
+
+		return skin;
+	}
+
+	void SkinningEngine::SetBoneMatrices(const glm::mat4* matrices, uint32_t count)
+	{
+		count = std::min(count, m_BoneCount);
+		for (uint32_t b = 0; b < count; b++)
+		{
+			// glm is column-major, the palette stores rows
+			const glm::mat4& m = matrices[b];
+			const float rows[12] = {
+				m[0][0], m[1][0], m[2][0], m[3][0],
+				m[0][1], m[1][1], m[2][1], m[3][1],
+				m[0][2], m[1][2], m[2][2], m[3][2] };
+
+			float* entry = &m_Palette[size_t(b) * 12];
+			if (memcmp(entry, rows, sizeof(rows)) == 0)
+				continue;
+
+			memcpy(entry, rows, sizeof(rows));
+			for (uint32_t block : m_BoneBlocks[b])
+			{
+				m_DirtyBlockCount += m_DirtyBlocks[block] ^ 1;
+				m_DirtyBlocks[block] = 1;
+			}
+		}
+	}
+
+	void SkinningEngine::MarkDirty(uint32_t begin, uint32_t end)
+	{
+		end = std::min(end, m_VertexCount);
+		if (begin >= end)
+			return;
+
+		for (uint32_t block = begin / BLOCK_SIZE; block <= (end - 1) / BLOCK_SIZE; block++)
+		{
+			m_DirtyBlockCount += m_DirtyBlocks[block] ^ 1;
+			m_DirtyBlocks[block] = 1;
+		}
+	}
+
+	void SkinningEngine::SkinRange(uint32_t begin, uint32_t end, Vertex* dst) const
+	{
+		constexpr float weightScale = 1.0f / 255.0f;
+		const float* palette = m_Palette.data();
+
+		for (uint32_t i = begin; i < end; i++)
+		{
+			const float* m0 = palette + size_t(m_Bones[0][i]) * 12;
+			const float* m1 = palette + size_t(m_Bones[1][i]) * 12;
+			const float* m2 = palette + size_t(m_Bones[2][i]) * 12;
+			const float* m3 = palette + size_t(m_Bones[3][i]) * 12;
+			const float w0 = float(m_Weights[0][i]) * weightScale;
+			const float w1 = float(m_Weights[1][i]) * weightScale;
+			const float w2 = float(m_Weights[2][i]) * weightScale;
+			const float w3 = float(m_Weights[3][i]) * weightScale;
+
+			float m[12];
+			for (int k = 0; k < 12; k++)
+				m[k] = w0 * m0[k] + w1 * m1[k] + w2 * m2[k] + w3 * m3[k];
+
+			const float x = m_PositionX[i], y = m_PositionY[i], z = m_PositionZ[i];
+			const float nx = m_NormalX[i], ny = m_NormalY[i], nz = m_NormalZ[i];
+
+			glm::vec3 position(
+				m[0] * x + m[1] * y + m[2] * z + m[3],
+				m[4] * x + m[5] * y + m[6] * z + m[7],
+				m[8] * x + m[9] * y + m[10] * z + m[11]);
+
+			// The blended matrix is used for normals too, exact for rotations and uniform scale
+			glm::vec3 normal(
+				m[0] * nx + m[1] * ny + m[2] * nz,
+				m[4] * nx + m[5] * ny + m[6] * nz,
+				m[8] * nx + m[9] * ny + m[10] * nz);
+			normal *= 1.0f / std::sqrt(std::max(glm::dot(normal, normal), 1e-20f));
+
+			dst[i] = Vertex{ position, m_UVs[i], normal };
+		}
+	}
+
+	void SkinningEngine::Skin(Vertex* dst, std::vector<VertexRange>& outRanges)
+	{
+		auto startTime = std::chrono::high_resolution_clock::now();
+		outRanges.clear();
+
+		std::vector<uint32_t> dirtyBlocks;
+		dirtyBlocks.reserve(m_DirtyBlockCount);
+		for (uint32_t block = 0; block < uint32_t(m_DirtyBlocks.size()); block++)
+		{
+			if (m_DirtyBlocks[block])
+				dirtyBlocks.push_back(block);
+		}
+
+		threading::ParallelFor(dirtyBlocks.size(), 8, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				const uint32_t first = dirtyBlocks[i] * BLOCK_SIZE;
+				SkinRange(first, std::min(first + BLOCK_SIZE, m_VertexCount), dst);
+			}
+		});
+
+		uint64_t verticesSkinned = 0;
+		for (uint32_t block : dirtyBlocks)
+		{
+			const uint32_t first = block * BLOCK_SIZE;
+			const uint32_t last = std::min(first + BLOCK_SIZE, m_VertexCount);
+			verticesSkinned += last - first;
+
+			if (!outRanges.empty() && outRanges.back().end == first)
+				outRanges.back().end = last;
+			else
+				outRanges.push_back(VertexRange{ first, last });
+
+			m_DirtyBlocks[block] = 0;
+		}
+		m_DirtyBlockCount = 0;
+
+		m_Stats.dirtyBlocks = uint32_t(dirtyBlocks.size());
+		m_Stats.verticesSkinned = verticesSkinned;
+		m_Stats.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+	}
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <engine/MeshOperations.h>
+
+namespace croissant
+{
+	// Linear blend skinning on the CPU.
+	// The bind pose is kept as structure-of-arrays streams so the kernel is a branch-free loop over vertices.
+	// Vertices are tracked in blocks: only blocks influenced by a bone whose matrix changed, or marked explicitly,
+	// are re-skinned. Results are written as Vertex so they can go straight into a mapped upload buffer.
+	class SkinningEngine
+	{
+	public:
+		static constexpr uint32_t BLOCK_SIZE = 1024; // Vertices per dirty-tracking block
+
+		struct VertexRange
+		{
+			uint32_t begin, end;
+		};
+
+		struct Stats
+		{
+			uint32_t dirtyBlocks = 0;
+			uint64_t verticesSkinned = 0;
+			double   seconds = 0.0;
+		};
+
+		explicit SkinningEngine(const Mesh& mesh);
+
+		// Keeps the four largest influences, normalises them and quantises the weights so they sum to exactly 255.
+		// Vertices without influences are bound to identityBone with full weight.
+		static VertexSkin PackInfluences(const uint32_t* bones, const float* weights, uint32_t count, uint16_t identityBone);
+
+		uint32_t GetVertexCount() const { return m_VertexCount; }
+		uint32_t GetBoneCount() const { return m_BoneCount; }
+
+		// Sets the skinning matrix (bone world transform * offset matrix) of the first count bones.
+		// Blocks influenced by a bone whose matrix changed are marked dirty.
+		void SetBoneMatrices(const glm::mat4* matrices, uint32_t count);
+
+		// Forces [begin, end) to be re-skinned by the next Skin call
+		void MarkDirty(uint32_t begin, uint32_t end);
+		bool IsDirty() const { return m_DirtyBlockCount > 0; }
+
+		// Skins every dirty block in parallel into dst, which holds one Vertex per mesh vertex.
+		// outRanges receives the coalesced vertex ranges that were written, in ascending order.
+		void Skin(Vertex* dst, std::vector<VertexRange>& outRanges);
+
+		// Skins [begin, end) on the calling thread, regardless of dirty state
+		void SkinRange(uint32_t begin, uint32_t end, Vertex* dst) const;
+
+		const Stats& GetLastStats() const { return m_Stats; }
+
+	private:
+		uint32_t m_VertexCount = 0;
+		uint32_t m_BoneCount = 0;		// Mesh bones, the palette has one more identity entry after them
+
+		// Bind pose streams
+		std::vector<float> m_PositionX, m_PositionY, m_PositionZ;
+		std::vector<float> m_NormalX, m_NormalY, m_NormalZ;
+		std::vector<glm::vec2> m_UVs;
+		std::vector<uint16_t> m_Bones[4];
+		std::vector<uint8_t> m_Weights[4];
+
+		// Skinning matrices as 3x4 rows, 12 floats per bone
+		std::vector<float> m_Palette;
+
+		std::vector<std::vector<uint32_t>> m_BoneBlocks; // Blocks each bone influences
+		std::vector<uint8_t> m_DirtyBlocks;
+		uint32_t m_DirtyBlockCount = 0;
+
+		Stats m_Stats;
+	};
+};
@@ -0,0 +1,392 @@
+#include <engine/TriangleBVH.h>
+#include <core/log.h>
+
+namespace croissant
+{
+	namespace
+	{
+		struct PositionKey
+		{
+			glm::vec3 position;
+			bool operator==(const PositionKey& other) const { return position == other.position; }
+		};
+
+		struct PositionKeyHash
+		{
+			size_t operator()(const PositionKey& key) const
+			{
+				uint32_t bits[3];
+				memcpy(bits, &key.position, sizeof(bits));
+				return (size_t(bits[0]) * 73856093u) ^ (size_t(bits[1]) * 19349663u) ^ (size_t(bits[2]) * 83492791u);
+			}
+		};
+
+		// Feature of a triangle nearest to a point
+		enum ClosestFeature : uint32_t
+		{
+			FEATURE_FACE,
+			FEATURE_VERTEX0, FEATURE_VERTEX1, FEATURE_VERTEX2,
+			FEATURE_EDGE01, FEATURE_EDGE12, FEATURE_EDGE20,
+		};
+
+		// Closest point on triangle abc to p, from Ericson, Real-Time Collision Detection 5.1.5
+		glm::vec3 ClosestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, ClosestFeature& outFeature)
+		{
+			const glm::vec3 ab = b - a;
+			const glm::vec3 ac = c - a;
+			const glm::vec3 ap = p - a;
+			const float d1 = glm::dot(ab, ap);
+			const float d2 = glm::dot(ac, ap);
+			if (d1 <= 0.0f && d2 <= 0.0f)
+			{
+				outFeature = FEATURE_VERTEX0;
+				return a;
+			}
+
+			const glm::vec3 bp = p - b;
+			const float d3 = glm::dot(ab, bp);
+			const float d4 = glm::dot(ac, bp);
+			if (d3 >= 0.0f && d4 <= d3)
+			{
+				outFeature = FEATURE_VERTEX1;
+				return b;
+			}
+
+			const float vc = d1 * d4 - d3 * d2;
+			if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+			{
+				outFeature = FEATURE_EDGE01;
+				return a + ab * (d1 / (d1 - d3));
+			}
+
+			const glm::vec3 cp = p - c;
+			const float d5 = glm::dot(ab, cp);
+			const float d6 = glm::dot(ac, cp);
+			if (d6 >= 0.0f && d5 <= d6)
+			{
+				outFeature = FEATURE_VERTEX2;
+				return c;
+			}
+
+			const float vb = d5 * d2 - d1 * d6;
+			if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+			{
+				outFeature = FEATURE_EDGE20;
+				return a + ac * (d2 / (d2 - d6));
+			}
+
+			const float va = d3 * d6 - d5 * d4;
+			if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+			{
+				outFeature = FEATURE_EDGE12;
+				return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+			}
+
+			const float denominator = 1.0f / (va + vb + vc);
+			outFeature = FEATURE_FACE;
+			return a + ab * (vb * denominator) + ac * (vc * denominator);
+		}
+
+		// Slab test of the ray against a box, clipped to [0, maxDistance]
+		bool RayHitsBox(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, const glm::vec3& minBounds, const glm::vec3& maxBounds)
+		{
+			const glm::vec3 t0 = (minBounds - origin) * inverseDirection;
+			const glm::vec3 t1 = (maxBounds - origin) * inverseDirection;
+			const glm::vec3 tMin = glm::min(t0, t1);
+			const glm::vec3 tMax = glm::max(t0, t1);
+			const float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+			const float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+			return enter <= exit;
+		}
+
+		// Moller-Trumbore, both faces
+		bool RayHitsTriangle(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2)
+		{
+			const glm::vec3 e1 = p1 - p0;
+			const glm::vec3 e2 = p2 - p0;
+			const glm::vec3 p = glm::cross(direction, e2);
+			const float determinant = glm::dot(e1, p);
+			if (std::abs(determinant) < 1e-12f)
+				return false;
+
+			const float inverseDeterminant = 1.0f / determinant;
+			const glm::vec3 s = origin - p0;
+			const float u = glm::dot(s, p) * inverseDeterminant;
+			if (u < 0.0f || u > 1.0f)
+				return false;
+
+			const glm::vec3 q = glm::cross(s, e1);
+			const float v = glm::dot(direction, q) * inverseDeterminant;
+			if (v < 0.0f || u + v > 1.0f)
+				return false;
+
+			const float t = glm::dot(e2, q) * inverseDeterminant;
+			return t > 0.0f && t < maxDistance;
+		}
+
+		float BoxDistanceSquared(const glm::vec3& p, const glm::vec3& minBounds, const glm::vec3& maxBounds)
+		{
+			const glm::vec3 d = glm::max(glm::max(minBounds - p, p - maxBounds), glm::vec3(0.0f));
+			return glm::dot(d, d);
+		}
+	}
+
+	bool TriangleBVH::Build(const Mesh& mesh)
+	{
+		m_Nodes.clear();
+		m_Triangles.clear();
+		m_Normals.clear();
+
+		const size_t triangleCount = mesh.indices.size() / 3;
+		if (triangleCount == 0)
+		{
+			logger::warning("TriangleBVH::Build: Mesh has no triangles.");
+			return false;
+		}
+
+		// Weld by position so seams share pseudonormals
+		std::unordered_map<PositionKey, uint32_t, PositionKeyHash> weldMap;
+		weldMap.reserve(mesh.vertices.size());
+		std::vector<uint32_t> welded(mesh.vertices.size());
+		for (size_t v = 0; v < mesh.vertices.size(); v++)
+			welded[v] = weldMap.emplace(PositionKey{ mesh.vertices[v].position }, uint32_t(weldMap.size())).first->second;
+
+		// Angle-weighted vertex normals and summed edge normals (Baerentzen and Aanaes), over non-degenerate faces only
+		std::vector<glm::vec3> vertexNormals(weldMap.size(), glm::vec3(0.0f));
+		std::unordered_map<EdgeKey, glm::vec3, EdgeKeyHash> edgeNormals;
+		edgeNormals.reserve(mesh.indices.size());
+
+		std::vector<uint32_t> kept;
+		std::vector<glm::vec3> faceNormals;
+		kept.reserve(triangleCount);
+		faceNormals.reserve(triangleCount);
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			const uint32_t* corners = &mesh.indices[t * 3];
+			glm::vec3 normal = glm::cross(mesh.vertices[corners[1]].position - mesh.vertices[corners[0]].position,
+				mesh.vertices[corners[2]].position - mesh.vertices[corners[0]].position);
+			const float length = glm::length(normal);
+			if (!(length > 0.0f))
+				continue;
+
+			normal /= length;
+			kept.push_back(uint32_t(t));
+			faceNormals.push_back(normal);
+			for (int k = 0; k < 3; k++)
+			{
+				const glm::vec3& p = mesh.vertices[corners[k]].position;
+				const glm::vec3 a = glm::normalize(mesh.vertices[corners[(k + 1) % 3]].position - p);
+				const glm::vec3 b = glm::normalize(mesh.vertices[corners[(k + 2) % 3]].position - p);
+				vertexNormals[welded[corners[k]]] += normal * std::acos(std::clamp(glm::dot(a, b), -1.0f, 1.0f));
+
+				auto [edge, added] = edgeNormals.emplace(EdgeKey(welded[corners[k]], welded[corners[(k + 1) % 3]]), normal);
+				if (!added)
+					edge->second += normal;
+			}
+		}
+
+		if (kept.empty())
+		{
+			logger::warning("TriangleBVH::Build: Every triangle is degenerate.");
+			return false;
+		}
+
+		std::vector<Triangle> triangles(kept.size());
+		std::vector<PseudoNormals> normals(kept.size());
+		std::vector<glm::vec3> centroids(kept.size());
+		for (size_t i = 0; i < kept.size(); i++)
+		{
+			const uint32_t* corners = &mesh.indices[size_t(kept[i]) * 3];
+			triangles[i] = { mesh.vertices[corners[0]].position, mesh.vertices[corners[1]].position, mesh.vertices[corners[2]].position, kept[i] };
+			centroids[i] = (triangles[i].p0 + triangles[i].p1 + triangles[i].p2) / 3.0f;
+
+			normals[i].face = faceNormals[i];
+			for (int k = 0; k < 3; k++)
+			{
+				normals[i].edges[k] = edgeNormals[EdgeKey(welded[corners[k]], welded[corners[(k + 1) % 3]])];
+				normals[i].vertices[k] = vertexNormals[welded[corners[k]]];
+			}
+		}
+
+		std::vector<uint32_t> order(kept.size());
+		for (uint32_t i = 0; i < order.size(); i++)
+			order[i] = i;
+
+		m_Nodes.reserve(2 * kept.size() / MAX_LEAF_TRIANGLES + 1);
+		BuildNode(0, uint32_t(order.size()), triangles, centroids, order);
+
+		m_Triangles.resize(order.size());
+		m_Normals.resize(order.size());
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			m_Triangles[i] = triangles[order[i]];
+			m_Normals[i] = normals[order[i]];
+		}
+
+		logger::info("TriangleBVH: %zu triangles, %zu nodes, %zu welded vertices.", m_Triangles.size(), m_Nodes.size(), vertexNormals.size());
+		return true;
+	}
+
+	uint32_t TriangleBVH::BuildNode(uint32_t first, uint32_t count, const std::vector<Triangle>& triangles, const std::vector<glm::vec3>& centroids, std::vector<uint32_t>& order)
+	{
+		const uint32_t index = uint32_t(m_Nodes.size());
+		m_Nodes.emplace_back();
+
+		glm::vec3 minBounds(std::numeric_limits<float>::max()), maxBounds(-std::numeric_limits<float>::max());
+		glm::vec3 minCentroid = minBounds, maxCentroid = maxBounds;
+		for (uint32_t i = first; i < first + count; i++)
+		{
+			const Triangle& triangle = triangles[order[i]];
+			minBounds = glm::min(minBounds, glm::min(triangle.p0, glm::min(triangle.p1, triangle.p2)));
+			maxBounds = glm::max(maxBounds, glm::max(triangle.p0, glm::max(triangle.p1, triangle.p2)));
+			minCentroid = glm::min(minCentroid, centroids[order[i]]);
+			maxCentroid = glm::max(maxCentroid, centroids[order[i]]);
+		}
+		m_Nodes[index].minBounds = minBounds;
+		m_Nodes[index].maxBounds = maxBounds;
+
+		if (count <= MAX_LEAF_TRIANGLES)
+		{
+			m_Nodes[index].first = first;
+			m_Nodes[index].count = count;
+			return index;
+		}
+
+		// Median split along the longest axis of the centroids
+		const glm::vec3 extent = maxCentroid - minCentroid;
+		const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+		const uint32_t half = count / 2;
+		std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+			[&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+
+		BuildNode(first, half, triangles, centroids, order);
+		const uint32_t right = BuildNode(first + half, count - half, triangles, centroids, order);
+		m_Nodes[index].first = right;
+		m_Nodes[index].count = 0;
+		return index;
+	}
+
+	bool TriangleBVH::FindClosestPoint(const glm::vec3& position, ClosestPoint& outResult, float maxDistanceSquared) const
+	{
+		if (m_Nodes.empty())
+			return false;
+
+		float best = maxDistanceSquared;
+		uint32_t bestTriangle = INVALID;
+		ClosestFeature bestFeature = FEATURE_FACE;
+		glm::vec3 bestPoint(0.0f);
+
+		// Nearer child first, subtrees further than the best hit so far are skipped
+		struct Entry
+		{
+			uint32_t node;
+			float distanceSquared;
+		};
+		Entry stack[64];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = { 0, BoxDistanceSquared(position, m_Nodes[0].minBounds, m_Nodes[0].maxBounds) };
+
+		while (stackSize > 0)
+		{
+			const Entry entry = stack[--stackSize];
+			if (entry.distanceSquared >= best)
+				continue;
+
+			const Node& node = m_Nodes[entry.node];
+			if (node.count > 0)
+			{
+				for (uint32_t t = node.first; t < node.first + node.count; t++)
+				{
+					// The distance to the plane of the triangle is a lower bound, and far cheaper than the closest point
+					const Triangle& triangle = m_Triangles[t];
+					const float planeDistance = glm::dot(position - triangle.p0, m_Normals[t].face);
+					if (planeDistance * planeDistance >= best)
+						continue;
+
+					ClosestFeature feature;
+					const glm::vec3 point = ClosestPointOnTriangle(position, triangle.p0, triangle.p1, triangle.p2, feature);
+					const glm::vec3 offset = position - point;
+					const float distanceSquared = glm::dot(offset, offset);
+					if (distanceSquared < best)
+					{
+						best = distanceSquared;
+						bestTriangle = t;
+						bestFeature = feature;
+						bestPoint = point;
+					}
+				}
+				continue;
+			}
+
+			const uint32_t left = entry.node + 1;
+			const uint32_t right = node.first;
+			const float leftDistance = BoxDistanceSquared(position, m_Nodes[left].minBounds, m_Nodes[left].maxBounds);
+			const float rightDistance = BoxDistanceSquared(position, m_Nodes[right].minBounds, m_Nodes[right].maxBounds);
+			if (leftDistance < rightDistance)
+			{
+				stack[stackSize++] = { right, rightDistance };
+				stack[stackSize++] = { left, leftDistance };
+			}
+			else
+			{
+				stack[stackSize++] = { left, leftDistance };
+				stack[stackSize++] = { right, rightDistance };
+			}
+		}
+
+		if (bestTriangle == INVALID)
+			return false;
+
+		const PseudoNormals& normals = m_Normals[bestTriangle];
+		glm::vec3 pseudoNormal;
+		switch (bestFeature)
+		{
+		case FEATURE_VERTEX0: pseudoNormal = normals.vertices[0]; break;
+		case FEATURE_VERTEX1: pseudoNormal = normals.vertices[1]; break;
+		case FEATURE_VERTEX2: pseudoNormal = normals.vertices[2]; break;
+		case FEATURE_EDGE01: pseudoNormal = normals.edges[0]; break;
+		case FEATURE_EDGE12: pseudoNormal = normals.edges[1]; break;
+		case FEATURE_EDGE20: pseudoNormal = normals.edges[2]; break;
+		default: pseudoNormal = normals.face; break;
+		}
+
+		outResult.point = bestPoint;
+		outResult.distanceSquared = best;
+		outResult.triangle = m_Triangles[bestTriangle].source;
+		outResult.inside = glm::dot(position - bestPoint, pseudoNormal) < 0.0f;
+		return true;
+	}
+
+	bool TriangleBVH::IsOccluded(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const
+	{
+		if (m_Nodes.empty())
+			return false;
+
+		const glm::vec3 inverseDirection = 1.0f / direction;
+		uint32_t stack[64];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const Node& node = m_Nodes[stack[--stackSize]];
+			if (!RayHitsBox(origin, inverseDirection, maxDistance, node.minBounds, node.maxBounds))
+				continue;
+
+			if (node.count == 0)
+			{
+				stack[stackSize++] = node.first;
+				stack[stackSize++] = uint32_t(&node - m_Nodes.data()) + 1;
+				continue;
+			}
+
+			for (uint32_t t = node.first; t < node.first + node.count; t++)
+			{
+				const Triangle& triangle = m_Triangles[t];
+				if (RayHitsTriangle(origin, direction, maxDistance, triangle.p0, triangle.p1, triangle.p2))
+					return true;
+			}
+		}
+		return false;
+	}
+};
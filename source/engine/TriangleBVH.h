@@ -0,0 +1,70 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <engine/MeshOperations.h>
+
+namespace croissant
+{
+	// Bounding volume hierarchy over the triangles of a Mesh for CPU queries (baking, picking, collision).
+	// Triangles are copied in leaf order so a leaf is one contiguous run. Vertices are welded by position, so
+	// UV and normal seams do not open the surface, and every triangle keeps the angle-weighted pseudonormals of
+	// its face, edges and vertices: the side of the closest feature gives the sign of the distance for closed meshes
+	class TriangleBVH
+	{
+	public:
+		static constexpr uint32_t MAX_LEAF_TRIANGLES = 4;
+
+		struct Node
+		{
+			glm::vec3 minBounds;
+			uint32_t  first;		// First triangle of a leaf, or the right child of an inner node (the left one follows it)
+			glm::vec3 maxBounds;
+			uint32_t  count;		// Triangles in a leaf, 0 for inner nodes
+		};
+
+		struct ClosestPoint
+		{
+			glm::vec3 point = glm::vec3(0.0f);
+			float     distanceSquared = std::numeric_limits<float>::max();
+			uint32_t  triangle = INVALID;		// Index into the mesh triangles (indices / 3)
+			bool      inside = false;			// Behind the pseudonormal of the closest feature
+		};
+
+		bool Build(const Mesh& mesh);
+
+		// Closest point on the surface to position, ignoring triangles further than sqrt(maxDistanceSquared).
+		// Returns false when there is none
+		bool FindClosestPoint(const glm::vec3& position, ClosestPoint& outResult, float maxDistanceSquared = std::numeric_limits<float>::max()) const;
+
+		// Any-hit ray query: true when a triangle is hit at a distance in (0, maxDistance) along the unit direction.
+		// Both faces count, for occlusion and visibility tests
+		bool IsOccluded(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const;
+
+		bool Empty() const { return m_Nodes.empty(); }
+		uint32_t GetTriangleCount() const { return uint32_t(m_Triangles.size()); }
+		const std::vector<Node>& GetNodes() const { return m_Nodes; }
+		glm::vec3 GetMinBounds() const { return m_Nodes.empty() ? glm::vec3(0.0f) : m_Nodes[0].minBounds; }
+		glm::vec3 GetMaxBounds() const { return m_Nodes.empty() ? glm::vec3(0.0f) : m_Nodes[0].maxBounds; }
+
+	private:
+		struct Triangle
+		{
+			glm::vec3 p0, p1, p2;
+			uint32_t  source;			// Triangle index in the mesh
+		};
+
+		// Face, edge (p0p1, p1p2, p2p0) and vertex pseudonormals of a triangle, in leaf order like m_Triangles
+		struct PseudoNormals
+		{
+			glm::vec3 face;
+			glm::vec3 edges[3];
+			glm::vec3 vertices[3];
+		};
+
+		uint32_t BuildNode(uint32_t first, uint32_t count, const std::vector<Triangle>& triangles, const std::vector<glm::vec3>& centroids, std::vector<uint32_t>& order);
+
+		std::vector<Node> m_Nodes;
+		std::vector<Triangle> m_Triangles;
+		std::vector<PseudoNormals> m_Normals;
+	};
+};
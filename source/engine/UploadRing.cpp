@@ -0,0 +1,66 @@
+#include <engine/UploadRing.h>
+#include <core/log.h>
+
+namespace croissant
+{
+	UploadRing::~UploadRing()
+	{
+		if (m_Mapped)
+			m_Device->unmapBuffer(m_Buffer);
+	}
+
+	bool UploadRing::Init(nvrhi::IDevice* device, uint64_t segmentSize, uint32_t segmentCount)
+	{
+		m_Device = device;
+		m_SegmentSize = (segmentSize + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+		m_SegmentCount = std::max(segmentCount, 1u);
+
+		nvrhi::BufferDesc desc;
+		desc.byteSize = m_SegmentSize * m_SegmentCount;
+		desc.debugName = "UploadRing";
+		desc.cpuAccess = nvrhi::CpuAccessMode::Write;
+		desc.enableAutomaticStateTracking(nvrhi::ResourceStates::CopySource);
+		m_Buffer = device->createBuffer(desc);
+
+		m_Mapped = m_Buffer ? static_cast<uint8_t*>(device->mapBuffer(m_Buffer, nvrhi::CpuAccessMode::Write)) : nullptr;
+		if (!m_Mapped)
+		{
+			logger::warning("Failed to create the %llu byte upload ring.", (unsigned long long)desc.byteSize);
+			return false;
+		}
+		return true;
+	}
+
+	void UploadRing::BeginFrame(uint32_t frameIndex)
+	{
+		if (frameIndex == m_FrameIndex)
+			return;
+
+		m_FrameIndex = frameIndex;
+		m_SegmentOffset = uint64_t(frameIndex % m_SegmentCount) * m_SegmentSize;
+		m_Used = 0;
+		m_Stats = FrameStats();
+	}
+
+	void UploadRing::Upload(nvrhi::ICommandList* commandList, nvrhi::IBuffer* dst, uint64_t dstOffset, const void* data, uint64_t size)
+	{
+		if (size == 0)
+			return;
+
+		const uint64_t staged = std::min(size, m_Used < m_SegmentSize ? m_SegmentSize - m_Used : 0);
+		if (staged > 0)
+		{
+			memcpy(m_Mapped + m_SegmentOffset + m_Used, data, staged);
+			commandList->copyBuffer(dst, dstOffset, m_Buffer, m_SegmentOffset + m_Used, staged);
+			m_Used = (m_Used + staged + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+			m_Stats.bytesStaged += staged;
+			m_Stats.copies++;
+		}
+
+		if (staged < size)
+		{
+			commandList->writeBuffer(dst, static_cast<const uint8_t*>(data) + staged, size - staged, dstOffset + staged);
+			m_Stats.bytesOverflowed += size - staged;
+		}
+	}
+};
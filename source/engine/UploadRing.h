@@ -0,0 +1,50 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <nvrhi/nvrhi.h>
+
+namespace croissant
+{
+	// Persistent CPU-writable staging buffer for incremental GPU updates.
+	// The buffer stays mapped and is split into one segment per frame in flight; a frame only writes its own segment,
+	// which the GPU has finished reading by the time the frame index comes around again.
+	class UploadRing
+	{
+	public:
+		static constexpr uint64_t ALIGNMENT = 16;	// Of every staged copy
+
+		struct FrameStats
+		{
+			uint64_t bytesStaged = 0;		// Copied through the ring
+			uint64_t bytesOverflowed = 0;	// Did not fit the segment and went through writeBuffer instead
+			uint32_t copies = 0;
+		};
+
+		~UploadRing();
+
+		bool Init(nvrhi::IDevice* device, uint64_t segmentSize, uint32_t segmentCount);
+		bool IsInitialized() const { return m_Mapped != nullptr; }
+		uint64_t GetSegmentSize() const { return m_SegmentSize; }
+		uint32_t GetSegmentCount() const { return m_SegmentCount; }
+
+		// Switches to the segment of this frame. Calling it again within the same frame keeps appending
+		void BeginFrame(uint32_t frameIndex);
+
+		// Stages size bytes and records a copy into dst. Data that does not fit the segment is written with writeBuffer
+		void Upload(nvrhi::ICommandList* commandList, nvrhi::IBuffer* dst, uint64_t dstOffset, const void* data, uint64_t size);
+
+		const FrameStats& GetFrameStats() const { return m_Stats; }
+
+	private:
+		nvrhi::DeviceHandle m_Device;
+		nvrhi::BufferHandle m_Buffer;
+		uint8_t* m_Mapped = nullptr;
+		uint64_t m_SegmentSize = 0;
+		uint32_t m_SegmentCount = 0;
+
+		uint32_t m_FrameIndex = ~0u;
+		uint64_t m_SegmentOffset = 0;	// Start of the current segment in the buffer
+		uint64_t m_Used = 0;			// Bytes used in the current segment
+		FrameStats m_Stats;
+	};
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <core/stdafx.h>
+#include <nvrhi/nvrhi.h>
+#include <glm/gtc/packing.hpp>
+#include <engine/MeshOperations.h>
+
+namespace croissant
+{
+	// Vertex attributes usable in a VertexLayout. Each names its shader semantic, GPU format and storage type,
+	// and encodes itself from a Mesh Vertex. The packed variants read as the same float vectors in the shaders.
+	namespace vertex_attributes
+	{
+		struct Position
+		{
+			using Type = glm::vec3;
+			static constexpr const char* semantic = "POSITION";
+			static constexpr nvrhi::Format format = nvrhi::Format::RGB32_FLOAT;
+			static Type Encode(const Vertex& vertex) { return vertex.position; }
+		};
+
+		struct PositionHalf
+		{
+			using Type = uint64_t;
+			static constexpr const char* semantic = "POSITION";
+			static constexpr nvrhi::Format format = nvrhi::Format::RGBA16_FLOAT;
+			static Type Encode(const Vertex& vertex) { return glm::packHalf4x16(glm::vec4(vertex.position, 1.0f)); }
+		};
+
+		struct UV
+		{
+			using Type = glm::vec2;
+			static constexpr const char* semantic = "UV";
+			static constexpr nvrhi::Format format = nvrhi::Format::RG32_FLOAT;
+			static Type Encode(const Vertex& vertex) { return vertex.uv; }
+		};
+
+		struct UVHalf
+		{
+			using Type = uint32_t;
+			static constexpr const char* semantic = "UV";
+			static constexpr nvrhi::Format format = nvrhi::Format::RG16_FLOAT;
+			static Type Encode(const Vertex& vertex) { return glm::packHalf2x16(vertex.uv); }
+		};
+
+		struct Normal
+		{
+			using Type = glm::vec3;
+			static constexpr const char* semantic = "NORMAL";
+			static constexpr nvrhi::Format format = nvrhi::Format::RGB32_FLOAT;
+			static Type Encode(const Vertex& vertex) { return vertex.normal; }
+		};
+
+		struct NormalSnorm8
+		{
+			using Type = uint32_t;
+			static constexpr const char* semantic = "NORMAL";
+			static constexpr nvrhi::Format format = nvrhi::Format::RGBA8_SNORM;
+			static Type Encode(const Vertex& vertex) { return glm::packSnorm4x8(glm::vec4(vertex.normal, 0.0f)); }
+		};
+	};
+
+	// An interleaved vertex format built from attributes at compile time: offsets are the packed prefix sums
+	// of the attribute sizes, and the stride is their total.
+	template <typename... Attributes>
+	struct VertexLayout
+	{
+		static constexpr uint32_t AttributeCount = uint32_t(sizeof...(Attributes));
+		static constexpr uint32_t Stride = (uint32_t(sizeof(typename Attributes::Type)) + ... + 0);
+
+		static constexpr std::array<uint32_t, AttributeCount> Offsets = []()
+		{
+			const uint32_t sizes[] = { uint32_t(sizeof(typename Attributes::Type))... };
+			std::array<uint32_t, AttributeCount> offsets = {};
+			uint32_t offset = 0;
+			for (uint32_t i = 0; i < AttributeCount; i++)
+			{
+				offsets[i] = offset;
+				offset += sizes[i];
+			}
+			return offsets;
+		}();
+
+		static_assert(AttributeCount > 0, "A vertex layout needs at least one attribute");
+		static_assert(((sizeof(typename Attributes::Type) % 4 == 0) && ...), "Vertex elements must stay 4-byte aligned");
+
+		// Descriptors of every attribute, all read from one buffer slot
+		static std::array<nvrhi::VertexAttributeDesc, AttributeCount> GetAttributeDescs(uint32_t bufferIndex)
+		{
+			const char* semantics[] = { Attributes::semantic... };
+			const nvrhi::Format formats[] = { Attributes::format... };
+
+			std::array<nvrhi::VertexAttributeDesc, AttributeCount> descs;
+			for (uint32_t i = 0; i < AttributeCount; i++)
+			{
+				descs[i] = nvrhi::VertexAttributeDesc()
+					.setName(semantics[i])
+					.setFormat(formats[i])
+					.setOffset(Offsets[i])
+					.setBufferIndex(bufferIndex)
+					.setElementStride(Stride);
+			}
+			return descs;
+		}
+
+		// Encodes count vertices into dst, which must hold count * Stride bytes
+		static void Convert(const Vertex* src, size_t count, void* dst)
+		{
+			uint8_t* out = static_cast<uint8_t*>(dst);
+			for (size_t i = 0; i < count; i++, out += Stride)
+				WriteVertex(src[i], out, std::index_sequence_for<Attributes...>());
+		}
+
+		static std::vector<uint8_t> Convert(const Mesh& mesh)
+		{
+			std::vector<uint8_t> data(mesh.vertices.size() * Stride);
+			Convert(mesh.vertices.data(), mesh.vertices.size(), data.data());
+			return data;
+		}
+
+	private:
+		template <size_t... I>
+		static void WriteVertex(const Vertex& vertex, uint8_t* out, std::index_sequence<I...>)
+		{
+			(WriteAttribute<Attributes>(vertex, out + Offsets[I]), ...);
+		}
+
+		template <typename Attribute>
+		static void WriteAttribute(const Vertex& vertex, uint8_t* out)
+		{
+			const typename Attribute::Type value = Attribute::Encode(vertex);
+			memcpy(out, &value, sizeof(value));
+		}
+	};
+
+	// Layouts used by Geometry. InterleavedLayout matches Vertex byte for byte
+	using InterleavedLayout = VertexLayout<vertex_attributes::Position, vertex_attributes::UV, vertex_attributes::Normal>;
+	using PositionLayout = VertexLayout<vertex_attributes::Position>;
+	using AttributeLayout = VertexLayout<vertex_attributes::UV, vertex_attributes::Normal>;
+
+	// Half the size of InterleavedLayout, for experiments with leaner formats
+	using CompactLayout = VertexLayout<vertex_attributes::PositionHalf, vertex_attributes::UVHalf, vertex_attributes::NormalSnorm8>;
+
+	static_assert(InterleavedLayout::Stride == sizeof(Vertex), "InterleavedLayout must match Vertex");
+	static_assert(InterleavedLayout::Offsets[1] == offsetof(Vertex, uv) && InterleavedLayout::Offsets[2] == offsetof(Vertex, normal), "InterleavedLayout must match Vertex");
+};
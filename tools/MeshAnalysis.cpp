@@ -0,0 +1,554 @@
+#include <core/stdafx.h>
+#include <core/log.h>
+#include <core/Threading.h>
+#include <core/VFS.h>
+#include <engine/ModelLoader.h>
+#include <engine/GLTFLoader.h>
+#include <engine/OBJLoader.h>
+#include <engine/PLYLoader.h>
+#include <engine/MeshCodec.h>
+#include <engine/ProceduralMesh.h>
+#include <utils/string_utils.h>
+#include <glm/gtc/constants.hpp>
+
+// Whole-mesh version of shaders/validation.py and shaders/plot.py. For every triangle edge the shader estimates the
+// normal of the triangle across it from the three vertex normals alone. This tool measures those estimates against
+// the real neighbour found through the half-edges:
+//  - angular deviation from the neighbour's normal, histogrammed once per mesh
+//  - agreement of the silhouette test built on them with the exact silhouette, at every frame of an orbit around
+//    the model
+// Triangles are processed in parallel on the shared workers.
+//
+// Usage: CroissantMeshAnalysis <model> | --procedural <shape> <triangles>
+//            [--frames <n>] [--bins <n>] [--level <n>] [--scheme planar|pn] [--binary] [--out <prefix>]
+//
+// Writes <prefix>_angular.csv and <prefix>_silhouettes.csv, or a single <prefix>.csan with --binary
+
+using namespace croissant;
+
+namespace
+{
+	constexpr uint32_t FILE_MAGIC = 0x4E415343;	// "CSAN"
+	constexpr uint32_t FILE_VERSION = 1;
+	constexpr size_t FACE_GRAIN = 1 << 14;
+
+	// Estimates of the normal across edge (v_k, v_k+1) of a triangle, from its vertex normals n_k, n_k+1 and n_k+2
+	enum Estimator : uint32_t
+	{
+		ESTIMATOR_EXTRAPOLATED,	// n_k + n_k+1 - n_k+2, the estimate the shader's silhouette test uses
+		ESTIMATOR_REFLECTED,	// n_k+2 mirrored about the edge's average normal
+		ESTIMATOR_EDGE_AVERAGE,	// n_k + n_k+1, the baseline
+		ESTIMATOR_COUNT
+	};
+	const char* const ESTIMATOR_NAMES[ESTIMATOR_COUNT] = { "extrapolated", "reflected", "edge_average" };
+
+	struct Options
+	{
+		std::string modelPath;
+		ProceduralShape shape = ProceduralShape::Sphere;
+		uint64_t proceduralTriangles = 0;	// Generate instead of loading when non-zero
+		uint32_t frames = 64;
+		uint32_t bins = 180;
+		uint32_t level = 0;
+		SubdivisionScheme scheme = SubdivisionScheme::Planar;
+		bool binary = false;
+		std::string outputPrefix = "mesh_analysis";
+	};
+
+	// Counts over the half-edges of one frame, each interior edge tested from both of its triangles as the shader does
+	struct FrameResult
+	{
+		float    camera[3];
+		uint32_t _pad;
+		uint64_t edges;
+		uint64_t openEdges;			// No neighbour to compare against, left out of the counts below
+		uint64_t silhouettes;		// Exact: the two triangles of the edge face opposite ways
+		uint64_t truePositives[ESTIMATOR_COUNT];
+		uint64_t falsePositives[ESTIMATOR_COUNT];
+		uint64_t falseNegatives[ESTIMATOR_COUNT];
+	};
+
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t bins;				// Deviation histogram over [0, 180] degrees, bins counts per estimator
+		uint32_t estimators;
+		uint32_t frames;			// FrameResult records after the histograms
+		uint32_t _pad;
+		uint64_t triangles;
+	};
+
+	glm::vec3 SafeNormalize(const glm::vec3& v)
+	{
+		const float length = glm::length(v);
+		return length > 0.0f ? v / length : v;
+	}
+
+	void EstimateAcrossEdge(const glm::vec3& n0, const glm::vec3& n1, const glm::vec3& opposite, glm::vec3 (&outEstimates)[ESTIMATOR_COUNT])
+	{
+		const glm::vec3 edge = SafeNormalize(n0 + n1);
+		outEstimates[ESTIMATOR_EXTRAPOLATED] = SafeNormalize(n0 + n1 - opposite);
+		outEstimates[ESTIMATOR_REFLECTED] = SafeNormalize(2.0f * glm::dot(opposite, edge) * edge - opposite);
+		outEstimates[ESTIMATOR_EDGE_AVERAGE] = edge;
+	}
+
+	// View-independent data shared by every frame
+	struct AnalysedMesh
+	{
+		std::unique_ptr<Mesh> mesh;
+		std::vector<glm::vec3> vertexNormals;	// Unit length
+		std::vector<glm::vec3> faceNormals;		// Geometric, scaled by twice the area
+		std::vector<glm::vec3> smoothNormals;	// Sum of the unit vertex normals, the triangle's normal as the shader sees it
+	};
+
+	void BuildNormals(AnalysedMesh& analysed)
+	{
+		const Mesh& mesh = *analysed.mesh;
+		const size_t faceCount = mesh.indices.size() / 3;
+		analysed.vertexNormals.resize(mesh.vertices.size());
+		analysed.faceNormals.resize(faceCount);
+		analysed.smoothNormals.resize(faceCount);
+		threading::ParallelFor(mesh.vertices.size(), 1 << 16, [&](size_t begin, size_t end)
+		{
+			for (size_t v = begin; v < end; v++)
+				analysed.vertexNormals[v] = SafeNormalize(mesh.vertices[v].normal);
+		});
+		threading::ParallelFor(faceCount, FACE_GRAIN, [&](size_t begin, size_t end)
+		{
+			for (size_t f = begin; f < end; f++)
+			{
+				const uint32_t* corners = &mesh.indices[f * 3];
+				const glm::vec3& p0 = mesh.vertices[corners[0]].position;
+				analysed.faceNormals[f] = glm::cross(mesh.vertices[corners[1]].position - p0, mesh.vertices[corners[2]].position - p0);
+				analysed.smoothNormals[f] = analysed.vertexNormals[corners[0]] + analysed.vertexNormals[corners[1]] + analysed.vertexNormals[corners[2]];
+			}
+		});
+	}
+
+	void PrintUsage()
+	{
+		logger::error("Usage: CroissantMeshAnalysis <model> | --procedural <shape> <triangles> [--frames <n>] [--bins <n>] "
+			"[--level <n>] [--scheme planar|pn] [--binary] [--out <prefix>]");
+	}
+
+	bool ParseArguments(int argc, char** argv, Options& options)
+	{
+		int level = 0;
+		for (int i = 1; i < argc; i++)
+		{
+			std::string arg = argv[i];
+			if (arg == "--procedural" && i + 2 < argc)
+			{
+				std::string shape = argv[++i];
+				string_utils::tolower(shape);
+				bool found = false;
+				for (uint32_t s = 0; s <= uint32_t(ProceduralShape::NonManifold); s++)
+				{
+					std::string name = ProceduralMesh::GetShapeName(ProceduralShape(s));
+					string_utils::tolower(name);
+					if (name == shape)
+					{
+						options.shape = ProceduralShape(s);
+						found = true;
+					}
+				}
+				options.proceduralTriangles = strtoull(argv[++i], nullptr, 10);
+				if (!found || options.proceduralTriangles == 0)
+				{
+					logger::error("Unknown procedural shape %s or triangle count.", shape.c_str());
+					return false;
+				}
+			}
+			else if (arg == "--frames" && i + 1 < argc)
+				options.frames = uint32_t(std::max(1, atoi(argv[++i])));
+			else if (arg == "--bins" && i + 1 < argc)
+				options.bins = uint32_t(std::max(1, atoi(argv[++i])));
+			else if (arg == "--level" && i + 1 < argc)
+				level = atoi(argv[++i]);
+			else if (arg == "--scheme" && i + 1 < argc)
+			{
+				const std::string scheme = argv[++i];
+				if (scheme != "planar" && scheme != "pn")
+				{
+					logger::error("Unknown subdivision scheme %s.", scheme.c_str());
+					PrintUsage();
+					return false;
+				}
+				options.scheme = scheme == "pn" ? SubdivisionScheme::PNTriangle : SubdivisionScheme::Planar;
+			}
+			else if (arg == "--binary")
+				options.binary = true;
+			else if (arg == "--out" && i + 1 < argc)
+				options.outputPrefix = argv[++i];
+			else if (arg[0] != '-')
+				options.modelPath = arg;
+			else
+			{
+				logger::error("Unknown argument %s.", arg.c_str());
+				return false;
+			}
+		}
+
+		if (options.modelPath.empty() && options.proceduralTriangles == 0)
+		{
+			PrintUsage();
+			return false;
+		}
+
+		// PN levels are evaluated from the base mesh directly, planar ones compound and stop where the loader does
+		const int maxLevel = options.scheme == SubdivisionScheme::PNTriangle ? int(MeshOperations::MAX_PN_TRIANGLE_LEVEL) : MAX_SUBDIVISION_LEVELS;
+		options.level = uint32_t(std::clamp(level, 0, maxLevel));
+		return true;
+	}
+
+	// Native loaders where there is one. Other formats are read with Assimp directly rather than through ModelLoader,
+	// which would also build every subdivision level of the model
+	bool LoadMeshes(const std::string& path, std::vector<std::unique_ptr<Mesh>>& outMeshes)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+		string_utils::tolower(extension);
+		vfs::NativeFileSystem fs;
+		if (extension == ".glb")
+			return GLTFLoader::LoadGLB(fs, path, outMeshes);
+		if (extension == ".obj")
+			return OBJLoader::LoadOBJ(fs, path, outMeshes);
+		if (extension == ".ply")
+			return PLYLoader::LoadPLY(fs, path, outMeshes);
+		if (extension == ".csmesh")
+		{
+			outMeshes.push_back(std::make_unique<Mesh>());
+			return MeshCodec::Read(fs, path, *outMeshes.back());
+		}
+
+		Assimp::Importer importer;
+		const aiScene* scene = importer.ReadFile(path.c_str(), ModelLoader::AssimpImportFlags | aiProcess_GenSmoothNormals);
+		if (!scene || !scene->mRootNode)
+		{
+			logger::error("Assimp error: %s", importer.GetErrorString());
+			return false;
+		}
+		for (uint32_t m = 0; m < scene->mNumMeshes; m++)
+		{
+			const aiMesh* source = scene->mMeshes[m];
+			auto mesh = std::make_unique<Mesh>();
+			mesh->vertices.resize(source->mNumVertices);
+			for (uint32_t v = 0; v < source->mNumVertices; v++)
+			{
+				const aiVector3D& position = source->mVertices[v];
+				const aiVector3D normal = source->HasNormals() ? source->mNormals[v] : aiVector3D();
+				mesh->vertices[v] = Vertex{ glm::vec3(position.x, position.y, position.z), glm::vec2(0.0f), glm::vec3(normal.x, normal.y, normal.z) };
+			}
+			for (uint32_t f = 0; f < source->mNumFaces; f++)
+			{
+				if (source->mFaces[f].mNumIndices == 3)
+					mesh->indices.insert(mesh->indices.end(), source->mFaces[f].mIndices, source->mFaces[f].mIndices + 3);
+			}
+			outMeshes.push_back(std::move(mesh));
+		}
+		return !outMeshes.empty();
+	}
+
+	// Half-edges, then the requested subdivision level
+	bool PrepareMesh(const Options& options, std::unique_ptr<Mesh>& mesh)
+	{
+		if (mesh->indices.empty() || !MeshOperations::GenerateHalfEdgeData(mesh.get()))
+			return false;
+		MeshOperations::ComputeBounds(mesh.get());
+		if (options.level == 0)
+			return true;
+
+		auto subdivided = std::make_unique<Mesh>();
+		if (options.scheme == SubdivisionScheme::PNTriangle)
+		{
+			if (!MeshOperations::PNTriangleSubdivide(mesh.get(), subdivided.get(), options.level))
+				return false;
+		}
+		else
+		{
+			for (uint32_t level = 0; level < options.level; level++)
+			{
+				if (!MeshOperations::PlanarSubdivide(mesh.get(), subdivided.get()))
+					return false;
+				std::swap(mesh, subdivided);
+			}
+			return true;
+		}
+		mesh = std::move(subdivided);
+		return true;
+	}
+
+	// Deviation of every estimate from the smooth normal of the real neighbour, added to counts[estimator * bins + bin]
+	void AccumulateDeviations(const AnalysedMesh& analysed, uint32_t bins, std::vector<uint64_t>& counts, double (&degreeSums)[ESTIMATOR_COUNT], uint64_t& samples)
+	{
+		const Mesh& mesh = *analysed.mesh;
+		std::mutex mergeMutex;
+		threading::ParallelFor(mesh.indices.size() / 3, FACE_GRAIN, [&](size_t begin, size_t end)
+		{
+			std::vector<uint64_t> localCounts(counts.size(), 0);
+			double localSums[ESTIMATOR_COUNT] = {};
+			uint64_t localSamples = 0;
+			for (size_t f = begin; f < end; f++)
+			{
+				const uint32_t* corners = &mesh.indices[f * 3];
+				for (uint32_t k = 0; k < 3; k++)
+				{
+					const uint32_t twin = mesh.halfEdges[f * 3 + k].twin;
+					if (twin == INVALID)
+						continue;
+
+					glm::vec3 estimates[ESTIMATOR_COUNT];
+					EstimateAcrossEdge(analysed.vertexNormals[corners[k]], analysed.vertexNormals[corners[(k + 1) % 3]], analysed.vertexNormals[corners[(k + 2) % 3]], estimates);
+					const glm::vec3 neighbour = SafeNormalize(analysed.smoothNormals[mesh.halfEdges[twin].face]);
+					for (uint32_t e = 0; e < ESTIMATOR_COUNT; e++)
+					{
+						const float degrees = glm::degrees(std::acos(std::clamp(glm::dot(estimates[e], neighbour), -1.0f, 1.0f)));
+						localCounts[e * bins + std::min(bins - 1, uint32_t(degrees / 180.0f * float(bins)))]++;
+						localSums[e] += degrees;
+					}
+					localSamples++;
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(mergeMutex);
+			for (size_t i = 0; i < counts.size(); i++)
+				counts[i] += localCounts[i];
+			for (uint32_t e = 0; e < ESTIMATOR_COUNT; e++)
+				degreeSums[e] += localSums[e];
+			samples += localSamples;
+		});
+	}
+
+	// Exact silhouettes from the geometric facing of both triangles of an edge, against the shader's test: the edge
+	// is a silhouette when the smooth normal of its triangle and the estimate across the edge face opposite ways, seen
+	// from the edge's first vertex. Only signs of dot products matter, so nothing is normalised: with e = n_k + n_k+1
+	// and o = n_k+2 the estimates are e - o, the reflection 2 (o.e) e / (e.e) - o scaled by e.e, and e
+	void TestSilhouettes(const AnalysedMesh& analysed, const glm::vec3& camera, std::vector<uint8_t>& facing, FrameResult& result)
+	{
+		const Mesh& mesh = *analysed.mesh;
+		const size_t faceCount = mesh.indices.size() / 3;
+		facing.resize(faceCount);
+		threading::ParallelFor(faceCount, FACE_GRAIN, [&](size_t begin, size_t end)
+		{
+			for (size_t f = begin; f < end; f++)
+				facing[f] = glm::dot(analysed.faceNormals[f], camera - mesh.vertices[mesh.indices[f * 3]].position) > 0.0f ? 1 : 0;
+		});
+
+		std::mutex mergeMutex;
+		threading::ParallelFor(faceCount, FACE_GRAIN, [&](size_t begin, size_t end)
+		{
+			FrameResult local = {};
+			for (size_t f = begin; f < end; f++)
+			{
+				const uint32_t* corners = &mesh.indices[f * 3];
+				const glm::vec3 normals[3] = { analysed.vertexNormals[corners[0]], analysed.vertexNormals[corners[1]], analysed.vertexNormals[corners[2]] };
+				const float edgeDots[3] = { glm::dot(normals[0], normals[1]), glm::dot(normals[1], normals[2]), glm::dot(normals[2], normals[0]) };
+				for (uint32_t k = 0; k < 3; k++)
+				{
+					local.edges++;
+					const uint32_t twin = mesh.halfEdges[f * 3 + k].twin;
+					if (twin == INVALID)
+					{
+						local.openEdges++;
+						continue;
+					}
+					const bool silhouette = facing[f] != facing[mesh.halfEdges[twin].face];
+
+					const uint32_t k1 = (k + 1) % 3, k2 = (k + 2) % 3;
+					const glm::vec3 view = camera - mesh.vertices[corners[k]].position;
+					const float edgeView = glm::dot(normals[k], view) + glm::dot(normals[k1], view);
+					const float oppositeView = glm::dot(normals[k2], view);
+					const float oppositeEdge = edgeDots[k2] + edgeDots[k1];	// o.e
+					const float edgeEdge = 2.0f + 2.0f * edgeDots[k];			// e.e
+					const float estimateViews[ESTIMATOR_COUNT] = { edgeView - oppositeView, 2.0f * oppositeEdge * edgeView - edgeEdge * oppositeView, edgeView };
+					const float faceView = glm::dot(analysed.smoothNormals[f], view);
+
+					local.silhouettes += silhouette ? 1 : 0;
+					for (uint32_t e = 0; e < ESTIMATOR_COUNT; e++)
+					{
+						const bool predicted = faceView * estimateViews[e] < 0.0f;
+						local.truePositives[e] += predicted && silhouette ? 1 : 0;
+						local.falsePositives[e] += predicted && !silhouette ? 1 : 0;
+						local.falseNegatives[e] += !predicted && silhouette ? 1 : 0;
+					}
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(mergeMutex);
+			result.edges += local.edges;
+			result.openEdges += local.openEdges;
+			result.silhouettes += local.silhouettes;
+			for (uint32_t e = 0; e < ESTIMATOR_COUNT; e++)
+			{
+				result.truePositives[e] += local.truePositives[e];
+				result.falsePositives[e] += local.falsePositives[e];
+				result.falseNegatives[e] += local.falseNegatives[e];
+			}
+		});
+	}
+
+	bool WriteResults(const Options& options, const std::vector<uint64_t>& counts, const std::vector<FrameResult>& frames, uint64_t triangles)
+	{
+		vfs::NativeFileSystem fs;
+		if (options.binary)
+		{
+			FileHeader header = {};
+			header.magic = FILE_MAGIC;
+			header.version = FILE_VERSION;
+			header.bins = options.bins;
+			header.estimators = ESTIMATOR_COUNT;
+			header.frames = uint32_t(frames.size());
+			header.triangles = triangles;
+
+			std::vector<uint8_t> data(sizeof(header) + counts.size() * sizeof(uint64_t) + frames.size() * sizeof(FrameResult));
+			memcpy(data.data(), &header, sizeof(header));
+			memcpy(data.data() + sizeof(header), counts.data(), counts.size() * sizeof(uint64_t));
+			memcpy(data.data() + sizeof(header) + counts.size() * sizeof(uint64_t), frames.data(), frames.size() * sizeof(FrameResult));
+			return fs.writeFile(options.outputPrefix + ".csan", data.data(), data.size());
+		}
+
+		std::string angular = "bin_start_degrees,bin_end_degrees";
+		for (const char* name : ESTIMATOR_NAMES)
+			angular += std::string(",") + name;
+		angular += "\n";
+		char line[256];
+		for (uint32_t bin = 0; bin < options.bins; bin++)
+		{
+			snprintf(line, sizeof(line), "%g,%g", 180.0 * bin / options.bins, 180.0 * (bin + 1) / options.bins);
+			angular += line;
+			for (uint32_t e = 0; e < ESTIMATOR_COUNT; e++)
+				angular += "," + std::to_string(counts[e * options.bins + bin]);
+			angular += "\n";
+		}
+
+		std::string silhouettes = "frame,camera_x,camera_y,camera_z,edges,open_edges,silhouette_edges";
+		for (const char* name : ESTIMATOR_NAMES)
+			silhouettes += std::string(",") + name + "_true_positives," + name + "_false_positives," + name + "_false_negatives";
+		silhouettes += "\n";
+		for (size_t frame = 0; frame < frames.size(); frame++)
+		{
+			const FrameResult& result = frames[frame];
+			snprintf(line, sizeof(line), "%zu,%g,%g,%g,%llu,%llu,%llu", frame, result.camera[0], result.camera[1], result.camera[2],
+				(unsigned long long)result.edges, (unsigned long long)result.openEdges, (unsigned long long)result.silhouettes);
+			silhouettes += line;
+			for (uint32_t e = 0; e < ESTIMATOR_COUNT; e++)
+				silhouettes += "," + std::to_string(result.truePositives[e]) + "," + std::to_string(result.falsePositives[e]) + "," + std::to_string(result.falseNegatives[e]);
+			silhouettes += "\n";
+		}
+
+		return fs.writeFile(options.outputPrefix + "_angular.csv", angular.data(), angular.size())
+			&& fs.writeFile(options.outputPrefix + "_silhouettes.csv", silhouettes.data(), silhouettes.size());
+	}
+}
+
+int main(int argc, char** argv)
+{
+	logger::ConsoleApplicationMode();
+	logger::SetMinSeverity(logger::Severity::Warning);
+
+	Options options;
+	if (!ParseArguments(argc, argv, options))
+		return 1;
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+	std::vector<std::unique_ptr<Mesh>> meshes;
+	if (options.proceduralTriangles)
+	{
+		ProceduralMeshSettings settings;
+		settings.shape = options.shape;
+		settings.triangleCount = options.proceduralTriangles;
+		meshes.push_back(std::make_unique<Mesh>());
+		if (!ProceduralMesh::Generate(settings, *meshes.back()))
+			return 1;
+	}
+	else if (!LoadMeshes(options.modelPath, meshes))
+	{
+		logger::error("Failed to load %s.", options.modelPath.c_str());
+		return 1;
+	}
+
+	// Non-manifold input logs a warning per inconsistent edge while its half-edges are built
+	logger::SetMinSeverity(logger::Severity::Error);
+	uint64_t triangles = 0;
+	glm::vec3 minBounds(std::numeric_limits<float>::max()), maxBounds(-std::numeric_limits<float>::max());
+	std::vector<AnalysedMesh> analysedMeshes;
+	for (std::unique_ptr<Mesh>& mesh : meshes)
+	{
+		if (!PrepareMesh(options, mesh))
+			continue;
+		triangles += mesh->indices.size() / 3;
+		minBounds = glm::min(minBounds, mesh->minBounds);
+		maxBounds = glm::max(maxBounds, mesh->maxBounds);
+		analysedMeshes.emplace_back();
+		analysedMeshes.back().mesh = std::move(mesh);
+		BuildNormals(analysedMeshes.back());
+	}
+	logger::SetMinSeverity(logger::Severity::Warning);
+	if (triangles == 0)
+	{
+		logger::error("No triangles to analyse.");
+		return 1;
+	}
+	const double prepareSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+	printf("%zu meshes, %llu triangles, loaded and prepared in %.2f s\n", analysedMeshes.size(), (unsigned long long)triangles, prepareSeconds);
+
+	startTime = std::chrono::high_resolution_clock::now();
+	std::vector<uint64_t> counts(size_t(ESTIMATOR_COUNT) * options.bins, 0);
+	double degreeSums[ESTIMATOR_COUNT] = {};
+	uint64_t samples = 0;
+	for (const AnalysedMesh& analysed : analysedMeshes)
+		AccumulateDeviations(analysed, options.bins, counts, degreeSums, samples);
+	const double deviationSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+	printf("Angular deviation over %llu interior half-edges in %.2f s, %.1f Mtri/s\n", (unsigned long long)samples, deviationSeconds, double(triangles) / deviationSeconds * 1e-6);
+	for (uint32_t e = 0; e < ESTIMATOR_COUNT; e++)
+		printf("    %-14s mean %.3f degrees\n", ESTIMATOR_NAMES[e], samples ? degreeSums[e] / double(samples) : 0.0);
+
+	// Orbit around the bounds, rising and falling twice per turn so both sides of the equator are seen
+	const glm::vec3 centre = (minBounds + maxBounds) * 0.5f;
+	const float distance = std::max(glm::length(maxBounds - minBounds), 1e-6f) * 1.25f;
+	std::vector<FrameResult> frames(options.frames);
+	std::vector<uint8_t> facing;
+	startTime = std::chrono::high_resolution_clock::now();
+	for (uint32_t frame = 0; frame < options.frames; frame++)
+	{
+		const float azimuth = glm::two_pi<float>() * float(frame) / float(options.frames);
+		const float elevation = glm::radians(40.0f) * std::sin(2.0f * azimuth);
+		const glm::vec3 camera = centre + distance * glm::vec3(std::cos(elevation) * std::cos(azimuth), std::sin(elevation), std::cos(elevation) * std::sin(azimuth));
+
+		FrameResult& result = frames[frame];
+		result = {};
+		result.camera[0] = camera.x;
+		result.camera[1] = camera.y;
+		result.camera[2] = camera.z;
+		for (const AnalysedMesh& analysed : analysedMeshes)
+			TestSilhouettes(analysed, camera, facing, result);
+	}
+	const double silhouetteSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+	printf("Silhouette test over %u frames in %.2f s, %.1f Mtri/s\n", options.frames, silhouetteSeconds,
+		double(triangles) * options.frames / silhouetteSeconds * 1e-6);
+
+	FrameResult total = {};
+	for (const FrameResult& result : frames)
+	{
+		total.silhouettes += result.silhouettes;
+		for (uint32_t e = 0; e < ESTIMATOR_COUNT; e++)
+		{
+			total.truePositives[e] += result.truePositives[e];
+			total.falsePositives[e] += result.falsePositives[e];
+			total.falseNegatives[e] += result.falseNegatives[e];
+		}
+	}
+	for (uint32_t e = 0; e < ESTIMATOR_COUNT; e++)
+	{
+		const double predicted = double(total.truePositives[e] + total.falsePositives[e]);
+		printf("    %-14s precision %.4f, recall %.4f\n", ESTIMATOR_NAMES[e], predicted > 0.0 ? double(total.truePositives[e]) / predicted : 0.0,
+			total.silhouettes ? double(total.truePositives[e]) / double(total.silhouettes) : 0.0);
+	}
+
+	if (!WriteResults(options, counts, frames, triangles))
+	{
+		logger::error("Failed to write results to %s.", options.outputPrefix.c_str());
+		return 1;
+	}
+	return 0;
+}